@@ -9,6 +9,7 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include "esp_timer.h"
 
 // Pines y frecuencia I2C configurables desde platformio.ini (build_flags)
 #ifndef I2C_MASTER_SDA_PIN
@@ -36,7 +37,9 @@ struct SensorData {
     float noiseAvgLegal;     // Promedio legal
     float noiseAvgLegalMax;  // Máximo promedio legal
     uint16_t lowNoiseLevel;  // Nivel base
+    uint16_t intervalMs;     // Intervalo de agregación del registro en ms
     uint32_t cycles;         // Contador de ciclos
+    uint64_t timestamp;      // Marca de tiempo en µs (reloj del maestro tras CMD_TIME_SYNC)
 } sensorData;
 
 // Comandos I2C (deben coincidir con el esclavo)
@@ -48,7 +51,8 @@ enum I2CCommand {
     CMD_GET_LEGAL = 0x05,
     CMD_GET_LEGAL_MAX = 0x06,
     CMD_GET_STATUS = 0x07,
-    CMD_RESET = 0x08
+    CMD_RESET = 0x08,
+    CMD_TIME_SYNC = 0x0D
 };
 
 // Función para solicitar todos los datos del sensor
@@ -98,6 +102,15 @@ float requestFloatValue(I2CCommand cmd) {
     return value;
 }
 
+// Función para enviar el tiempo del maestro al esclavo (los registros quedan en este reloj)
+bool sendTimeSync() {
+    uint64_t now = static_cast<uint64_t>(esp_timer_get_time());
+    Wire.beginTransmission(I2C_SLAVE_ADDRESS);
+    Wire.write(CMD_TIME_SYNC);
+    Wire.write((uint8_t*)&now, sizeof(now));
+    return Wire.endTransmission() == 0;
+}
+
 // Función para verificar el estado del esclavo
 bool checkSlaveStatus() {
     Wire.beginTransmission(I2C_SLAVE_ADDRESS);
@@ -140,6 +153,14 @@ void setup() {
 }
 
 void loop() {
+    // Resincronizar el reloj del esclavo periódicamente (corrige la deriva)
+    static unsigned long lastSync = 0;
+    if (lastSync == 0 || millis() - lastSync >= 60000) {
+        if (sendTimeSync()) {
+            lastSync = millis();
+        }
+    }
+
     // Verificar si el esclavo está disponible
     if (!checkSlaveStatus()) {
         Serial.println("Esclavo no disponible o sin datos");
@@ -160,6 +181,7 @@ void loop() {
         Serial.printf("  Máximo Legal: %.2f mV\n", sensorData.noiseAvgLegalMax);
         Serial.printf("  Nivel Base: %d mV\n", sensorData.lowNoiseLevel);
         Serial.printf("  Ciclos: %u\n", sensorData.cycles);
+        Serial.printf("  Timestamp: %llu us\n", static_cast<unsigned long long>(sensorData.timestamp));
     } else {
         Serial.println("Error al recibir datos completos");
     }
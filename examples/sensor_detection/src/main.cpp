@@ -42,7 +42,9 @@ struct SensorData {
     float noiseAvgLegal;
     float noiseAvgLegalMax;
     uint16_t lowNoiseLevel;
+    uint16_t intervalMs;
     uint32_t cycles;
+    uint64_t timestamp;
 };
 
 // Comandos I2C
@@ -0,0 +1,68 @@
+#ifndef NOISE_ADAPTIVE_INTERVAL_H
+#define NOISE_ADAPTIVE_INTERVAL_H
+
+#include <stdint.h>
+
+/**
+ * Intervalo de agregación adaptativo según la actividad
+ *
+ * Tras cada registro recibe la desviación típica del nivel dentro del intervalo: si supera
+ * el umbral de actividad el intervalo se reduce a la mitad; si se mantiene por debajo del
+ * umbral de calma durante varios registros seguidos, se duplica. Siempre dentro de
+ * [minMs, maxMs]. Acortar es inmediato y alargar requiere una racha: un evento no se
+ * pierde en un intervalo largo.
+ */
+class AdaptiveInterval {
+public:
+    AdaptiveInterval()
+        : minMs(0), maxMs(0), intervalMs(0), quietStdDev(0.0f), activeStdDev(0.0f),
+          quietRecords(1), quietStreak(0) {}
+
+    void configure(uint32_t initialMs, uint32_t lowerMs, uint32_t upperMs,
+                   float quietThreshold, float activeThreshold, uint8_t quietCount) {
+        minMs = lowerMs;
+        maxMs = upperMs;
+        quietStdDev = quietThreshold;
+        activeStdDev = activeThreshold;
+        quietRecords = quietCount > 0 ? quietCount : 1;
+        quietStreak = 0;
+        intervalMs = clamp(initialMs);
+    }
+
+    /**
+     * Registrar la actividad del intervalo que acaba de cerrarse
+     * @param stdDev Desviación típica del nivel en el intervalo
+     * @return Intervalo para el siguiente registro en ms
+     */
+    uint32_t update(float stdDev) {
+        if (stdDev >= activeStdDev) {
+            quietStreak = 0;
+            intervalMs = clamp(intervalMs / 2);
+        } else if (stdDev < quietStdDev) {
+            if (++quietStreak >= quietRecords) {
+                quietStreak = 0;
+                intervalMs = clamp(intervalMs * 2);
+            }
+        } else {
+            quietStreak = 0;
+        }
+        return intervalMs;
+    }
+
+    uint32_t getIntervalMs() const { return intervalMs; }
+
+private:
+    uint32_t minMs;
+    uint32_t maxMs;
+    uint32_t intervalMs;
+    float quietStdDev;
+    float activeStdDev;
+    uint8_t quietRecords;
+    uint8_t quietStreak;
+
+    uint32_t clamp(uint32_t ms) const {
+        return ms < minMs ? minMs : (ms > maxMs ? maxMs : ms);
+    }
+};
+
+#endif // NOISE_ADAPTIVE_INTERVAL_H
@@ -0,0 +1,142 @@
+#include "AdcCalibration.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#define NOISE_ADC_CALI_SUPPORTED 1
+#include <Arduino.h>
+#include "esp_idf_version.h"
+#if ESP_IDF_VERSION_MAJOR >= 5
+#include "esp_adc/adc_cali.h"
+#include "esp_adc/adc_cali_scheme.h"
+#else
+#include "esp_adc_cal.h"
+#endif
+#else
+#define NOISE_ADC_CALI_SUPPORTED 0
+#endif
+
+// Los nodos van de 0 a 4096; el código 4096 no existe y el último nodo se extrapola
+// con la pendiente del final de la escala
+static const uint16_t CAL_LAST_CODE = 4095;
+static const uint16_t CAL_SLOPE_CODE = 4080;
+
+#if NOISE_ADC_CALI_SUPPORTED
+#if ESP_IDF_VERSION_MAJOR >= 5
+// Esquema de eFuse disponible en el chip: curve fitting (C3/S3) o line fitting (ESP32)
+static bool createScheme(uint8_t channel, adc_atten_t atten, adc_cali_handle_t* handle) {
+#if ADC_CALI_SCHEME_CURVE_FITTING_SUPPORTED
+    adc_cali_curve_fitting_config_t curve = {};
+    curve.unit_id = ADC_UNIT_1;
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+    curve.chan = static_cast<adc_channel_t>(channel);
+#endif
+    curve.atten = atten;
+    curve.bitwidth = ADC_BITWIDTH_12;
+    if (adc_cali_create_scheme_curve_fitting(&curve, handle) == ESP_OK) {
+        return true;
+    }
+#endif
+#if ADC_CALI_SCHEME_LINE_FITTING_SUPPORTED
+    adc_cali_line_fitting_config_t line = {};
+    line.unit_id = ADC_UNIT_1;
+    line.atten = atten;
+    line.bitwidth = ADC_BITWIDTH_12;
+    if (adc_cali_create_scheme_line_fitting(&line, handle) == ESP_OK) {
+        return true;
+    }
+#endif
+    (void)channel;
+    (void)atten;
+    (void)handle;
+    return false;
+}
+
+static void deleteScheme(adc_cali_handle_t handle) {
+#if ADC_CALI_SCHEME_CURVE_FITTING_SUPPORTED
+    if (adc_cali_delete_scheme_curve_fitting(handle) == ESP_OK) {
+        return;
+    }
+#endif
+#if ADC_CALI_SCHEME_LINE_FITTING_SUPPORTED
+    adc_cali_delete_scheme_line_fitting(handle);
+#endif
+}
+#endif
+#endif
+
+void AdcCalibration::setLinear(uint32_t fullScaleMv) {
+    for (uint16_t i = 0; i < CAL_LUT_SIZE; i++) {
+        const uint32_t code = static_cast<uint32_t>(i) << CAL_LUT_SHIFT;
+        lut[i] = static_cast<uint16_t>((code * fullScaleMv + 2048) >> 12);
+    }
+    calibrated = false;
+}
+
+void AdcCalibration::setCurve(int32_t (*rawToMv)(uint16_t raw)) {
+    for (uint16_t i = 0; i + 1 < CAL_LUT_SIZE; i++) {
+        const int32_t mv = rawToMv(static_cast<uint16_t>(i << CAL_LUT_SHIFT));
+        lut[i] = static_cast<uint16_t>(mv < 0 ? 0 : mv);
+    }
+    extrapolateLastNode(rawToMv(CAL_LAST_CODE), rawToMv(CAL_SLOPE_CODE));
+    calibrated = false;
+}
+
+void AdcCalibration::extrapolateLastNode(int lastMv, int slopeMv) {
+    // Pendiente por código redondeada (truncarla dejaba el final de la escala ~1 mV bajo)
+    const int span = CAL_LAST_CODE - CAL_SLOPE_CODE;
+    const int rise = lastMv - slopeMv;
+    const int extrapolated = lastMv + (rise >= 0 ? rise + span / 2 : rise - span / 2) / span;
+    lut[CAL_LUT_SIZE - 1] = static_cast<uint16_t>(extrapolated < 0 ? 0 : extrapolated);
+}
+
+bool AdcCalibration::begin(uint8_t pin, uint8_t attenuation, uint32_t fallbackFullScaleMv) {
+    setLinear(fallbackFullScaleMv);
+#if NOISE_ADC_CALI_SUPPORTED
+    const int8_t channel = digitalPinToAnalogChannel(pin);
+    if (channel < 0 || attenuation > 3) {
+        return false;
+    }
+
+    int lastMv = 0;
+    int slopeMv = 0;
+
+#if ESP_IDF_VERSION_MAJOR >= 5
+    adc_cali_handle_t handle = nullptr;
+    if (!createScheme(static_cast<uint8_t>(channel), static_cast<adc_atten_t>(attenuation), &handle)) {
+        return false;
+    }
+    bool ok = true;
+    for (uint16_t i = 0; i + 1 < CAL_LUT_SIZE && ok; i++) {
+        int mv = 0;
+        ok = adc_cali_raw_to_voltage(handle, i << CAL_LUT_SHIFT, &mv) == ESP_OK;
+        lut[i] = static_cast<uint16_t>(mv < 0 ? 0 : mv);
+    }
+    ok = ok && adc_cali_raw_to_voltage(handle, CAL_LAST_CODE, &lastMv) == ESP_OK &&
+         adc_cali_raw_to_voltage(handle, CAL_SLOPE_CODE, &slopeMv) == ESP_OK;
+    deleteScheme(handle);
+    if (!ok) {
+        setLinear(fallbackFullScaleMv);
+        return false;
+    }
+#else
+    if (esp_adc_cal_check_efuse(ESP_ADC_CAL_VAL_EFUSE_TP) != ESP_OK &&
+        esp_adc_cal_check_efuse(ESP_ADC_CAL_VAL_EFUSE_VREF) != ESP_OK) {
+        return false;
+    }
+    esp_adc_cal_characteristics_t chars;
+    esp_adc_cal_characterize(ADC_UNIT_1, static_cast<adc_atten_t>(attenuation), ADC_WIDTH_BIT_12, 1100, &chars);
+    for (uint16_t i = 0; i + 1 < CAL_LUT_SIZE; i++) {
+        lut[i] = static_cast<uint16_t>(esp_adc_cal_raw_to_voltage(i << CAL_LUT_SHIFT, &chars));
+    }
+    lastMv = static_cast<int>(esp_adc_cal_raw_to_voltage(CAL_LAST_CODE, &chars));
+    slopeMv = static_cast<int>(esp_adc_cal_raw_to_voltage(CAL_SLOPE_CODE, &chars));
+#endif
+
+    extrapolateLastNode(lastMv, slopeMv);
+    calibrated = true;
+    return true;
+#else
+    (void)pin;
+    (void)attenuation;
+    return false;
+#endif
+}
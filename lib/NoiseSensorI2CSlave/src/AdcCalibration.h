@@ -0,0 +1,69 @@
+#ifndef NOISE_ADC_CALIBRATION_H
+#define NOISE_ADC_CALIBRATION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "FixedPoint.h"
+
+// Tabla de calibración: un nodo cada 16 códigos del ADC de 12 bits (257 nodos, 514 bytes)
+static constexpr uint8_t CAL_LUT_SHIFT = 4;
+static constexpr uint16_t CAL_LUT_SIZE = (4096 >> CAL_LUT_SHIFT) + 1;
+
+/**
+ * Conversión de códigos del ADC a mV y dB por tabla
+ *
+ * begin() evalúa la calibración de eFuse del chip (esp_adc_cali) para la atenuación
+ * configurada en los nodos de la tabla; en la ruta caliente la conversión es una
+ * interpolación lineal entre dos nodos (la curva de calibración es suave: el error de
+ * interpolación queda por debajo de 1 mV) y el dB sale de la tabla de log2 de
+ * FixedPoint.h. Ni float ni funciones trascendentes por muestra.
+ *
+ * Sin calibración en eFuse (o fuera de ESP32) la tabla es lineal con el fondo de escala
+ * indicado.
+ */
+class AdcCalibration {
+public:
+    AdcCalibration() : calibrated(false) { setLinear(2500); }
+
+    /**
+     * Construir la tabla desde la calibración de eFuse
+     * @param pin GPIO del ADC1
+     * @param attenuation Atenuación (0 = 0 dB, 1 = 2.5 dB, 2 = 6 dB, 3 = 11 dB)
+     * @param fallbackFullScaleMv Fondo de escala de la tabla lineal si no hay calibración
+     * @return true si se usó la calibración del chip
+     */
+    bool begin(uint8_t pin, uint8_t attenuation, uint32_t fallbackFullScaleMv);
+
+    void setLinear(uint32_t fullScaleMv);
+
+    /**
+     * Construir la tabla desde una curva arbitraria (modelos de calibración en el host)
+     * @param rawToMv Conversión de un código de 0 a 4095 a mV
+     */
+    void setCurve(int32_t (*rawToMv)(uint16_t raw));
+
+    int32_t toMilliVolts(int32_t raw) const {
+        if (raw <= 0) return lut[0];
+        if (raw >= 4095) raw = 4095;
+        const uint32_t i = static_cast<uint32_t>(raw) >> CAL_LUT_SHIFT;
+        const int32_t frac = raw & ((1 << CAL_LUT_SHIFT) - 1);
+        const int32_t lo = lut[i];
+        return lo + (((static_cast<int32_t>(lut[i + 1]) - lo) * frac + (1 << (CAL_LUT_SHIFT - 1))) >> CAL_LUT_SHIFT);
+    }
+
+    // Nivel del código en centésimas de dB re 1 mV (INT32_MIN para 0 mV)
+    int32_t toCentiDb(int32_t raw) const {
+        const int32_t mv = toMilliVolts(raw);
+        return mv > 0 ? fixedAmplitudeToCentiDb(static_cast<uint32_t>(mv)) : INT32_MIN;
+    }
+
+    bool isCalibrated() const { return calibrated; }
+
+private:
+    uint16_t lut[CAL_LUT_SIZE];
+    bool calibrated;
+
+    void extrapolateLastNode(int lastMv, int slopeMv);
+};
+
+#endif // NOISE_ADC_CALIBRATION_H
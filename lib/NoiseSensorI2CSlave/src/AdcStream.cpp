@@ -0,0 +1,172 @@
+#include "AdcStream.h"
+
+#if defined(ARDUINO_ARCH_ESP32) && (defined(CONFIG_IDF_TARGET_ESP32C3) || defined(CONFIG_IDF_TARGET_ESP32S3))
+#define NOISE_ADC_STREAM_SUPPORTED 1
+#include "esp_idf_version.h"
+#include "soc/soc_caps.h"
+#if ESP_IDF_VERSION_MAJOR >= 5
+#include "esp_adc/adc_continuous.h"
+#else
+#include "driver/adc.h"
+#endif
+#else
+#define NOISE_ADC_STREAM_SUPPORTED 0
+#endif
+
+#if NOISE_ADC_STREAM_SUPPORTED
+// Pool del driver (~50 ms a 20 kHz, margen para la verificación del ADC) y tamaño de trama DMA
+static constexpr uint32_t ADC_POOL_BYTES = 4096;
+static constexpr uint32_t ADC_FRAME_BYTES = 256;
+
+#if ESP_IDF_VERSION_MAJOR >= 5
+static bool IRAM_ATTR onPoolOverflow(adc_continuous_handle_t, const adc_continuous_evt_data_t*, void* userData) {
+    (*static_cast<volatile uint32_t*>(userData))++;
+    return false;
+}
+#endif
+#endif
+
+AdcStream::AdcStream() : running(false), rateHz(0), overruns(0), channel(0), handle(nullptr) {}
+
+bool AdcStream::isSupported() {
+    return NOISE_ADC_STREAM_SUPPORTED != 0;
+}
+
+bool AdcStream::begin(uint8_t pin, uint32_t rate, uint8_t attenuation) {
+#if NOISE_ADC_STREAM_SUPPORTED
+    if (running || rate < ADC_STREAM_MIN_RATE || rate > ADC_STREAM_MAX_RATE || attenuation > 3) {
+        return false;
+    }
+    const int8_t ch = digitalPinToAnalogChannel(pin);
+    if (ch < 0 || ch >= SOC_ADC_MAX_CHANNEL_NUM) {
+        return false;  // Solo ADC1
+    }
+    channel = static_cast<uint8_t>(ch);
+
+    adc_digi_pattern_config_t pattern = {};
+    pattern.channel = channel;
+    pattern.unit = 0;  // ADC1
+    pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    pattern.atten = attenuation;  // Mismo valor numérico que adc_atten_t (3 = 11/12 dB)
+
+#if ESP_IDF_VERSION_MAJOR >= 5
+    adc_continuous_handle_t h = nullptr;
+    adc_continuous_handle_cfg_t handleConfig = {};
+    handleConfig.max_store_buf_size = ADC_POOL_BYTES;
+    handleConfig.conv_frame_size = ADC_FRAME_BYTES;
+    if (adc_continuous_new_handle(&handleConfig, &h) != ESP_OK) {
+        return false;
+    }
+
+    adc_continuous_config_t config = {};
+    config.pattern_num = 1;
+    config.adc_pattern = &pattern;
+    config.sample_freq_hz = rate;
+    config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+
+    adc_continuous_evt_cbs_t callbacks = {};
+    callbacks.on_pool_ovf = onPoolOverflow;
+
+    if (adc_continuous_config(h, &config) != ESP_OK ||
+        adc_continuous_register_event_callbacks(h, &callbacks, &overruns) != ESP_OK ||
+        adc_continuous_start(h) != ESP_OK) {
+        adc_continuous_deinit(h);
+        return false;
+    }
+    handle = h;
+#else
+    adc_digi_init_config_t initConfig = {};
+    initConfig.max_store_buf_size = ADC_POOL_BYTES;
+    initConfig.conv_num_each_intr = ADC_FRAME_BYTES;
+    initConfig.adc1_chan_mask = BIT(channel);
+    initConfig.adc2_chan_mask = 0;
+    if (adc_digi_initialize(&initConfig) != ESP_OK) {
+        return false;
+    }
+
+    adc_digi_configuration_t config = {};
+    config.conv_limit_en = false;
+    config.conv_limit_num = 250;
+    config.pattern_num = 1;
+    config.adc_pattern = &pattern;
+    config.sample_freq_hz = rate;
+    config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+
+    if (adc_digi_controller_configure(&config) != ESP_OK || adc_digi_start() != ESP_OK) {
+        adc_digi_deinitialize();
+        return false;
+    }
+#endif
+
+    rateHz = rate;
+    overruns = 0;
+    running = true;
+    return true;
+#else
+    (void)pin;
+    (void)rate;
+    (void)attenuation;
+    return false;
+#endif
+}
+
+void AdcStream::end() {
+#if NOISE_ADC_STREAM_SUPPORTED
+    if (!running) {
+        return;
+    }
+#if ESP_IDF_VERSION_MAJOR >= 5
+    adc_continuous_handle_t h = static_cast<adc_continuous_handle_t>(handle);
+    adc_continuous_stop(h);
+    adc_continuous_deinit(h);
+    handle = nullptr;
+#else
+    adc_digi_stop();
+    adc_digi_deinitialize();
+#endif
+    running = false;
+#endif
+}
+
+size_t AdcStream::read(int16_t* out, size_t maxSamples) {
+#if NOISE_ADC_STREAM_SUPPORTED
+    if (!running || maxSamples == 0) {
+        return 0;
+    }
+
+    uint8_t frame[ADC_FRAME_BYTES];
+    const size_t resultBytes = sizeof(adc_digi_output_data_t);
+    size_t wanted = maxSamples * resultBytes;
+    if (wanted > sizeof(frame)) {
+        wanted = sizeof(frame);
+    }
+
+    uint32_t got = 0;
+#if ESP_IDF_VERSION_MAJOR >= 5
+    const esp_err_t err = adc_continuous_read(static_cast<adc_continuous_handle_t>(handle), frame, wanted, &got, 0);
+#else
+    const esp_err_t err = adc_digi_read_bytes(frame, wanted, &got, 0);
+    if (err == ESP_ERR_INVALID_STATE) {
+        overruns++;  // El pool se llenó: se perdieron muestras
+    }
+#endif
+    if (err != ESP_OK && got == 0) {
+        return 0;
+    }
+
+    size_t n = 0;
+    for (uint32_t i = 0; i + resultBytes <= got && n < maxSamples; i += resultBytes) {
+        const adc_digi_output_data_t* result = reinterpret_cast<const adc_digi_output_data_t*>(&frame[i]);
+        if (result->type2.channel == channel) {
+            out[n++] = static_cast<int16_t>(result->type2.data);
+        }
+    }
+    return n;
+#else
+    (void)out;
+    (void)maxSamples;
+    return 0;
+#endif
+}
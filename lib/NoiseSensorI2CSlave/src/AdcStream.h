@@ -0,0 +1,55 @@
+#ifndef NOISE_ADC_STREAM_H
+#define NOISE_ADC_STREAM_H
+
+#include <Arduino.h>
+
+// Frecuencias admitidas por el controlador digital del ADC (DMA)
+static constexpr uint32_t ADC_STREAM_MIN_RATE = 20000;
+static constexpr uint32_t ADC_STREAM_MAX_RATE = 83333;
+
+/**
+ * Adquisición continua del ADC por DMA a tasa fija (20–83 kHz)
+ *
+ * Usa el controlador digital del ADC1 (ESP32-C3 / ESP32-S3): el driver continuo de
+ * ESP-IDF 5 (core Arduino 3.x) o el driver adc_digi de ESP-IDF 4.4 (core Arduino 2.x).
+ * Los buffers del driver se reservan en begin(); read() no bloquea ni reserva memoria.
+ */
+class AdcStream {
+public:
+    AdcStream();
+
+    /**
+     * Iniciar la adquisición
+     * @param pin GPIO del ADC1
+     * @param rateHz Frecuencia de muestreo (ADC_STREAM_MIN_RATE..ADC_STREAM_MAX_RATE)
+     * @param attenuation Atenuación del canal (0..3, 3 = 11/12 dB)
+     * @return true si el driver arrancó
+     */
+    bool begin(uint8_t pin, uint32_t rateHz, uint8_t attenuation = 3);
+
+    void end();
+
+    /**
+     * Leer las muestras disponibles sin bloquear
+     * @param out Muestras crudas de 12 bits
+     * @param maxSamples Capacidad de out
+     * @return Número de muestras leídas (0 si no hay)
+     */
+    size_t read(int16_t* out, size_t maxSamples);
+
+    bool isRunning() const { return running; }
+    uint32_t getRateHz() const { return rateHz; }
+    uint32_t getOverruns() const { return overruns; }
+
+    // La adquisición continua solo está disponible en targets con salida DMA tipo 2
+    static bool isSupported();
+
+private:
+    bool running;
+    uint32_t rateHz;
+    uint32_t overruns;
+    uint8_t channel;
+    void* handle;
+};
+
+#endif // NOISE_ADC_STREAM_H
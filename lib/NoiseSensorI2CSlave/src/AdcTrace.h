@@ -0,0 +1,117 @@
+#ifndef NOISE_ADC_TRACE_H
+#define NOISE_ADC_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Formato de traza de ADC: cabecera + registros de muestras con marca de tiempo.
+//   Tasa fija (TRACE_FLAG_FIXED_RATE): int16_t por muestra, t_i = startUs + i·10^6 / sampleRateHz
+//   Tasa variable: varint (LEB128) con el delta en µs desde la muestra anterior + int16_t
+// Todos los campos en little-endian.
+static constexpr uint32_t TRACE_MAGIC = 0x5254534E;   // "NSTR"
+static constexpr uint8_t TRACE_VERSION = 1;
+static constexpr uint8_t TRACE_FLAG_FIXED_RATE = 0x01;
+static constexpr size_t TRACE_MAX_RECORD_BYTES = 5 + sizeof(int16_t);  // Delta de 32 bits + muestra
+
+struct TraceHeader {
+    uint32_t magic;           // TRACE_MAGIC
+    uint8_t version;          // TRACE_VERSION
+    uint8_t flags;            // TRACE_FLAG_*
+    uint16_t reserved;
+    uint32_t sampleRateHz;    // Tasa nominal (obligatoria con TRACE_FLAG_FIXED_RATE)
+    uint32_t sampleCount;     // Número de registros
+    int64_t startUs;          // Tiempo local de la primera muestra
+};
+
+static_assert(sizeof(TraceHeader) == 24, "TraceHeader debe ocupar 24 bytes");
+
+/**
+ * Codificar un registro de tasa variable
+ * @param deltaUs µs desde la muestra anterior (0 en la primera)
+ * @param sample Código crudo del ADC
+ * @param out Buffer de al menos TRACE_MAX_RECORD_BYTES
+ * @return Bytes escritos
+ */
+inline size_t traceEncodeRecord(uint32_t deltaUs, int16_t sample, uint8_t* out) {
+    size_t n = 0;
+    while (deltaUs >= 0x80) {
+        out[n++] = static_cast<uint8_t>(deltaUs | 0x80);
+        deltaUs >>= 7;
+    }
+    out[n++] = static_cast<uint8_t>(deltaUs);
+    memcpy(&out[n], &sample, sizeof(sample));
+    return n + sizeof(sample);
+}
+
+/**
+ * Lector secuencial de una traza en memoria
+ *
+ * No copia ni reserva: recorre el buffer recibido. next() devuelve false al final o si
+ * la traza está truncada.
+ */
+class TraceReader {
+public:
+    TraceReader(const uint8_t* data, size_t len) : data(data), len(len), valid(false) {
+        memset(&header, 0, sizeof(header));
+        if (len >= sizeof(TraceHeader)) {
+            memcpy(&header, data, sizeof(header));
+            valid = header.magic == TRACE_MAGIC && header.version == TRACE_VERSION &&
+                    (!(header.flags & TRACE_FLAG_FIXED_RATE) || header.sampleRateHz > 0);
+        }
+        rewind();
+    }
+
+    void rewind() {
+        pos = sizeof(TraceHeader);
+        index = 0;
+        timeUs = header.startUs;
+        sample = 0;
+    }
+
+    bool next() {
+        if (!valid || index >= header.sampleCount) {
+            return false;
+        }
+        if (header.flags & TRACE_FLAG_FIXED_RATE) {
+            // Tiempo calculado desde el inicio: sin error acumulado por redondeo
+            timeUs = header.startUs + static_cast<int64_t>(static_cast<uint64_t>(index) * 1000000ULL / header.sampleRateHz);
+        } else {
+            uint32_t delta = 0;
+            uint8_t shift = 0;
+            uint8_t b;
+            do {
+                if (pos >= len || shift > 28) return false;
+                b = data[pos++];
+                delta |= static_cast<uint32_t>(b & 0x7F) << shift;
+                shift += 7;
+            } while (b & 0x80);
+            timeUs += delta;
+        }
+        if (pos + sizeof(int16_t) > len) {
+            return false;
+        }
+        memcpy(&sample, &data[pos], sizeof(sample));
+        pos += sizeof(int16_t);
+        index++;
+        return true;
+    }
+
+    bool isValid() const { return valid; }
+    const TraceHeader& getHeader() const { return header; }
+    int64_t getTimeUs() const { return timeUs; }
+    int16_t getSample() const { return sample; }
+    uint32_t getIndex() const { return index; }
+
+private:
+    const uint8_t* data;
+    size_t len;
+    bool valid;
+    TraceHeader header;
+    size_t pos;
+    uint32_t index;
+    int64_t timeUs;
+    int16_t sample;
+};
+
+#endif // NOISE_ADC_TRACE_H
@@ -0,0 +1,185 @@
+#include "BlockKernels.h"
+#include <string.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include "sdkconfig.h"
+#endif
+
+#if NOISE_SIMD && defined(CONFIG_IDF_TARGET_ESP32S3)
+#define NOISE_BLOCK_PIE 1
+
+// BlockKernelsPie.S: in alineado a 16 bytes, vectors = bloques de 8 muestras (1..PIE_MAX_VECTORS)
+extern "C" void noise_block_stats_pie(const int16_t* in, uint32_t vectors, int32_t* out);
+extern "C" void noise_block_sub_pie(int16_t* samples, uint32_t vectors, int32_t pattern);
+
+// Con 32 vectores (256 muestras) ni -32768² por muestra desborda los 40 bits del acumulador
+static constexpr size_t PIE_MAX_VECTORS = 32;
+static constexpr size_t PIE_LANES = 8;
+
+// blockKernelsSelfCheck() la apaga si la ruta vectorial no da lo mismo que la escalar
+static bool pieEnabled = true;
+
+// El acumulador ACCX es de 40 bits con signo, leído en dos palabras
+static inline int64_t accxToInt64(uint32_t lo, uint32_t hi) {
+    int64_t v = static_cast<int64_t>((static_cast<uint64_t>(hi & 0xFF) << 32) | lo);
+    if (v & (INT64_C(1) << 39)) {
+        v -= INT64_C(1) << 40;
+    }
+    return v;
+}
+
+// Muestras hasta la siguiente dirección alineada a 16 bytes
+static inline size_t headSamples(const int16_t* p, size_t n) {
+    const size_t head = ((16 - (reinterpret_cast<uintptr_t>(p) & 15)) & 15) / sizeof(int16_t);
+    return head < n ? head : n;
+}
+#else
+#define NOISE_BLOCK_PIE 0
+#endif
+
+static void accumulateScalar(const int16_t* in, size_t n, BlockSums& out) {
+    for (size_t i = 0; i < n; i++) {
+        const int32_t v = in[i];
+        out.sum += v;
+        out.sumSq += static_cast<uint32_t>(v * v);
+        if (v < out.minValue) out.minValue = static_cast<int16_t>(v);
+        if (v > out.maxValue) out.maxValue = static_cast<int16_t>(v);
+    }
+}
+
+static void subtractScalar(int16_t* samples, size_t n, int16_t offset) {
+    for (size_t i = 0; i < n; i++) {
+        const int32_t v = static_cast<int32_t>(samples[i]) - offset;
+        samples[i] = static_cast<int16_t>(v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : v));
+    }
+}
+
+static inline void resetSums(BlockSums& out) {
+    out.sum = 0;
+    out.sumSq = 0;
+    out.minValue = INT16_MAX;
+    out.maxValue = INT16_MIN;
+}
+
+void blockStatsScalar(const int16_t* in, size_t n, BlockSums& out) {
+    resetSums(out);
+    accumulateScalar(in, n, out);
+}
+
+void blockSubtractScalar(int16_t* samples, size_t n, int16_t offset) {
+    subtractScalar(samples, n, offset);
+}
+
+void blockStats(const int16_t* in, size_t n, BlockSums& out) {
+    resetSums(out);
+#if NOISE_BLOCK_PIE
+    if (!pieEnabled) {
+        accumulateScalar(in, n, out);
+        return;
+    }
+    const size_t head = headSamples(in, n);
+    accumulateScalar(in, head, out);
+    in += head;
+    n -= head;
+
+    // acc: suma (2 palabras), suma de cuadrados (2), máximos por carril (8 x int16), mínimos (8)
+    alignas(16) int32_t acc[12];
+    while (n >= PIE_LANES) {
+        size_t vectors = n / PIE_LANES;
+        if (vectors > PIE_MAX_VECTORS) {
+            vectors = PIE_MAX_VECTORS;
+        }
+        noise_block_stats_pie(in, static_cast<uint32_t>(vectors), acc);
+        out.sum += accxToInt64(static_cast<uint32_t>(acc[0]), static_cast<uint32_t>(acc[1]));
+        out.sumSq += static_cast<uint64_t>(accxToInt64(static_cast<uint32_t>(acc[2]), static_cast<uint32_t>(acc[3])));
+        const int16_t* lanes = reinterpret_cast<const int16_t*>(&acc[4]);
+        for (size_t i = 0; i < PIE_LANES; i++) {
+            if (lanes[i] > out.maxValue) out.maxValue = lanes[i];
+            if (lanes[PIE_LANES + i] < out.minValue) out.minValue = lanes[PIE_LANES + i];
+        }
+        in += vectors * PIE_LANES;
+        n -= vectors * PIE_LANES;
+    }
+#endif
+    accumulateScalar(in, n, out);
+}
+
+void blockSubtract(int16_t* samples, size_t n, int16_t offset) {
+#if NOISE_BLOCK_PIE
+    if (!pieEnabled) {
+        subtractScalar(samples, n, offset);
+        return;
+    }
+    const size_t head = headSamples(samples, n);
+    subtractScalar(samples, head, offset);
+    samples += head;
+    n -= head;
+
+    const size_t vectors = n / PIE_LANES;
+    if (vectors > 0) {
+        // El offset replicado en los dos int16_t de cada palabra de 32 bits
+        const uint32_t half = static_cast<uint16_t>(offset);
+        noise_block_sub_pie(samples, static_cast<uint32_t>(vectors), static_cast<int32_t>(half | (half << 16)));
+        samples += vectors * PIE_LANES;
+        n -= vectors * PIE_LANES;
+    }
+#endif
+    subtractScalar(samples, n, offset);
+}
+
+bool blockKernelsVectorized() {
+#if NOISE_BLOCK_PIE
+    return pieEnabled;
+#else
+    return false;
+#endif
+}
+
+uint32_t blockKernelsSelfCheck() {
+    static constexpr size_t MAX_SAMPLES = 300;
+    static constexpr size_t MAX_SHIFT = 8;  // Desplazamientos de un int16_t dentro de 16 bytes
+    alignas(16) int16_t a[MAX_SAMPLES + MAX_SHIFT];
+    alignas(16) int16_t b[MAX_SAMPLES + MAX_SHIFT];
+    alignas(16) int16_t c[MAX_SAMPLES + MAX_SHIFT];
+    static const int16_t offsets[] = {0, 1, -1, 1234, INT16_MAX, INT16_MIN};
+    uint32_t lcg = 0x5EED;
+    uint32_t mismatches = 0;
+
+    for (uint8_t pattern = 0; pattern < 3; pattern++) {
+        for (size_t i = 0; i < MAX_SAMPLES + MAX_SHIFT; i++) {
+            lcg = lcg * 1664525u + 1013904223u;
+            // 0: todo el rango; 1: mV de micrófono; 2: solo extremos (peor caso del acumulador)
+            const int16_t v = pattern == 0   ? static_cast<int16_t>(lcg >> 16)
+                              : pattern == 1 ? static_cast<int16_t>(1200 + static_cast<int16_t>(lcg >> 16) / 64)
+                                             : ((lcg >> 16) & 1 ? INT16_MIN : INT16_MAX);
+            a[i] = v;
+        }
+        for (size_t shift = 0; shift < MAX_SHIFT; shift++) {
+            for (size_t n = 0; n <= MAX_SAMPLES; n++) {
+                BlockSums vector;
+                BlockSums scalar;
+                blockStats(&a[shift], n, vector);
+                blockStatsScalar(&a[shift], n, scalar);
+                if (vector.sum != scalar.sum || vector.sumSq != scalar.sumSq || vector.minValue != scalar.minValue ||
+                    vector.maxValue != scalar.maxValue) {
+                    mismatches++;
+                }
+
+                const int16_t offset = offsets[(n + shift) % (sizeof(offsets) / sizeof(offsets[0]))];
+                memcpy(b, a, sizeof(b));
+                memcpy(c, a, sizeof(c));
+                blockSubtract(&b[shift], n, offset);
+                subtractScalar(&c[shift], n, offset);
+                if (memcmp(b, c, sizeof(b)) != 0) {
+                    mismatches++;
+                }
+            }
+        }
+    }
+#if NOISE_BLOCK_PIE
+    if (mismatches != 0) {
+        pieEnabled = false;
+    }
+#endif
+    return mismatches;
+}
@@ -0,0 +1,51 @@
+#ifndef NOISE_BLOCK_KERNELS_H
+#define NOISE_BLOCK_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Kernels vectoriales con las instrucciones PIE del ESP32-S3 (0 = siempre la versión escalar)
+#ifndef NOISE_SIMD
+#define NOISE_SIMD 1
+#endif
+
+// Reducciones de un bloque de muestras
+struct BlockSums {
+    int64_t sum;
+    uint64_t sumSq;
+    int16_t minValue;
+    int16_t maxValue;
+};
+
+/**
+ * Kernels de bloque sobre muestras int16_t
+ *
+ * En el ESP32-S3 (con NOISE_SIMD) el cuerpo alineado a 16 bytes se procesa de 8 en 8
+ * muestras con PIE: multiplicar-acumular en el acumulador de 40 bits (suma y suma de
+ * cuadrados) y máximo/mínimo por carril. La cabeza y la cola se hacen en escalar, así que
+ * cualquier puntero y longitud sirven, aunque los buffers alineados con alignas(16) evitan
+ * la cabeza. En el resto de targets y en el host se usan las versiones escalares, que son
+ * la referencia: los resultados son idénticos bit a bit.
+ */
+
+// Suma, suma de cuadrados, mínimo y máximo de n muestras (n = 0: sumas a 0, min > max)
+void blockStats(const int16_t* in, size_t n, BlockSums& out);
+void blockStatsScalar(const int16_t* in, size_t n, BlockSums& out);
+
+// Restar offset a cada muestra con saturación a int16_t (eliminación de DC en el sitio)
+void blockSubtract(int16_t* samples, size_t n, int16_t offset);
+void blockSubtractScalar(int16_t* samples, size_t n, int16_t offset);
+
+// true si blockStats()/blockSubtract() usan la ruta vectorial en este build
+bool blockKernelsVectorized();
+
+/**
+ * Comparar blockStats()/blockSubtract() con las versiones escalares: todas las alineaciones
+ * de 2 bytes dentro de 16, longitudes de 0 a 300 muestras (varios tramos de 256 y colas),
+ * valores aleatorios y extremos, y offsets que saturan. Buffers en la pila (~1.9 KB).
+ * Si algo no coincide, la ruta vectorial se desactiva hasta el reinicio.
+ * @return Casos distintos (0 = idénticos bit a bit)
+ */
+uint32_t blockKernelsSelfCheck();
+
+#endif // NOISE_BLOCK_KERNELS_H
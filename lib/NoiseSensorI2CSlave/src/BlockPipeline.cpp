@@ -0,0 +1,67 @@
+#include "BlockPipeline.h"
+#include "BlockKernels.h"
+
+void* ScratchArena::allocate(size_t bytes, size_t align) {
+    const uintptr_t base = reinterpret_cast<uintptr_t>(buffer);
+    const uintptr_t start = (base + used + align - 1) & ~static_cast<uintptr_t>(align - 1);
+    const size_t offset = static_cast<size_t>(start - base);
+    if (offset > size || bytes > size - offset) {
+        return nullptr;
+    }
+    used = offset + bytes;
+    return buffer + offset;
+}
+
+void DcBlockerStage::process(int16_t* block, size_t n) {
+    if (n == 0) {
+        return;
+    }
+    BlockSums sums;
+    blockStats(block, n, sums);
+    const int64_t count = static_cast<int64_t>(n);
+    const int64_t half = (sums.sum >= 0) ? count / 2 : -(count / 2);
+    const int32_t meanQ8 = static_cast<int32_t>((sums.sum + half) / count) * 256;
+    if (primed) {
+        dcQ8 += (meanQ8 - dcQ8) >> shift;
+    } else {
+        dcQ8 = meanQ8;
+        primed = true;
+    }
+    blockSubtract(block, n, static_cast<int16_t>(getDc()));
+}
+
+BlockPipeline::BlockPipeline(uint8_t* arenaBuffer, size_t arenaSize)
+    : count(0), prepared(false), activeMask(0xFFFFFFFF), skipped(0), arena(arenaBuffer, arenaSize) {
+    for (uint8_t i = 0; i < NOISE_PIPELINE_MAX_STAGES; i++) {
+        stages[i] = nullptr;
+    }
+}
+
+bool BlockPipeline::add(BlockStage* stage) {
+    if (stage == nullptr || prepared || count >= NOISE_PIPELINE_MAX_STAGES) {
+        return false;
+    }
+    stages[count++] = stage;
+    return true;
+}
+
+uint8_t BlockPipeline::prepare() {
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (stages[i]->prepare(arena)) {
+            stages[kept++] = stages[i];
+        }
+    }
+    for (uint8_t i = kept; i < count; i++) {
+        stages[i] = nullptr;
+    }
+    count = kept;
+    prepared = true;
+    return count;
+}
+
+void BlockPipeline::setSampleRate(uint32_t sampleRateHz) {
+    for (uint8_t i = 0; i < count; i++) {
+        stages[i]->setSampleRate(sampleRateHz);
+    }
+}
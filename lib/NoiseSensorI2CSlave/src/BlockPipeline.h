@@ -0,0 +1,188 @@
+#ifndef NOISE_BLOCK_PIPELINE_H
+#define NOISE_BLOCK_PIPELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "LevelStats.h"
+#include "SlidingExtremes.h"
+
+// Etapas que admite la cadena (las de la librería incluidas)
+#ifndef NOISE_PIPELINE_MAX_STAGES
+#define NOISE_PIPELINE_MAX_STAGES 8
+#endif
+
+// Bytes de la zona de trabajo compartida por las etapas (estática, repartida en begin())
+#ifndef NOISE_PIPELINE_ARENA_BYTES
+#define NOISE_PIPELINE_ARENA_BYTES 1024
+#endif
+
+/**
+ * Zona de trabajo preasignada, repartida una sola vez entre las etapas
+ *
+ * Reserva por avance de puntero sobre un buffer estático: no hay liberación y, una vez
+ * preparada la cadena, no se reserva nada más (ni heap).
+ */
+class ScratchArena {
+public:
+    ScratchArena(uint8_t* buffer, size_t size) : buffer(buffer), size(size), used(0) {}
+
+    /**
+     * Reservar bytes de la zona
+     * @param align Alineación (potencia de 2; 16 para los kernels vectoriales)
+     * @return Puntero, o nullptr si no queda espacio
+     */
+    void* allocate(size_t bytes, size_t align = 4);
+
+    size_t getUsed() const { return used; }
+    size_t getSize() const { return size; }
+
+private:
+    uint8_t* buffer;
+    size_t size;
+    size_t used;
+};
+
+/**
+ * Etapa de la cadena de procesado por bloques
+ *
+ * process() recibe cada bloque de muestras en mV (int16_t, alineado a 16 bytes, como
+ * mucho STREAM_BLOCK_SAMPLES). Las etapas de transformación (bloqueo de DC, filtros de
+ * ponderación) lo modifican en el sitio; las de análisis (detectores, agregadores) solo
+ * lo leen. Cada etapa ve la salida de la anterior.
+ */
+class BlockStage {
+public:
+    virtual ~BlockStage() {}
+
+    /**
+     * Preparar la etapa una vez, desde begin()
+     * @param arena Zona de trabajo compartida para los buffers de la etapa
+     * @return false si la etapa no puede funcionar (se quita de la cadena)
+     */
+    virtual bool prepare(ScratchArena& arena) { (void)arena; return true; }
+
+    // Tasa de las muestras que llegan a process() (cambia con el ADC continuo o el loop)
+    virtual void setSampleRate(uint32_t sampleRateHz) { (void)sampleRateHz; }
+
+    virtual void process(int16_t* block, size_t n) = 0;
+
+    // Bit SUB_* que activa la etapa (0 = siempre activa); ver BlockPipeline::setActiveMask()
+    uint32_t subscription = 0;
+};
+
+/**
+ * Adaptador para cualquier acumulador con addBlock(const int16_t*, size_t)
+ * (LevelStats, TimeWeighting): lo convierte en etapa de análisis sin modificarlo.
+ */
+template <typename T>
+class BlockSink : public BlockStage {
+public:
+    explicit BlockSink(T& target) : target(target) {}
+    void process(int16_t* block, size_t n) override { target.addBlock(block, n); }
+
+private:
+    T& target;
+};
+
+/**
+ * Etapa de nivel de la librería: una sola reducción por bloque (blockStats) alimenta el
+ * intervalo (SensorDataFixed), el ciclo (campos de ciclo de SensorData) y, con el máximo y
+ * el mínimo del bloque, las ventanas deslizantes. Ninguna muestra se pierde entre lecturas.
+ */
+class LevelSink : public BlockStage {
+public:
+    LevelSink(LevelStats& interval, LevelCycle& cycle, SlidingExtremes* windows, uint8_t windowCount)
+        : interval(interval), cycle(cycle), windows(windows), windowCount(windowCount), nowUs(0) {}
+
+    // Instante de la última muestra del siguiente bloque (para las ventanas)
+    void setTime(int64_t us) { nowUs = us; }
+
+    void process(int16_t* block, size_t n) override {
+        if (n == 0) return;
+        BlockSums sums;
+        blockStats(block, n, sums);
+        interval.addSums(sums, n, block[n - 1]);
+        cycle.addSums(sums, n, block[n - 1]);
+        for (uint8_t i = 0; i < windowCount; i++) {
+            windows[i].addRange(sums.maxValue, sums.minValue, nowUs);
+        }
+    }
+
+private:
+    LevelStats& interval;
+    LevelCycle& cycle;
+    SlidingExtremes* windows;
+    uint8_t windowCount;
+    int64_t nowUs;
+};
+
+/**
+ * Bloqueo de DC: resta a cada bloque la media móvil (exponencial) de las medias de bloque
+ *
+ * Media y resta con los kernels de BlockKernels.h. La constante de tiempo es 2^shift
+ * bloques; la primera media se toma tal cual para no arrastrar un transitorio.
+ */
+class DcBlockerStage : public BlockStage {
+public:
+    explicit DcBlockerStage(uint8_t shift = 6) : shift(shift), dcQ8(0), primed(false) {}
+
+    void process(int16_t* block, size_t n) override;
+
+    int32_t getDc() const { return (dcQ8 + 128) >> 8; }
+
+private:
+    uint8_t shift;
+    int32_t dcQ8;             // DC estimado en mV, Q8
+    bool primed;
+};
+
+/**
+ * Cadena de etapas ejecutada en orden sobre cada bloque
+ */
+class BlockPipeline {
+public:
+    BlockPipeline(uint8_t* arenaBuffer, size_t arenaSize);
+
+    /**
+     * Añadir una etapa al final (antes de prepare())
+     * @return false si la cadena está llena o ya preparada
+     */
+    bool add(BlockStage* stage);
+
+    /**
+     * Preparar las etapas y repartir la zona de trabajo; las que fallan se quitan
+     * @return Etapas activas
+     */
+    uint8_t prepare();
+
+    void setSampleRate(uint32_t sampleRateHz);
+
+    void process(int16_t* block, size_t n) {
+        for (uint8_t i = 0; i < count; i++) {
+            const uint32_t bit = stages[i]->subscription;
+            if (bit == 0 || (activeMask & bit)) {
+                stages[i]->process(block, n);
+            } else {
+                skipped++;
+            }
+        }
+    }
+
+    // Suscripciones activas: las etapas con su bit a 0 no se ejecutan
+    void setActiveMask(uint32_t mask) { activeMask = mask; }
+    uint32_t getSkipped() const { return skipped; }
+
+    uint8_t getStageCount() const { return count; }
+    bool isPrepared() const { return prepared; }
+    const ScratchArena& getArena() const { return arena; }
+
+private:
+    BlockStage* stages[NOISE_PIPELINE_MAX_STAGES];
+    uint8_t count;
+    bool prepared;
+    uint32_t activeMask;
+    uint32_t skipped;         // Ejecuciones de etapas sin suscripción evitadas
+    ScratchArena arena;
+};
+
+#endif // NOISE_BLOCK_PIPELINE_H
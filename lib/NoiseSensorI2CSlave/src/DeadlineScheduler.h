@@ -0,0 +1,91 @@
+#ifndef NOISE_DEADLINE_SCHEDULER_H
+#define NOISE_DEADLINE_SCHEDULER_H
+
+#include <stdint.h>
+#include <string.h>
+
+static constexpr uint8_t JITTER_BUCKETS = 12;
+static constexpr uint32_t JITTER_FIRST_BUCKET_US = 250;
+
+// Histograma de retraso de los intervalos (respuesta a CMD_GET_JITTER)
+struct JitterHistogram {
+    uint32_t buckets[JITTER_BUCKETS]; // Bucket 0: < 250 µs; bucket i: < 250·2^i µs; el último: el resto
+    uint32_t intervals;               // Intervalos ejecutados
+    uint32_t skipped;                 // Intervalos saltados (retraso mayor que un periodo)
+    uint32_t maxJitterUs;             // Mayor retraso observado
+};
+
+/**
+ * Planificador de periodo fijo sobre plazos absolutos
+ *
+ * El siguiente plazo se calcula sumando el periodo al plazo anterior, no al instante en
+ * que se atendió, así que el retraso de una llamada no se acumula. Si el retraso supera
+ * un periodo completo, los intervalos perdidos se cuentan como saltados en lugar de
+ * ejecutarse en ráfaga (darían registros idénticos).
+ */
+class DeadlineScheduler {
+public:
+    DeadlineScheduler() : deadline(0), periodUs(1), lastLateUs(0) { resetHistogram(); }
+
+    void start(int64_t nowUs, uint32_t period) {
+        periodUs = period > 0 ? period : 1;
+        deadline = nowUs + periodUs;
+        lastLateUs = 0;
+    }
+
+    // Cambiar el periodo: el siguiente plazo se mantiene anclado al último atendido
+    void setPeriod(uint32_t period) {
+        if (period == 0 || period == periodUs) return;
+        deadline = deadline - periodUs + period;
+        periodUs = period;
+    }
+
+    /**
+     * Comprobar si ha vencido el plazo y avanzar al siguiente
+     * @param nowUs Tiempo actual en µs
+     * @return true si hay que ejecutar un intervalo
+     */
+    bool poll(int64_t nowUs) {
+        if (nowUs < deadline) {
+            return false;
+        }
+
+        const uint64_t late = static_cast<uint64_t>(nowUs - deadline);
+        const uint64_t missed = late / periodUs;
+        deadline += static_cast<int64_t>((missed + 1) * periodUs);
+
+        lastLateUs = late > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(late);
+        histogram.intervals++;
+        histogram.skipped += static_cast<uint32_t>(missed);
+        histogram.buckets[bucketFor(lastLateUs)]++;
+        if (lastLateUs > histogram.maxJitterUs) {
+            histogram.maxJitterUs = lastLateUs;
+        }
+        return true;
+    }
+
+    void resetHistogram() { memset(&histogram, 0, sizeof(histogram)); }
+
+    const JitterHistogram& getHistogram() const { return histogram; }
+    uint32_t getLastLateUs() const { return lastLateUs; }
+    uint32_t getPeriodUs() const { return periodUs; }
+    int64_t getDeadline() const { return deadline; }
+
+private:
+    int64_t deadline;
+    uint32_t periodUs;
+    uint32_t lastLateUs;
+    JitterHistogram histogram;
+
+    static uint8_t bucketFor(uint32_t lateUs) {
+        uint8_t i = 0;
+        uint32_t limit = JITTER_FIRST_BUCKET_US;
+        while (i < JITTER_BUCKETS - 1 && lateUs >= limit) {
+            limit <<= 1;
+            i++;
+        }
+        return i;
+    }
+};
+
+#endif // NOISE_DEADLINE_SCHEDULER_H
@@ -0,0 +1,80 @@
+#include "Decimator.h"
+#include <string.h>
+#include "FixedPoint.h"
+
+// FIR compensador (mínimos cuadrados sobre 1/sinc^3), Q15, ganancia DC = 1
+static const int16_t COMPENSATOR_Q15[Decimator::FIR_TAPS] = {
+    152, 1369, -1942, -3760, 9860, 21410, 9860, -3760, -1942, 1369, 152
+};
+
+Decimator::Decimator() : ratio(MIN_RATIO), phase(0), gainQ31(0), firPos(0) {
+    setRatio(16);
+}
+
+bool Decimator::setRatio(uint8_t newRatio) {
+    if (newRatio < MIN_RATIO || newRatio > MAX_RATIO) {
+        return false;
+    }
+    ratio = newRatio;
+    const uint32_t gain = static_cast<uint32_t>(ratio) * ratio * ratio;
+    gainQ31 = static_cast<int32_t>(((1ULL << 31) + gain / 2) / gain);
+    reset();
+    return true;
+}
+
+void Decimator::reset() {
+    phase = 0;
+    memset(integrators, 0, sizeof(integrators));
+    memset(combs, 0, sizeof(combs));
+    memset(firDelay, 0, sizeof(firDelay));
+    firPos = 0;
+}
+
+size_t Decimator::process(const int16_t* in, size_t n, int16_t* out) {
+    // Estado en locales durante el bloque para que el compilador lo mantenga en registros
+    uint32_t i0 = integrators[0];
+    uint32_t i1 = integrators[1];
+    uint32_t i2 = integrators[2];
+    uint8_t ph = phase;
+    size_t produced = 0;
+
+    for (size_t k = 0; k < n; k++) {
+        i0 += static_cast<uint32_t>(static_cast<int32_t>(in[k]));
+        i1 += i0;
+        i2 += i1;
+        if (++ph < ratio) {
+            continue;
+        }
+        ph = 0;
+
+        const uint32_t c0 = i2 - combs[0];
+        combs[0] = i2;
+        const uint32_t c1 = c0 - combs[1];
+        combs[1] = c0;
+        const uint32_t c2 = c1 - combs[2];
+        combs[2] = c1;
+
+        const int32_t y = static_cast<int32_t>((static_cast<int64_t>(static_cast<int32_t>(c2)) * gainQ31) >> 31);
+        out[produced++] = filter(q15Saturate(y));
+    }
+
+    integrators[0] = i0;
+    integrators[1] = i1;
+    integrators[2] = i2;
+    phase = ph;
+    return produced;
+}
+
+int16_t Decimator::filter(int16_t sample) {
+    firDelay[firPos] = sample;
+    firDelay[firPos + FIR_TAPS] = sample;
+    firPos = static_cast<uint8_t>(firPos + 1 == FIR_TAPS ? 0 : firPos + 1);
+
+    // firDelay[firPos .. firPos + TAPS) contiene las últimas TAPS muestras, de la más antigua a la más nueva
+    const int16_t* x = &firDelay[firPos];
+    int32_t acc = 0;
+    for (uint8_t k = 0; k < FIR_TAPS; k++) {
+        acc += static_cast<int32_t>(COMPENSATOR_Q15[k]) * x[k];
+    }
+    return q15Saturate((acc + (1 << 14)) >> 15);
+}
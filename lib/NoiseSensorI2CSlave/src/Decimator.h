@@ -0,0 +1,59 @@
+#ifndef NOISE_DECIMATOR_H
+#define NOISE_DECIMATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Decimador multirate en punto fijo: CIC de orden 3 + FIR compensador de 11 taps
+ *
+ * El CIC reduce la tasa por el factor configurado (solo sumas y restas, sin multiplicar
+ * por muestra) y el FIR compensa su caída en la banda de paso. Respuesta conjunta medida
+ * con tools/decimator_check para ratio >= 4, f relativa a la tasa de salida: ±0.5 dB hasta 0.2·fs,
+ * -19.5 dB a 0.35·fs, < -42 dB desde 0.4·fs; lo que se pliega sobre la banda de paso
+ * queda por debajo de -34 dB. Con ratio 2 y 3 el CIC atenúa menos (alias de hasta -29 dB).
+ *
+ * Rango de entrada: los integradores trabajan en módulo 2^32, así que la salida exacta
+ * del CIC (entrada · ratio^3) debe caber en 31 bits: con ratio 64 la entrada admite
+ * 13 bits con signo, suficiente para las muestras de 12 bits del ADC.
+ */
+class Decimator {
+public:
+    static constexpr uint8_t MIN_RATIO = 2;
+    static constexpr uint8_t MAX_RATIO = 64;
+    static constexpr uint8_t FIR_TAPS = 11;
+
+    Decimator();
+
+    /**
+     * Configurar el factor de decimación (reinicia el estado)
+     * @param ratio Entre MIN_RATIO y MAX_RATIO
+     * @return true si el factor es válido
+     */
+    bool setRatio(uint8_t ratio);
+    uint8_t getRatio() const { return ratio; }
+
+    void reset();
+
+    /**
+     * Procesar un bloque de muestras
+     * @param in Muestras de entrada
+     * @param n Número de muestras de entrada
+     * @param out Salida decimada (capacidad mínima: n / ratio + 1)
+     * @return Número de muestras escritas en out
+     */
+    size_t process(const int16_t* in, size_t n, int16_t* out);
+
+private:
+    uint8_t ratio;
+    uint8_t phase;
+    int32_t gainQ31;                  // 1 / ratio^3 en Q31
+    uint32_t integrators[3];
+    uint32_t combs[3];
+    int16_t firDelay[2 * FIR_TAPS];   // Línea de retardo duplicada: lectura contigua sin módulo
+    uint8_t firPos;
+
+    int16_t filter(int16_t sample);
+};
+
+#endif // NOISE_DECIMATOR_H
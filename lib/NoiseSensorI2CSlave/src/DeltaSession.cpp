@@ -0,0 +1,106 @@
+#include "DeltaSession.h"
+#include <string.h>
+
+struct DeltaFieldInfo {
+    uint8_t offset;
+    uint8_t size;
+};
+
+#define DELTA_FIELD(member) { static_cast<uint8_t>(offsetof(SensorData, member)), static_cast<uint8_t>(sizeof(SensorData::member)) }
+
+// En el orden de los bits de DeltaField
+static const DeltaFieldInfo DELTA_FIELDS[DELTA_FIELD_COUNT] = {
+    DELTA_FIELD(noise),
+    DELTA_FIELD(noiseAvg),
+    DELTA_FIELD(noisePeak),
+    DELTA_FIELD(noiseMin),
+    DELTA_FIELD(noiseAvgLegal),
+    DELTA_FIELD(noiseAvgLegalMax),
+    DELTA_FIELD(lowNoiseLevel),
+    DELTA_FIELD(intervalMs),
+    DELTA_FIELD(cycles),
+    DELTA_FIELD(timestamp)
+};
+
+#undef DELTA_FIELD
+
+void DeltaSession::track(const SensorData& record, const float* bands) {
+    deadbands = bands;
+    dirty = synced ? compare(record) : DELTA_ALL_FIELDS;
+}
+
+uint16_t DeltaSession::compare(const SensorData& record) const {
+    const float levels[DELTA_LEVEL_FIELDS] = {
+        record.noise, record.noiseAvg, record.noisePeak,
+        record.noiseMin, record.noiseAvgLegal, record.noiseAvgLegalMax
+    };
+    const float sentLevels[DELTA_LEVEL_FIELDS] = {
+        sent.noise, sent.noiseAvg, sent.noisePeak,
+        sent.noiseMin, sent.noiseAvgLegal, sent.noiseAvgLegalMax
+    };
+
+    uint16_t mask = 0;
+    for (uint8_t i = 0; i < DELTA_LEVEL_FIELDS; i++) {
+        const float diff = levels[i] - sentLevels[i];
+        if (diff > deadbands[i] || diff < -deadbands[i]) {
+            mask |= static_cast<uint16_t>(1u << i);
+        }
+    }
+    // Campos enteros: cualquier cambio cuenta
+    if (record.lowNoiseLevel != sent.lowNoiseLevel) mask |= DELTA_LOW_NOISE_LEVEL;
+    if (record.intervalMs != sent.intervalMs) mask |= DELTA_INTERVAL;
+    if (record.cycles != sent.cycles) mask |= DELTA_CYCLES;
+
+    // El timestamp cambia en cada registro: solo acompaña a otros cambios para fecharlos
+    if (mask != 0) {
+        mask |= DELTA_TIMESTAMP;
+    }
+    return mask;
+}
+
+size_t DeltaSession::encode(const SensorData& record, uint8_t* out) {
+    uint8_t* base = reinterpret_cast<uint8_t*>(&sent);
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(&record);
+
+    // La confirmación llega con la petición: la trama confirmada pasa a ser la línea base
+    const uint8_t ack = ackSeq;
+    ackSeq = 0;
+    if (pendingSeq != 0 && ack == pendingSeq) {
+        const uint8_t* confirmed = reinterpret_cast<const uint8_t*>(&pending);
+        for (uint8_t i = 0; i < DELTA_FIELD_COUNT; i++) {
+            if (pendingMask & (1u << i)) {
+                const DeltaFieldInfo& f = DELTA_FIELDS[i];
+                memcpy(base + f.offset, confirmed + f.offset, f.size);
+            }
+        }
+        pendingSeq = 0;
+        synced = true;
+        dirty = compare(record);
+    }
+
+    const uint16_t mask = dirty;
+    if (mask == 0) {
+        out[0] = DELTA_NO_CHANGE;
+        return 1;
+    }
+
+    sequence = static_cast<uint8_t>(sequence == 0xFF ? 1 : sequence + 1);
+    out[0] = DELTA_CHANGED;
+    out[1] = sequence;
+    memcpy(&out[2], &mask, sizeof(mask));
+    size_t len = 2 + sizeof(mask);
+
+    // Sin confirmación no se toca la línea base: dirty sigue marcando estos campos
+    uint8_t* dst = reinterpret_cast<uint8_t*>(&pending);
+    for (uint8_t i = 0; i < DELTA_FIELD_COUNT; i++) {
+        if (mask & (1u << i)) {
+            const DeltaFieldInfo& f = DELTA_FIELDS[i];
+            memcpy(&out[len], src + f.offset, f.size);
+            memcpy(dst + f.offset, src + f.offset, f.size);
+            len += f.size;
+        }
+    }
+    pendingMask = mask;
+    pendingSeq = sequence;
+    return len;
+}
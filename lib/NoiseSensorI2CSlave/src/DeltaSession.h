@@ -0,0 +1,90 @@
+#ifndef NOISE_DELTA_SESSION_H
+#define NOISE_DELTA_SESSION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "I2CProtocol.h"
+
+// Campos de SensorData en las tramas delta (bit N del mapa = campo N, en el orden del struct)
+enum DeltaField : uint16_t {
+    DELTA_NOISE = 1u << 0,
+    DELTA_NOISE_AVG = 1u << 1,
+    DELTA_NOISE_PEAK = 1u << 2,
+    DELTA_NOISE_MIN = 1u << 3,
+    DELTA_NOISE_AVG_LEGAL = 1u << 4,
+    DELTA_NOISE_AVG_LEGAL_MAX = 1u << 5,
+    DELTA_LOW_NOISE_LEVEL = 1u << 6,
+    DELTA_INTERVAL = 1u << 7,
+    DELTA_CYCLES = 1u << 8,
+    DELTA_TIMESTAMP = 1u << 9
+};
+
+static constexpr uint8_t DELTA_FIELD_COUNT = 10;
+static constexpr uint8_t DELTA_LEVEL_FIELDS = 6;        // Campos float con banda muerta
+static constexpr uint16_t DELTA_ALL_FIELDS = (1u << DELTA_FIELD_COUNT) - 1;
+
+// Primer byte de la respuesta a CMD_GET_DELTA (0x00 sigue significando "sin datos")
+static constexpr uint8_t DELTA_NO_CHANGE = 0x80;        // Respuesta de 1 byte: nada se alejó de lo confirmado
+static constexpr uint8_t DELTA_CHANGED = 0x81;          // Sigue uint8_t secuencia, uint16_t mapa y los campos marcados
+static constexpr size_t DELTA_MAX_FRAME = 2 + sizeof(uint16_t) + sizeof(SensorData);
+
+/**
+ * Estado delta de una sesión de maestro
+ *
+ * Guarda los valores que el maestro confirmó tener y el mapa de campos que se alejaron
+ * de ellos más allá de su banda muerta. track() se llama desde update() con cada registro;
+ * encode() desde onRequest() escribe solo los campos marcados con un número de secuencia.
+ * Una trama solo pasa a ser la línea base cuando el maestro devuelve su secuencia en el
+ * siguiente CMD_GET_DELTA (acknowledge()): si la lectura se pierde en el bus, la siguiente
+ * vuelve a llevar los mismos campos. Se compara con lo confirmado, no con el registro
+ * anterior: una deriva lenta acaba superando la banda.
+ *
+ * No tiene cerrojo propio: el esclavo llama a track(), encode() y acknowledge() bajo el
+ * mismo CommandLock, porque corren en tareas distintas (loop y driver I2C).
+ */
+class DeltaSession {
+public:
+    DeltaSession() : deadbands(nullptr), sequence(0) { reset(); }
+
+    // Forzar una trama completa en la próxima lectura
+    void reset() {
+        dirty = DELTA_ALL_FIELDS;
+        synced = false;
+        pendingMask = 0;
+        pendingSeq = 0;
+        ackSeq = 0;
+    }
+
+    /**
+     * Registrar la secuencia devuelta por el maestro con la petición (0 = ninguna)
+     * @param sequence Secuencia de la última trama que recibió
+     */
+    void acknowledge(uint8_t sequence) { ackSeq = sequence; }
+
+    void track(const SensorData& record, const float* deadbands);
+
+    /**
+     * Escribir la trama delta del registro actual
+     * @param record Registro publicado
+     * @param out Buffer de al menos DELTA_MAX_FRAME bytes
+     * @return Bytes escritos (1 si no hay cambios)
+     */
+    size_t encode(const SensorData& record, uint8_t* out);
+
+    uint16_t getDirty() const { return dirty; }
+
+private:
+    SensorData sent;             // Línea base: lo que el maestro confirmó
+    SensorData pending;          // Campos de la última trama, a la espera de confirmación
+    const float* deadbands;
+    volatile uint16_t dirty;
+    uint16_t pendingMask;
+    uint8_t sequence;            // Última secuencia enviada (nunca 0)
+    uint8_t pendingSeq;          // 0 = ninguna trama pendiente
+    volatile uint8_t ackSeq;
+    bool synced;
+
+    uint16_t compare(const SensorData& record) const;
+};
+
+#endif // NOISE_DELTA_SESSION_H
@@ -0,0 +1,83 @@
+#ifndef NOISE_FIXED_POINT_H
+#define NOISE_FIXED_POINT_H
+
+#include <stdint.h>
+
+/**
+ * Utilidades de punto fijo para targets sin FPU (ESP32-C3)
+ *
+ * Q15: int16_t con 15 bits fraccionarios, rango [-1, 1) (coeficientes del decimador)
+ * Los niveles en dB se expresan en centésimas de dB (centi-dB) como int32_t.
+ */
+typedef int16_t q15_t;
+
+// log2(1 + i/32) en Q16, i = 0..32 (interpolación lineal entre entradas)
+static const uint32_t FIXED_LOG2_LUT[33] = {
+    0, 2909, 5732, 8473, 11136, 13727, 16248, 18704, 21098, 23433, 25711,
+    27936, 30109, 32234, 34312, 36346, 38336, 40286, 42196, 44068, 45904,
+    47705, 49472, 51207, 52911, 54584, 56229, 57845, 59434, 60997, 62534,
+    64047, 65536
+};
+
+static inline q15_t q15Saturate(int32_t v) {
+    return static_cast<q15_t>(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+/**
+ * Raíz cuadrada entera redondeada al más próximo, bit a bit: 32 iteraciones de sumas y
+ * desplazamientos, sin división ni float
+ */
+static inline uint32_t fixedSqrt64(uint64_t x) {
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    // Resto x - root²: por encima de root, (root + 0.5)² queda por debajo de x
+    return static_cast<uint32_t>(x > root ? root + 1 : root);
+}
+
+/**
+ * log2(x) en Q16 (error de interpolación < 0.02 dB al convertir a dB)
+ * @param x Valor > 0 (para x = 0 devuelve 0)
+ */
+static inline int32_t fixedLog2Q16(uint64_t x) {
+    if (x == 0) {
+        return 0;
+    }
+    const int n = 63 - __builtin_clzll(x);
+    // Mantisa normalizada a [1, 2) con 16 bits fraccionarios
+    const uint32_t m = static_cast<uint32_t>(n >= 16 ? (x >> (n - 16)) : (x << (16 - n)));
+    const uint32_t frac = m - 65536u;
+    const uint32_t i = frac >> 11;
+    const uint32_t rem = frac & 2047u;
+    const int32_t lo = FIXED_LOG2_LUT[i];
+    const int32_t hi = FIXED_LOG2_LUT[i + 1];
+    return (n << 16) + lo + (((hi - lo) * static_cast<int32_t>(rem)) >> 11);
+}
+
+/**
+ * Potencia a centi-dB: 1000 * log10(power)
+ * (10 * log10 en dB, por 100 para centi-dB; log10(2) * 1000 / 65536 * 2^18 ≈ 1204)
+ */
+static inline int32_t fixedPowerToCentiDb(uint64_t power) {
+    return static_cast<int32_t>((static_cast<int64_t>(fixedLog2Q16(power)) * 1204) >> 18);
+}
+
+/**
+ * Amplitud a centi-dB: 2000 * log10(amplitude)
+ */
+static inline int32_t fixedAmplitudeToCentiDb(uint32_t amplitude) {
+    return fixedPowerToCentiDb(static_cast<uint64_t>(amplitude) * amplitude);
+}
+
+#endif // NOISE_FIXED_POINT_H
@@ -0,0 +1,508 @@
+#include "FlashLog.h"
+#include <string.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include "esp_partition.h"
+
+// Partición de datos accedida con esp_partition (la caché de flash se gestiona en el IDF)
+class PartitionFlash : public LogFlashDevice {
+public:
+    PartitionFlash() : partition(nullptr) {}
+
+    bool open(const char* label) {
+        partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+        return partition != nullptr;
+    }
+
+    uint32_t size() const override { return partition->size; }
+
+    bool read(uint32_t offset, void* dst, size_t len) override {
+        return esp_partition_read(partition, offset, dst, len) == ESP_OK;
+    }
+
+    bool write(uint32_t offset, const void* src, size_t len) override {
+        return esp_partition_write(partition, offset, src, len) == ESP_OK;
+    }
+
+    bool eraseSector(uint32_t offset) override {
+        return esp_partition_erase_range(partition, offset, LOG_SECTOR_BYTES) == ESP_OK;
+    }
+
+private:
+    const esp_partition_t* partition;
+};
+
+LogFlashDevice* openLogPartition(const char* label) {
+    static PartitionFlash flash;
+    return flash.open(label) ? &flash : nullptr;
+}
+#else
+LogFlashDevice* openLogPartition(const char* label) {
+    (void)label;
+    return nullptr;
+}
+#endif
+
+// --- Codificación de registros ---
+
+static constexpr uint8_t LOG_FLOAT_FIELDS = 6;
+static constexpr uint8_t LOG_MASK_LOW_NOISE = 1u << 6;
+static constexpr uint8_t LOG_MASK_INTERVAL = 1u << 7;
+
+static size_t putVarint(uint8_t* out, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = static_cast<uint8_t>(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = static_cast<uint8_t>(v);
+    return n;
+}
+
+static size_t getVarint(const uint8_t* in, size_t len, uint64_t& v) {
+    v = 0;
+    for (size_t n = 0; n < len && n < 10; n++) {
+        v |= static_cast<uint64_t>(in[n] & 0x7F) << (7 * n);
+        if ((in[n] & 0x80) == 0) {
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+static uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+static void floatFields(const SensorData& d, uint32_t* bits) {
+    memcpy(&bits[0], &d.noise, sizeof(uint32_t));
+    memcpy(&bits[1], &d.noiseAvg, sizeof(uint32_t));
+    memcpy(&bits[2], &d.noisePeak, sizeof(uint32_t));
+    memcpy(&bits[3], &d.noiseMin, sizeof(uint32_t));
+    memcpy(&bits[4], &d.noiseAvgLegal, sizeof(uint32_t));
+    memcpy(&bits[5], &d.noiseAvgLegalMax, sizeof(uint32_t));
+}
+
+static void setFloatFields(SensorData& d, const uint32_t* bits) {
+    memcpy(&d.noise, &bits[0], sizeof(uint32_t));
+    memcpy(&d.noiseAvg, &bits[1], sizeof(uint32_t));
+    memcpy(&d.noisePeak, &bits[2], sizeof(uint32_t));
+    memcpy(&d.noiseMin, &bits[3], sizeof(uint32_t));
+    memcpy(&d.noiseAvgLegal, &bits[4], sizeof(uint32_t));
+    memcpy(&d.noiseAvgLegalMax, &bits[5], sizeof(uint32_t));
+}
+
+size_t logEncodeRecord(const SensorData& prev, const SensorData& record, uint8_t* out) {
+    size_t len = putVarint(out, zigzag(static_cast<int64_t>(record.timestamp - prev.timestamp)));
+
+    uint32_t bits[LOG_FLOAT_FIELDS];
+    uint32_t prevBits[LOG_FLOAT_FIELDS];
+    floatFields(record, bits);
+    floatFields(prev, prevBits);
+
+    uint8_t& mask = out[len++];
+    mask = 0;
+    for (uint8_t i = 0; i < LOG_FLOAT_FIELDS; i++) {
+        const uint32_t x = bits[i] ^ prevBits[i];
+        if (x == 0) {
+            continue;
+        }
+        mask |= static_cast<uint8_t>(1u << i);
+        // Bytes nulos por abajo (los de arriba se deducen del número de significativos)
+        uint8_t low = 0;
+        while (((x >> (8 * low)) & 0xFF) == 0) {
+            low++;
+        }
+        uint8_t n = 4 - low;
+        while (((x >> (8 * (low + n - 1))) & 0xFF) == 0) {
+            n--;
+        }
+        out[len++] = static_cast<uint8_t>((low << 4) | n);
+        for (uint8_t b = 0; b < n; b++) {
+            out[len++] = static_cast<uint8_t>(x >> (8 * (low + b)));
+        }
+    }
+
+    if (record.lowNoiseLevel != prev.lowNoiseLevel) {
+        mask |= LOG_MASK_LOW_NOISE;
+        len += putVarint(&out[len], zigzag(static_cast<int64_t>(record.lowNoiseLevel) - prev.lowNoiseLevel));
+    }
+    if (record.intervalMs != prev.intervalMs) {
+        mask |= LOG_MASK_INTERVAL;
+        len += putVarint(&out[len], zigzag(static_cast<int64_t>(record.intervalMs) - prev.intervalMs));
+    }
+    len += putVarint(&out[len], zigzag(static_cast<int64_t>(record.cycles) - prev.cycles));
+    return len;
+}
+
+size_t logDecodeRecord(const SensorData& prev, const uint8_t* in, size_t len, SensorData& record) {
+    uint64_t v;
+    size_t pos = getVarint(in, len, v);
+    if (pos == 0 || pos >= len) {
+        return 0;
+    }
+    record = prev;
+    record.timestamp = prev.timestamp + static_cast<uint64_t>(unzigzag(v));
+
+    const uint8_t mask = in[pos++];
+    uint32_t bits[LOG_FLOAT_FIELDS];
+    floatFields(prev, bits);
+    for (uint8_t i = 0; i < LOG_FLOAT_FIELDS; i++) {
+        if ((mask & (1u << i)) == 0) {
+            continue;
+        }
+        if (pos >= len) {
+            return 0;
+        }
+        const uint8_t low = in[pos] >> 4;
+        const uint8_t n = in[pos] & 0x0F;
+        pos++;
+        if (n == 0 || low + n > 4 || pos + n > len) {
+            return 0;
+        }
+        uint32_t x = 0;
+        for (uint8_t b = 0; b < n; b++) {
+            x |= static_cast<uint32_t>(in[pos++]) << (8 * (low + b));
+        }
+        bits[i] ^= x;
+    }
+    setFloatFields(record, bits);
+
+    size_t n;
+    if (mask & LOG_MASK_LOW_NOISE) {
+        if ((n = getVarint(&in[pos], len - pos, v)) == 0) return 0;
+        pos += n;
+        record.lowNoiseLevel = static_cast<uint16_t>(prev.lowNoiseLevel + unzigzag(v));
+    }
+    if (mask & LOG_MASK_INTERVAL) {
+        if ((n = getVarint(&in[pos], len - pos, v)) == 0) return 0;
+        pos += n;
+        record.intervalMs = static_cast<uint16_t>(prev.intervalMs + unzigzag(v));
+    }
+    if ((n = getVarint(&in[pos], len - pos, v)) == 0) return 0;
+    pos += n;
+    record.cycles = static_cast<uint32_t>(prev.cycles + unzigzag(v));
+    return pos;
+}
+
+// --- Log ---
+
+FlashLog::FlashLog()
+    : device(nullptr), pageCount(0), pagesPerSector(LOG_SECTOR_BYTES / LOG_PAGE_BYTES),
+      headSeq(0), oldestSeq(0), readSeq(0), readLoaded(false), readIndex(0), readOffset(0),
+      pagesWritten(0), rawBytes(0), storedBytes(0), writeErrors(0), runCount(0), runsOverflow(false),
+      hasLastPage(false), lastPageEnd(0) {
+    startPage();
+    memset(&readPrev, 0, sizeof(readPrev));
+}
+
+void FlashLog::startPage() {
+    memset(writePage, 0xFF, sizeof(writePage));
+    LogPageHeader& h = writeHeader();
+    h.magic = LOG_PAGE_MAGIC;
+    h.count = 0;
+    h.used = 0;
+    h.sequence = headSeq;
+    h.firstTimestamp = 0;
+    h.lastTimestamp = 0;
+    memset(&writePrev, 0, sizeof(writePrev));
+}
+
+bool FlashLog::begin(LogFlashDevice* flashDevice) {
+    device = nullptr;
+    if (flashDevice == nullptr) {
+        return false;
+    }
+    const uint32_t sectors = flashDevice->size() / LOG_SECTOR_BYTES;
+    if (sectors < 2) {
+        return false;  // Borrar un sector no puede dejar el log vacío
+    }
+    device = flashDevice;
+    pageCount = sectors * pagesPerSector;
+
+    // Recorrer las cabeceras: las secuencias válidas son contiguas de oldest a newest
+    bool found = false;
+    uint32_t newest = 0;
+    uint32_t oldest = 0;
+    for (uint32_t i = 0; i < pageCount; i++) {
+        LogPageHeader h;
+        if (!device->read(i * LOG_PAGE_BYTES, &h, sizeof(h)) || h.magic != LOG_PAGE_MAGIC ||
+            h.count == 0 || h.used > LOG_PAGE_PAYLOAD || h.sequence % pageCount != i) {
+            continue;
+        }
+        if (!found || static_cast<int32_t>(h.sequence - newest) > 0) newest = h.sequence;
+        if (!found || static_cast<int32_t>(h.sequence - oldest) < 0) oldest = h.sequence;
+        found = true;
+    }
+    headSeq = found ? newest + 1 : 0;
+    oldestSeq = found ? oldest : headSeq;
+
+    // Segunda pasada en orden de secuencia para los tramos de timestamps
+    runCount = 0;
+    runsOverflow = false;
+    hasLastPage = false;
+    for (uint32_t seq = oldestSeq; seq != headSeq; seq++) {
+        LogPageHeader h;
+        if (readHeader(seq, h)) {
+            notePage(seq, h);
+        }
+    }
+
+    // La página siguiente debe estar borrada; si no (escritura cortada), saltar al próximo sector
+    if (headSeq % pagesPerSector != 0) {
+        uint16_t magic = 0;
+        if (!device->read(pageOffset(headSeq), &magic, sizeof(magic)) || magic != 0xFFFF) {
+            headSeq += pagesPerSector - headSeq % pagesPerSector;
+        }
+    }
+    startPage();
+    seekOldest();
+    return true;
+}
+
+void FlashLog::append(const SensorData& record) {
+    if (device == nullptr) {
+        return;
+    }
+    uint8_t encoded[LOG_MAX_RECORD_BYTES];
+    LogPageHeader& h = writeHeader();
+    size_t len = logEncodeRecord(writePrev, record, encoded);
+    if (h.count == 255 || h.used + len > LOG_PAGE_PAYLOAD) {
+        flush();
+        len = logEncodeRecord(writePrev, record, encoded);
+    }
+    if (h.count == 0) {
+        h.firstTimestamp = record.timestamp;
+    }
+    h.lastTimestamp = record.timestamp;
+    memcpy(&writePage[sizeof(LogPageHeader) + h.used], encoded, len);
+    h.used = static_cast<uint8_t>(h.used + len);
+    h.count++;
+    writePrev = record;
+}
+
+bool FlashLog::flush() {
+    const LogPageHeader& h = writeHeader();
+    if (device == nullptr || h.count == 0) {
+        return true;
+    }
+    const uint32_t offset = pageOffset(headSeq);
+    bool ok = true;
+    if (headSeq % pagesPerSector == 0) {
+        // Entrar en un sector lo borra: caen las páginas más antiguas que tenía
+        ok = device->eraseSector(offset);
+        if (headSeq + pagesPerSector > pageCount &&
+            static_cast<int32_t>(headSeq + pagesPerSector - pageCount - oldestSeq) > 0) {
+            oldestSeq = headSeq + pagesPerSector - pageCount;
+            dropRuns();
+        }
+    }
+    const size_t bytes = sizeof(LogPageHeader) + h.used;
+    ok = ok && device->write(offset, writePage, bytes);
+    if (ok) {
+        notePage(headSeq, h);
+        pagesWritten++;
+        storedBytes += bytes;
+        rawBytes += static_cast<uint32_t>(h.count) * sizeof(SensorData);
+    } else {
+        writeErrors++;
+    }
+    // Con error la página se descarta: reintentar sobre un sector dañado bloquearía el log
+    headSeq++;
+    startPage();
+    return ok;
+}
+
+void FlashLog::notePage(uint32_t seq, const LogPageHeader& header) {
+    if (hasLastPage && header.firstTimestamp < lastPageEnd && seq != oldestSeq) {
+        if (runCount < NOISE_LOG_MAX_RUNS) {
+            runStarts[runCount++] = seq;
+        } else {
+            runsOverflow = true;
+        }
+    }
+    hasLastPage = true;
+    lastPageEnd = header.lastTimestamp;
+}
+
+void FlashLog::dropRuns() {
+    // Los tramos que empiezan en una página borrada pasan a ser el primero
+    uint8_t dropped = 0;
+    while (dropped < runCount && static_cast<int32_t>(runStarts[dropped] - oldestSeq) <= 0) {
+        dropped++;
+    }
+    for (uint8_t i = dropped; i < runCount; i++) {
+        runStarts[i - dropped] = runStarts[i];
+    }
+    runCount = static_cast<uint8_t>(runCount - dropped);
+}
+
+bool FlashLog::readHeader(uint32_t seq, LogPageHeader& header) {
+    if (seq == headSeq) {
+        header = writeHeader();
+        return true;
+    }
+    return device->read(pageOffset(seq), &header, sizeof(header)) &&
+           header.magic == LOG_PAGE_MAGIC && header.sequence == seq;
+}
+
+void FlashLog::rewindPage(uint32_t seq) {
+    readSeq = seq;
+    readLoaded = false;
+    readIndex = 0;
+    readOffset = 0;
+    memset(&readPrev, 0, sizeof(readPrev));
+}
+
+bool FlashLog::loadPage() {
+    if (readSeq == headSeq) {
+        // Página en RAM: se copia en cada lectura porque sigue creciendo
+        memcpy(readPage, writePage, sizeof(LogPageHeader) + writeHeader().used);
+        readLoaded = false;
+        return true;
+    }
+    if (!readLoaded) {
+        LogPageHeader h;
+        if (!readHeader(readSeq, h) || h.used > LOG_PAGE_PAYLOAD ||
+            !device->read(pageOffset(readSeq), readPage, sizeof(LogPageHeader) + h.used)) {
+            return false;
+        }
+        readLoaded = true;
+    }
+    return true;
+}
+
+void FlashLog::seekCursor(uint32_t cursor) {
+    if (device == nullptr) {
+        return;
+    }
+    // El cursor lleva los 24 bits bajos de la secuencia: se reconstruye cerca de headSeq
+    const uint32_t seq = headSeq - (((headSeq << 8) - (cursor & 0xFFFFFF00u)) >> 8);
+    const bool inRange = static_cast<int32_t>(seq - oldestSeq) >= 0 && static_cast<int32_t>(headSeq - seq) >= 0;
+    rewindPage(inRange ? seq : oldestSeq);
+    // Avanzar hasta el registro pedido dentro de la página
+    const uint8_t target = inRange ? static_cast<uint8_t>(cursor & 0xFF) : 0;
+    SensorData record;
+    uint32_t ignored;
+    while (readIndex < target && readSeq == seq && next(record, ignored)) {
+    }
+}
+
+void FlashLog::seekTime(uint64_t timestamp) {
+    if (device == nullptr) {
+        return;
+    }
+    const LogPageHeader& head = writeHeader();
+    const uint32_t last = head.count > 0 ? headSeq : headSeq - 1;
+    if (static_cast<int32_t>(last - oldestSeq) < 0) {
+        rewindPage(headSeq);
+        return;
+    }
+    if (runsOverflow) {
+        // No se conocen todos los tramos: recorrido lineal desde la página más antigua
+        rewindPage(oldestSeq);
+        skipBefore(timestamp, last);
+        return;
+    }
+    // La página en RAM también puede abrir tramo (primer intervalo tras un reinicio)
+    const bool headRun = head.count > 0 && hasLastPage && head.firstTimestamp < lastPageEnd;
+    const uint8_t boundaries = static_cast<uint8_t>(runCount + (headRun ? 1 : 0));
+    uint32_t first = oldestSeq;
+    for (uint8_t r = 0; r <= boundaries; r++) {
+        const uint32_t next = r < runCount ? runStarts[r] : (r < boundaries ? headSeq : last + 1);
+        if (seekInRun(timestamp, first, next - 1)) {
+            return;
+        }
+        first = next;
+    }
+    seekCursor(getNextCursor());  // Ningún tramo llega al timestamp: al final del log
+}
+
+bool FlashLog::seekInRun(uint64_t timestamp, uint32_t first, uint32_t last) {
+    if (static_cast<int32_t>(last - first) < 0) {
+        return false;
+    }
+    LogPageHeader h;
+    if (readHeader(last, h) && h.lastTimestamp < timestamp) {
+        return false;  // El tramo entero es anterior
+    }
+    // Búsqueda binaria de la última página del tramo cuyo primer registro no es posterior
+    uint32_t lo = first;
+    uint32_t hi = last;
+    while (lo != hi) {
+        const uint32_t mid = lo + (hi - lo + 1) / 2;
+        if (readHeader(mid, h) && h.firstTimestamp <= timestamp) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    rewindPage(lo);
+    return skipBefore(timestamp, last);
+}
+
+bool FlashLog::skipBefore(uint64_t timestamp, uint32_t last) {
+    // Saltar los registros anteriores sin consumir el primero que cumple
+    SensorData record;
+    uint32_t ignored;
+    while (true) {
+        const uint32_t seq = readSeq;
+        const uint8_t index = readIndex;
+        const size_t offset = readOffset;
+        const SensorData prev = readPrev;
+        if (!next(record, ignored)) {
+            return true;  // Fin del log: la lectura queda al final
+        }
+        if (readSeq != seq && static_cast<int32_t>(readSeq - last) > 0) {
+            return false;  // El registro ya es del tramo siguiente
+        }
+        if (record.timestamp >= timestamp) {
+            if (readSeq != seq) {
+                rewindPage(readSeq);  // next() cambió de página: el registro es el primero
+            } else {
+                readIndex = index;
+                readOffset = offset;
+                readPrev = prev;
+            }
+            return true;
+        }
+    }
+}
+
+bool FlashLog::next(SensorData& record, uint32_t& cursor) {
+    if (device == nullptr) {
+        return false;
+    }
+    while (true) {
+        if (static_cast<int32_t>(readSeq - oldestSeq) < 0) {
+            rewindPage(oldestSeq);  // La página en lectura se borró al dar la vuelta
+        }
+        if (!loadPage()) {
+            if (readSeq == headSeq) {
+                return false;
+            }
+            rewindPage(readSeq + 1);  // Página ilegible: se salta
+            continue;
+        }
+        const LogPageHeader& h = *reinterpret_cast<const LogPageHeader*>(readPage);
+        if (readIndex < h.count) {
+            const size_t n = logDecodeRecord(readPrev, &readPage[sizeof(LogPageHeader) + readOffset],
+                                             h.used - readOffset, record);
+            if (n != 0) {
+                cursor = makeCursor(readSeq, readIndex);
+                readOffset += n;
+                readIndex++;
+                readPrev = record;
+                return true;
+            }
+        }
+        if (readSeq == headSeq) {
+            return false;
+        }
+        rewindPage(readSeq + 1);
+    }
+}
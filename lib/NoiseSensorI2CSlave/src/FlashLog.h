@@ -0,0 +1,173 @@
+#ifndef NOISE_FLASH_LOG_H
+#define NOISE_FLASH_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "I2CProtocol.h"
+
+// Geometría de la flash SPI: se escribe por páginas y se borra por sectores
+static constexpr size_t LOG_PAGE_BYTES = 256;
+static constexpr size_t LOG_SECTOR_BYTES = 4096;
+static constexpr uint16_t LOG_PAGE_MAGIC = 0x4C4F;      // "OL" (las páginas "NL" de 16 bytes se ignoran)
+
+// Tramos de timestamps crecientes que seekTime() distingue (un reinicio sin sincronizar abre uno)
+#ifndef NOISE_LOG_MAX_RUNS
+#define NOISE_LOG_MAX_RUNS 16
+#endif
+
+// Cabecera de cada página del log (24 bytes). Una página borrada tiene magic 0xFFFF.
+struct LogPageHeader {
+    uint16_t magic;           // LOG_PAGE_MAGIC
+    uint8_t count;            // Registros en la página
+    uint8_t used;             // Bytes de registros tras la cabecera
+    uint32_t sequence;        // Número de página desde el primer arranque (crece siempre)
+    uint64_t firstTimestamp;  // Timestamp del primer registro (búsqueda por tiempo)
+    uint64_t lastTimestamp;   // Timestamp del último registro (detección de tramos)
+};
+
+static constexpr size_t LOG_PAGE_PAYLOAD = LOG_PAGE_BYTES - sizeof(LogPageHeader);
+static constexpr size_t LOG_MAX_RECORD_BYTES = 10 + 1 + 6 * 5 + 3 + 3 + 5;
+
+// Respuesta a CMD_LOG_READ: 0x81 + uint32_t cursor + SensorData, o 0x80 al final del log
+static constexpr uint8_t LOG_END = 0x80;
+static constexpr uint8_t LOG_RECORD = 0x81;
+static constexpr size_t LOG_FRAME_BYTES = 1 + sizeof(uint32_t) + sizeof(SensorData);
+
+/**
+ * Región de flash donde vive el log
+ *
+ * En el ESP32 es una partición de datos (openLogPartition()); en el host puede ser una
+ * flash simulada en RAM con las mismas reglas (escribir solo sobre borrado, borrar por
+ * sectores).
+ */
+class LogFlashDevice {
+public:
+    virtual ~LogFlashDevice() {}
+    virtual uint32_t size() const = 0;
+    virtual bool read(uint32_t offset, void* dst, size_t len) = 0;
+    virtual bool write(uint32_t offset, const void* src, size_t len) = 0;
+    virtual bool eraseSector(uint32_t offset) = 0;
+};
+
+/**
+ * Partición de datos del ESP32 con la etiqueta indicada
+ * @return Dispositivo estático, o nullptr si no existe la partición (o fuera de ESP32)
+ */
+LogFlashDevice* openLogPartition(const char* label);
+
+/**
+ * Codificación de un registro respecto al anterior de la misma página
+ *
+ * timestamp: delta zigzag en varint. Un byte de mapa marca los float que cambiaron,
+ * lowNoiseLevel e intervalMs. Cada float marcado va como XOR con el anterior sin los
+ * bytes nulos de los extremos (Gorilla a nivel de byte): un byte de control con los
+ * bytes nulos por abajo y los significativos, y esos bytes. lowNoiseLevel e intervalMs
+ * marcados y cycles (siempre) van como delta zigzag en varint.
+ * @return Bytes escritos (como mucho LOG_MAX_RECORD_BYTES)
+ */
+size_t logEncodeRecord(const SensorData& prev, const SensorData& record, uint8_t* out);
+
+/**
+ * @return Bytes consumidos, 0 si el registro está truncado o es inválido
+ */
+size_t logDecodeRecord(const SensorData& prev, const uint8_t* in, size_t len, SensorData& record);
+
+/**
+ * Log de registros en flash, circular y de solo añadir
+ *
+ * Los registros se acumulan en una página en RAM y se escriben en flash cuando la página
+ * se llena (o con flush()): una escritura de página por ~10 registros y un borrado de
+ * sector cada 16 páginas. Al entrar en un sector se borra entero y se pierden las
+ * páginas más antiguas. Cada página es autocontenida (su primer registro va respecto a
+ * cero), así que un corte de alimentación solo pierde la página en RAM.
+ *
+ * Lectura: un cursor (secuencia de página << 8 | registro) que avanza con next(); se
+ * posiciona con seekTime() o seekCursor(). La página en RAM también se lee.
+ *
+ * Los timestamps solo crecen dentro de un tramo: sin sincronización cada arranque vuelve a
+ * empezar cerca de 0. Una página abre tramo si su primer registro es anterior al último de
+ * la página previa; begin() los encuentra en las cabeceras y flush() los añade.
+ */
+class FlashLog {
+public:
+    FlashLog();
+
+    /**
+     * Montar el log: recorre las cabeceras de página para encontrar la más nueva
+     * @return false si el dispositivo no tiene al menos dos sectores
+     */
+    bool begin(LogFlashDevice* flashDevice);
+
+    bool isReady() const { return device != nullptr; }
+
+    void append(const SensorData& record);
+
+    // Escribir la página en RAM aunque no esté llena (antes de dormir o apagar)
+    bool flush();
+
+    /**
+     * Posicionar la lectura en el primer registro con timestamp >= timestamp del tramo más
+     * antiguo que llega a ese timestamp (búsqueda binaria dentro de cada tramo). Con más de
+     * NOISE_LOG_MAX_RUNS tramos recorre el log entero.
+     */
+    void seekTime(uint64_t timestamp);
+    void seekCursor(uint32_t cursor);
+    void seekOldest() { seekCursor(makeCursor(oldestSeq, 0)); }
+
+    /**
+     * Siguiente registro desde la posición de lectura
+     * @return false al llegar al final (hay que volver a llamar cuando se añadan registros)
+     */
+    bool next(SensorData& record, uint32_t& cursor);
+
+    uint32_t getOldestCursor() const { return makeCursor(oldestSeq, 0); }
+    uint32_t getNextCursor() const { return makeCursor(headSeq, writeHeader().count); }
+    uint32_t getCapacityBytes() const { return pageCount * LOG_PAGE_BYTES; }
+    uint32_t getPagesWritten() const { return pagesWritten; }
+    uint32_t getRawBytes() const { return rawBytes; }
+    uint32_t getStoredBytes() const { return storedBytes; }
+    uint32_t getWriteErrors() const { return writeErrors; }
+
+private:
+    LogFlashDevice* device;
+    uint32_t pageCount;
+    uint32_t pagesPerSector;
+    uint32_t headSeq;         // Página en RAM (aún no escrita)
+    uint32_t oldestSeq;       // Página más antigua que sigue en flash
+    alignas(8) uint8_t writePage[LOG_PAGE_BYTES];
+    SensorData writePrev;
+
+    alignas(8) uint8_t readPage[LOG_PAGE_BYTES];
+    uint32_t readSeq;
+    bool readLoaded;          // readPage contiene la página readSeq escrita en flash
+    uint8_t readIndex;
+    size_t readOffset;
+    SensorData readPrev;
+
+    uint32_t pagesWritten;    // Desde el arranque
+    uint32_t rawBytes;        // sizeof(SensorData) por registro escrito en flash
+    uint32_t storedBytes;     // Bytes escritos en flash (cabeceras incluidas)
+    uint32_t writeErrors;
+
+    uint32_t runStarts[NOISE_LOG_MAX_RUNS]; // Primera página de cada tramo tras el de oldestSeq
+    uint8_t runCount;
+    bool runsOverflow;        // Más tramos que runStarts hasta el próximo begin(): búsqueda lineal
+    bool hasLastPage;
+    uint64_t lastPageEnd;     // lastTimestamp de la última página escrita
+
+    const LogPageHeader& writeHeader() const { return *reinterpret_cast<const LogPageHeader*>(writePage); }
+    LogPageHeader& writeHeader() { return *reinterpret_cast<LogPageHeader*>(writePage); }
+
+    static uint32_t makeCursor(uint32_t seq, uint8_t index) { return (seq << 8) | index; }
+    uint32_t pageOffset(uint32_t seq) const { return (seq % pageCount) * LOG_PAGE_BYTES; }
+    void startPage();
+    bool readHeader(uint32_t seq, LogPageHeader& header);
+    bool loadPage();
+    void rewindPage(uint32_t seq);
+    void notePage(uint32_t seq, const LogPageHeader& header);
+    void dropRuns();
+    bool seekInRun(uint64_t timestamp, uint32_t first, uint32_t last);
+    bool skipBefore(uint64_t timestamp, uint32_t last);
+};
+
+#endif // NOISE_FLASH_LOG_H
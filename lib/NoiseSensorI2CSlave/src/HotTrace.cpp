@@ -0,0 +1,57 @@
+#include "HotTrace.h"
+
+#if NOISE_TRACE
+TraceRing traceRings[TRACE_CORES];
+
+size_t traceRead(uint8_t core, TraceEvent* out, size_t maxEvents, uint32_t& lost) {
+    lost = 0;
+    if (core >= TRACE_CORES) {
+        return 0;
+    }
+    TraceRing& ring = traceRings[core];
+    const uint32_t head = __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+    if (head - ring.tail > NOISE_TRACE_EVENTS) {
+        // El escritor dio la vuelta: los más antiguos ya no están
+        lost = head - ring.tail - NOISE_TRACE_EVENTS;
+        ring.tail = head - NOISE_TRACE_EVENTS;
+    }
+    size_t n = 0;
+    while (n < maxEvents && ring.tail != head) {
+        out[n++] = ring.events[ring.tail & (NOISE_TRACE_EVENTS - 1)];
+        ring.tail++;
+    }
+    return n;
+}
+
+void traceDump(Print& out) {
+    char line[48];
+    int len = snprintf(line, sizeof(line), "TRACE %lu %u\n",
+                       static_cast<unsigned long>(getCpuFrequencyMhz()), TRACE_CORES);
+    out.write(reinterpret_cast<const uint8_t*>(line), static_cast<size_t>(len));
+
+    uint32_t totalLost = 0;
+    TraceEvent events[16];
+    for (uint8_t core = 0; core < TRACE_CORES; core++) {
+        size_t n;
+        do {
+            uint32_t lost;
+            n = traceRead(core, events, 16, lost);
+            totalLost += lost;
+            for (size_t i = 0; i < n; i++) {
+                len = snprintf(line, sizeof(line), "T %u %u %c %08lx\n", core, events[i].id, events[i].phase,
+                               static_cast<unsigned long>(events[i].cycles));
+                out.write(reinterpret_cast<const uint8_t*>(line), static_cast<size_t>(len));
+            }
+        } while (n > 0);
+    }
+    len = snprintf(line, sizeof(line), "TRACE END %lu\n", static_cast<unsigned long>(totalLost));
+    out.write(reinterpret_cast<const uint8_t*>(line), static_cast<size_t>(len));
+}
+#else
+size_t traceRead(uint8_t, TraceEvent*, size_t, uint32_t& lost) {
+    lost = 0;
+    return 0;
+}
+
+void traceDump(Print&) {}
+#endif
@@ -0,0 +1,121 @@
+#ifndef NOISE_HOT_TRACE_H
+#define NOISE_HOT_TRACE_H
+
+#include <Arduino.h>
+#include "I2CProtocol.h"
+
+// Trazas de la ruta caliente: -DNOISE_TRACE=1 (con 0 las macros no generan código)
+#ifndef NOISE_TRACE
+#define NOISE_TRACE 0
+#endif
+
+// Eventos por núcleo (potencia de 2, 8 bytes cada uno)
+#ifndef NOISE_TRACE_EVENTS
+#define NOISE_TRACE_EVENTS 256
+#endif
+
+static_assert((NOISE_TRACE_EVENTS & (NOISE_TRACE_EVENTS - 1)) == 0, "NOISE_TRACE_EVENTS debe ser potencia de 2");
+
+#if defined(portNUM_PROCESSORS)
+static constexpr uint8_t TRACE_CORES = portNUM_PROCESSORS;
+#else
+static constexpr uint8_t TRACE_CORES = 1;
+#endif
+
+/**
+ * Anillo de eventos de un núcleo
+ *
+ * Cada núcleo escribe solo en su anillo: el hueco se reserva incrementando head sin que
+ * nada del mismo núcleo se intercale (ver traceReserve()), así que una interrupción o una
+ * tarea que traza a la vez no pisa el evento en curso. Al llenarse se sobrescriben los más antiguos. Hay un solo lector
+ * (traceRead(), desde el loop o desde onRequest()); un evento que se escribe mientras se
+ * lee puede salir incompleto.
+ */
+struct TraceRing {
+    TraceEvent events[NOISE_TRACE_EVENTS];
+    uint32_t head;            // Eventos escritos desde el arranque
+    uint32_t tail;            // Eventos consumidos por el lector
+};
+
+extern TraceRing traceRings[TRACE_CORES];
+
+static inline uint8_t traceCore() {
+#if defined(portNUM_PROCESSORS) && portNUM_PROCESSORS > 1
+    return static_cast<uint8_t>(xPortGetCoreID());
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Reservar el siguiente hueco del anillo del núcleo actual
+ *
+ * Como solo escribe ese núcleo, basta con que no se intercale una interrupción:
+ * - RISC-V (ESP32-C3, RV32IMC sin extensión A): __atomic_fetch_add sería una llamada a la
+ *   emulación de libatomic con sección crítica, varias decenas de ciclos. Se enmascaran las
+ *   interrupciones limpiando mstatus.MIE alrededor de lectura, suma y escritura (~6 instrucciones).
+ * - Xtensa (ESP32, ESP32-S3): __atomic_fetch_add es un bucle con S32C1I, sin llamada.
+ */
+static inline uint32_t traceReserve(TraceRing& ring) {
+#if defined(__riscv)
+    uint32_t mstatus;
+    __asm__ volatile("csrrci %0, mstatus, 8" : "=r"(mstatus) : : "memory");
+    const uint32_t slot = ring.head;
+    ring.head = slot + 1;
+    __asm__ volatile("csrs mstatus, %0" : : "r"(mstatus & 8) : "memory");
+    return slot;
+#else
+    return __atomic_fetch_add(&ring.head, 1, __ATOMIC_RELAXED);
+#endif
+}
+
+// Lectura del contador, reserva y tres almacenamientos: del orden de 15 ciclos en el C3 y
+// de 20-30 en ESP32/S3 (estimado por instrucciones; medir con printStats() y NOISE_TRACE=0)
+static inline void traceEvent(uint8_t id, uint8_t phase) {
+    const uint32_t cycles = ESP.getCycleCount();
+    TraceRing& ring = traceRings[traceCore()];
+    const uint32_t slot = traceReserve(ring);
+    TraceEvent& event = ring.events[slot & (NOISE_TRACE_EVENTS - 1)];
+    event.cycles = cycles;
+    event.id = id;
+    event.phase = phase;
+}
+
+// Evento de inicio al construirse y de fin al salir del ámbito
+class TraceScope {
+public:
+    explicit TraceScope(uint8_t id) : id(id) { traceEvent(id, TRACE_PHASE_BEGIN); }
+    ~TraceScope() { traceEvent(id, TRACE_PHASE_END); }
+
+private:
+    uint8_t id;
+};
+
+/**
+ * Leer (y consumir) los eventos pendientes de un núcleo
+ * @param lost Eventos sobrescritos antes de poder leerse
+ * @return Eventos copiados en out
+ */
+size_t traceRead(uint8_t core, TraceEvent* out, size_t maxEvents, uint32_t& lost);
+
+/**
+ * Volcar y consumir todos los eventos pendientes en texto, una línea por evento
+ * ("T <núcleo> <id> <B|E> <ciclos hex>"), entre "TRACE <MHz> <núcleos>" y "TRACE END <perdidos>".
+ * Las líneas de log intercaladas se ignoran al convertir (tools/trace_export).
+ */
+void traceDump(Print& out);
+
+#define NOISE_TRACE_CONCAT2(a, b) a##b
+#define NOISE_TRACE_CONCAT(a, b) NOISE_TRACE_CONCAT2(a, b)
+
+#if NOISE_TRACE
+#define NOISE_TRACE_SCOPE(id) TraceScope NOISE_TRACE_CONCAT(traceScope_, __LINE__)(id)
+#define NOISE_TRACE_BEGIN(id) traceEvent((id), TRACE_PHASE_BEGIN)
+#define NOISE_TRACE_END(id) traceEvent((id), TRACE_PHASE_END)
+#else
+#define NOISE_TRACE_SCOPE(id) do {} while (0)
+#define NOISE_TRACE_BEGIN(id) do {} while (0)
+#define NOISE_TRACE_END(id) do {} while (0)
+#endif
+
+#endif // NOISE_HOT_TRACE_H
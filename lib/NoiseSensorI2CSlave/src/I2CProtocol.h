@@ -0,0 +1,280 @@
+#ifndef NOISE_I2C_PROTOCOL_H
+#define NOISE_I2C_PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Definiciones del protocolo compartidas por el esclavo, los maestros y las herramientas
+// de host: sin dependencias de Arduino.
+
+static constexpr size_t RESPONSE_BUFFER_SIZE = 64;    // Igual al buffer de Wire
+static constexpr uint8_t DEFAULT_I2C_ADDRESS = 0x08; //0x08
+static constexpr uint8_t MIN_I2C_ADDRESS = 0x08;
+static constexpr uint8_t MAX_I2C_ADDRESS = 0x77;
+
+// Estructura de datos del sensor
+struct SensorData {
+    float noise;
+    float noiseAvg;
+    float noisePeak;
+    float noiseMin;
+    float noiseAvgLegal;
+    float noiseAvgLegalMax;
+    uint16_t lowNoiseLevel;
+    uint16_t intervalMs;      // Intervalo de agregación del registro en ms (ocupa el relleno: el tamaño no cambia)
+    uint32_t cycles;
+    uint64_t timestamp;       // Marca de tiempo en µs (reloj del maestro si hay sincronización, esp_timer si no)
+};
+
+// Comandos I2C
+enum I2CCommand {
+    CMD_GET_DATA = 0x01,      // Solicitar todos los datos
+    CMD_GET_AVG = 0x02,       // Solicitar promedio
+    CMD_GET_PEAK = 0x03,      // Solicitar pico
+    CMD_GET_MIN = 0x04,       // Solicitar mínimo
+    CMD_GET_LEGAL = 0x05,     // Solicitar promedio legal
+    CMD_GET_LEGAL_MAX = 0x06, // Solicitar máximo legal
+    CMD_GET_STATUS = 0x07,    // Solicitar estado
+    CMD_RESET = 0x08,         // Resetear ciclo
+    CMD_PING = 0x09,          // Identificación/detección del sensor (alias de CMD_IDENTIFY)
+    CMD_IDENTIFY = 0x09,      // Identificación y detección del sensor
+    CMD_GET_READY = 0x0A,     // Verificar si está listo para enviar datos
+    CMD_LATCH = 0x0B,         // Congelar la ventana actual en el buffer de snapshot
+    CMD_GET_SNAPSHOT = 0x0C,  // Solicitar el último snapshot congelado
+    CMD_TIME_SYNC = 0x0D,     // Escribir el tiempo del maestro (uint64_t µs tras el comando)
+    CMD_GET_TIME = 0x0E,      // Solicitar el estado de sincronización (TimeSyncStatus)
+    CMD_GET_HISTORY = 0x0F,   // Solicitar un registro del histórico (índice uint8_t tras el comando, 0 = más reciente)
+    CMD_GET_DATA_FIXED = 0x10,// Solicitar datos en punto fijo (SensorDataFixed, requiere NOISE_FIXED_POINT)
+    CMD_GET_HEAP = 0x11,      // Solicitar el informe de heap (HeapReport)
+    CMD_GET_STATS = 0x12,     // Solicitar los contadores de rendimiento (PerfStatsReport)
+    CMD_GET_JITTER = 0x13,    // Solicitar el histograma de retraso de los intervalos (JitterHistogram)
+    CMD_CAPTURE_START = 0x14, // Grabar muestras crudas del ADC (uint16_t ms tras el comando)
+    CMD_GET_CAPTURE_STATUS = 0x15, // Solicitar el estado de la captura (CaptureStatus)
+    CMD_GET_CAPTURE_CHUNK = 0x16,  // Solicitar un bloque de la captura (uint32_t offset opcional; sin él, el siguiente)
+    CMD_GET_DELTA = 0x17,     // Solicitar solo los campos que cambiaron (uint8_t sesión opcional, bit 7 = resincronizar; uint8_t secuencia confirmada)
+    CMD_GET_WINDOWS = 0x18,   // Solicitar máximo y mínimo de las ventanas deslizantes (WindowExtremes)
+    CMD_GET_WEIGHTED = 0x19,  // Solicitar niveles Fast/Slow/Impulse y sus máximos (TimeWeightedLevels, requiere NOISE_FIXED_POINT)
+    CMD_LOG_SEEK = 0x1A,      // Posicionar la lectura del log en flash (uint64_t timestamp, uint32_t cursor o nada = más antiguo)
+    CMD_LOG_READ = 0x1B,      // Leer el siguiente registro del log en flash y avanzar
+    CMD_GET_LOG_STATUS = 0x1C,// Solicitar el estado del log en flash (LogStatus)
+    CMD_HUB_MAP = 0x1D,       // Solicitar un bloque del mapa agregado del hub (uint16_t offset opcional; 0 congela el mapa)
+    CMD_HUB_HISTORY = 0x1E,   // Solicitar un registro del histórico de una hoja (uint8_t hoja, uint8_t índice)
+    CMD_TRACE_READ = 0x1F,    // Leer y consumir eventos de traza (TraceChunkHeader + TraceEvent[], requiere NOISE_TRACE)
+    CMD_SUBSCRIBE = 0x20,     // Suscribir etapas costosas (uint32_t máscara SUB_*; sin argumento = solo inferidas)
+    CMD_GET_SUBSCRIPTION = 0x21,// Solicitar el estado de las suscripciones (SubscriptionStatus)
+    CMD_GET_BUS_HEALTH = 0x22,// Solicitar el estado de la supervisión del bus (BusHealth)
+    CMD_GET_STREAM_STATS = 0x23 // Solicitar los contadores del transporte serie (StreamStats, requiere NOISE_STREAM)
+};
+
+// Datos del intervalo calculados en punto fijo (mV enteros y centi-dB)
+struct SensorDataFixed {
+    int32_t noiseMv;          // Última muestra en mV
+    int32_t noiseAvgMv;       // Media del intervalo en mV
+    int32_t noisePeakMv;      // Pico del intervalo en mV
+    int32_t noiseMinMv;       // Mínimo del intervalo en mV
+    int32_t leqCentiDb;       // Leq del intervalo en centésimas de dB re 1 mV
+    uint32_t samples;         // Muestras acumuladas en el intervalo
+    uint64_t timestamp;       // Marca de tiempo en µs (igual que SensorData)
+};
+
+// Niveles con ponderación temporal del intervalo (Fast 125 ms, Slow 1 s, Impulse 35 ms / 1.5 s)
+struct TimeWeightedLevels {
+    int32_t fastCentiDb;      // Nivel Fast al cerrar el intervalo en centi-dB re 1 mV
+    int32_t slowCentiDb;      // Nivel Slow al cerrar el intervalo
+    int32_t impulseCentiDb;   // Nivel Impulse al cerrar el intervalo
+    int32_t fastMaxCentiDb;   // Máximo Fast del intervalo (LFmax)
+    int32_t slowMaxCentiDb;   // Máximo Slow del intervalo (LSmax)
+    int32_t impulseMaxCentiDb;// Máximo Impulse del intervalo (LImax)
+    uint32_t sampleRateHz;    // Tasa para la que se calcularon los coeficientes
+    uint64_t timestamp;       // Marca de tiempo en µs (igual que SensorData)
+};
+
+// Estado del log en flash (respuesta a CMD_GET_LOG_STATUS, requiere NOISE_FLASH_LOG)
+struct LogStatus {
+    uint32_t oldestCursor;    // Cursor del registro más antiguo en flash
+    uint32_t nextCursor;      // Cursor que tendrá el próximo registro
+    uint32_t capacityBytes;   // Tamaño de la partición
+    uint32_t pagesWritten;    // Páginas escritas desde el arranque
+    uint32_t rawBytes;        // Bytes de SensorData de los registros escritos desde el arranque
+    uint32_t storedBytes;     // Bytes escritos en flash desde el arranque (compresión = raw / stored)
+    uint32_t writeErrors;     // Escrituras o borrados fallidos
+    uint32_t maxWriteUs;      // Escritura de página más lenta (incluye el borrado de sector)
+    uint32_t throughputBps;   // Bytes escritos por segundo de escritura sostenida
+};
+
+// Mapa agregado del modo hub (CMD_HUB_MAP): HubMapHeader seguido de una HubEntry por hoja
+static constexpr uint8_t HUB_ENTRY_VALID = 0x01;   // La hoja respondió alguna vez (data es válido)
+static constexpr uint8_t HUB_ENTRY_ONLINE = 0x02;  // El último sondeo tuvo éxito
+static constexpr uint8_t HUB_ENTRY_STALE = 0x04;   // Sin datos nuevos desde hace más de staleAfterMs
+
+struct HubMapHeader {
+    uint8_t leafCount;        // Entradas que siguen
+    uint8_t onlineCount;      // Hojas con el último sondeo correcto
+    uint16_t entryBytes;      // sizeof(HubEntry)
+    uint32_t sweeps;          // Barridos completos del bus de hojas desde el arranque
+};
+
+struct HubEntry {
+    uint8_t address;          // Dirección I2C de la hoja en el bus del hub
+    uint8_t flags;            // HUB_ENTRY_*
+    uint16_t ageMs;           // Antigüedad del dato al congelar el mapa (saturada a 65535)
+    uint32_t records;         // Registros distintos recibidos de la hoja
+    SensorData data;          // Último registro de la hoja
+};
+
+// Cabecera de cada bloque de CMD_HUB_MAP
+struct HubChunkHeader {
+    uint16_t offset;          // Posición del bloque en el mapa
+    uint8_t length;           // Bytes de mapa que siguen
+    uint8_t flags;            // Bit 0 = último bloque
+};
+
+static constexpr size_t HUB_CHUNK_PAYLOAD = RESPONSE_BUFFER_SIZE - sizeof(HubChunkHeader);
+
+// Trazas de la ruta caliente (NOISE_TRACE): eventos de inicio/fin con el contador de ciclos
+enum TraceEventId : uint8_t {
+    TRACE_UPDATE = 0,         // update() completo
+    TRACE_AGGREGATION,        // Cierre de intervalo (registro, histórico, log)
+    TRACE_CHECK_ADC,          // Una lectura de la verificación de señal del ADC (stepADCCheck)
+    TRACE_DRAIN_ADC,          // Vaciado del ADC continuo y cadena de bloques
+    TRACE_ON_RECEIVE,         // Callback onReceive()
+    TRACE_ON_REQUEST,         // Callback onRequest()
+    TRACE_LOG_APPEND,         // Registro añadido al log en flash (incluye la escritura de página)
+    TRACE_HUB_POLL,           // Sondeo de una hoja del hub
+    TRACE_BUS_RECOVERY,       // Reinicio de Wire por cuelgue del bus
+    TRACE_EVENT_COUNT,
+    TRACE_USER_FIRST = 32     // Identificadores libres para el código de la aplicación
+};
+
+static const char* const TRACE_EVENT_NAMES[TRACE_EVENT_COUNT] = {
+    "update", "aggregation", "adcCheck", "drainAdcStream",
+    "onReceive", "onRequest", "logAppend", "hubPoll",
+    "busRecovery"
+};
+
+static constexpr uint8_t TRACE_PHASE_BEGIN = 'B';
+static constexpr uint8_t TRACE_PHASE_END = 'E';
+
+struct TraceEvent {
+    uint32_t cycles;          // Contador de ciclos del núcleo (se desborda: ~27 s a 160 MHz)
+    uint8_t id;               // TraceEventId o TRACE_USER_FIRST + n
+    uint8_t phase;            // TRACE_PHASE_BEGIN / TRACE_PHASE_END
+    uint16_t reserved;
+};
+
+// Cabecera de cada respuesta a CMD_TRACE_READ, seguida de count eventos de un núcleo
+struct TraceChunkHeader {
+    uint8_t core;             // Núcleo de los eventos
+    uint8_t count;            // Eventos que siguen (0 = no hay más)
+    uint16_t lost;            // Eventos sobrescritos antes de leerse (desde la lectura anterior, saturado)
+    uint16_t cpuMhz;          // Frecuencia del contador de ciclos
+    uint16_t reserved;
+};
+
+static constexpr size_t TRACE_CHUNK_EVENTS = (RESPONSE_BUFFER_SIZE - sizeof(TraceChunkHeader)) / sizeof(TraceEvent);
+
+// Etapas costosas que solo se calculan mientras hay suscripción (con Config::lazyStages)
+static constexpr uint32_t SUB_WINDOWS = 0x00000001;   // Extremos de CMD_GET_WINDOWS publicados en cada update()
+static constexpr uint32_t SUB_WEIGHTED = 0x00000002;  // Detectores Fast/Slow/Impulse de CMD_GET_WEIGHTED
+static constexpr uint32_t SUB_USER_FIRST = 0x00000100; // Bits 8..31: etapas de la aplicación (BlockStage::subscription)
+
+// Estado de las suscripciones (respuesta a CMD_GET_SUBSCRIPTION)
+struct SubscriptionStatus {
+    uint32_t requested;       // Máscara escrita con CMD_SUBSCRIBE
+    uint32_t inferred;        // Etapas cuyos comandos se leyeron hace menos de subscriptionHoldMs
+    uint32_t active;          // Etapas en marcha (todas sin lazyStages)
+    uint32_t skipped;         // Ejecuciones de etapas evitadas desde el arranque
+};
+
+// Supervisión del bus I2C del esclavo (Config::busHangMs)
+enum BusHangCause : uint8_t {
+    BUS_HANG_NONE = 0,
+    BUS_HANG_LINE_LOW,        // SDA o SCL en bajo más de busHangMs
+    BUS_HANG_CALLBACK,        // onRequest()/onReceive() sin terminar tras busHangMs
+    BUS_HANG_SILENT           // Sin callbacks durante busSilenceMs con un maestro que sondeaba
+};
+
+enum BusState : uint8_t {
+    BUS_OK = 0,
+    BUS_RECOVERING            // Wire reiniciado, esperando bus en reposo o un callback
+};
+
+// Estado de la supervisión del bus (respuesta a CMD_GET_BUS_HEALTH)
+struct BusHealth {
+    uint32_t recoveries;      // Reinicios de Wire en modo esclavo
+    uint32_t lineHangs;       // Detecciones por línea en bajo
+    uint32_t callbackHangs;   // Detecciones por callback sin terminar
+    uint32_t silentHangs;     // Detecciones por silencio del maestro
+    uint32_t failedRecoveries;// Reinicios tras los que el bus seguía colgado (se repiten)
+    uint32_t lastRecoverUs;   // Del inicio del último cuelgue al bus recuperado
+    uint32_t maxRecoverUs;
+    uint32_t lastReinitUs;    // Duración del último Wire.end() + Wire.begin()
+    uint8_t state;            // BusState
+    uint8_t lastCause;        // BusHangCause del último cuelgue
+    uint8_t lines;            // Último muestreo: bit 0 = SDA alta, bit 1 = SCL alta
+    uint8_t reserved;
+};
+
+// Contadores del transporte serie binario (respuesta a CMD_GET_STREAM_STATS)
+struct StreamStats {
+    uint32_t framesIn;        // Peticiones válidas recibidas
+    uint32_t framesOut;       // Tramas enviadas (respuestas y registros)
+    uint32_t records;         // Intervalos empujados sin petición
+    uint32_t bytesOut;        // Bytes enviados por la línea (COBS y delimitadores incluidos)
+    uint32_t crcErrors;       // Tramas recibidas con COBS o CRC inválidos
+    uint32_t overruns;        // Tramas recibidas más largas que el buffer (descartadas)
+    uint32_t dropped;         // Tramas no enviadas por falta de sitio en el buffer del driver
+};
+
+// Snapshot congelado por CMD_LATCH o por la línea de latch compartida
+struct SensorSnapshot {
+    SensorData data;          // Medidas en el instante del latch
+    uint32_t sequence;        // Número de latch (se incrementa en cada snapshot)
+    uint32_t latchDelayUs;    // Retardo entre la petición de latch y la copia de la ventana
+};
+
+// Estado de sincronización de tiempo (respuesta a CMD_GET_TIME)
+struct TimeSyncStatus {
+    uint64_t now;             // Tiempo sincronizado actual en µs
+    int64_t offsetUs;         // Offset del último ancla (maestro - local)
+    int32_t driftPpb;         // Deriva estimada del reloj local en ppb
+    uint32_t syncCount;       // Número de sincronizaciones recibidas
+};
+
+// Informe de heap (respuesta a CMD_GET_HEAP): tras begin() la librería no reserva memoria
+struct HeapReport {
+    uint32_t freeAtBegin;        // Heap libre al terminar begin()
+    uint32_t freeNow;            // Heap libre actual
+    uint32_t minFreeSinceBegin;  // Mínimo observado desde begin() (muestreado cada intervalo)
+    uint32_t largestFreeBlock;   // Mayor bloque libre (fragmentación)
+};
+
+// Extremos del nivel en ventanas deslizantes (respuesta a CMD_GET_WINDOWS), por defecto 1 s, 10 s y 60 s.
+// No dependen de los ciclos ni de CMD_RESET; leerlos no modifica nada.
+static constexpr uint8_t SLIDING_WINDOW_COUNT = 3;
+
+// WindowExtremes::flags: extremos de la última agregación (etapa sin suscripción), con hasta un
+// intervalo de retraso. La lectura ya activó la etapa: la siguiente trae los del momento.
+static constexpr uint32_t WINDOWS_STALE = 0x01;
+
+struct WindowExtremes {
+    float maxMv[SLIDING_WINDOW_COUNT];    // Máximo de cada ventana en mV
+    float minMv[SLIDING_WINDOW_COUNT];    // Mínimo de cada ventana en mV
+    uint32_t spanMs[SLIDING_WINDOW_COUNT];// Tiempo cubierto por cada ventana (0 = sin datos)
+    uint32_t flags;                       // WINDOWS_STALE (ocupa el relleno: el tamaño no cambia)
+    uint64_t timestamp;                   // Marca de tiempo de la última muestra en µs
+};
+
+// Estructura de identificación del sensor
+struct SensorIdentity {
+    uint8_t sensorType;       // Tipo de sensor (0x01 = Noise Sensor)
+    uint8_t versionMajor;     // Versión mayor
+    uint8_t versionMinor;     // Versión menor
+    uint8_t status;           // Estado: bit 0 = inicializado, bit 1 = ADC activo, bit 2 = datos listos, bit 3 = snapshot listo, bit 4 = tiempo sincronizado, bit 5 = arrancando, bit 6 = ruta de punto fijo
+    uint8_t i2cAddress;       // Dirección I2C del sensor
+} __attribute__((packed));
+
+// Número de entradas de la tabla de despacho (último comando + 1)
+static constexpr uint8_t COMMAND_TABLE_SIZE = CMD_GET_STREAM_STATS + 1;
+
+#endif // NOISE_I2C_PROTOCOL_H
@@ -0,0 +1,159 @@
+#ifndef NOISE_LEVEL_STATS_H
+#define NOISE_LEVEL_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "FixedPoint.h"
+#include "BlockKernels.h"
+
+/**
+ * Estadísticas de nivel de un intervalo en aritmética entera
+ *
+ * Acumula muestras en mV: media, pico, mínimo y suma de energía (cuadrados) para el Leq.
+ * Los acumuladores son de 64 bits: con muestras de 12 bits no desbordan en la vida del equipo.
+ * reset() conserva la última muestra: sigue siendo el nivel actual hasta que llegue otra.
+ */
+class LevelStats {
+public:
+    LevelStats() : last(0) { reset(); }
+
+    void reset() {
+        count = 0;
+        sum = 0;
+        energy = 0;
+        minValue = INT32_MAX;
+        maxValue = INT32_MIN;
+    }
+
+    void add(int32_t value) {
+        count++;
+        sum += value;
+        energy += static_cast<uint64_t>(static_cast<int64_t>(value) * value);
+        if (value < minValue) minValue = value;
+        if (value > maxValue) maxValue = value;
+        last = value;
+    }
+
+    // Bloque de muestras con los kernels de BlockKernels.h (vectoriales en ESP32-S3)
+    void addBlock(const int16_t* in, size_t n) {
+        if (n == 0) return;
+        BlockSums block;
+        blockStats(in, n, block);
+        addSums(block, n, in[n - 1]);
+    }
+
+    // Reducción de un bloque ya calculada (varios acumuladores comparten un blockStats())
+    void addSums(const BlockSums& block, size_t n, int32_t lastValue) {
+        if (n == 0) return;
+        count += static_cast<uint32_t>(n);
+        sum += block.sum;
+        energy += block.sumSq;
+        if (block.minValue < minValue) minValue = block.minValue;
+        if (block.maxValue > maxValue) maxValue = block.maxValue;
+        last = lastValue;
+    }
+
+    uint32_t getCount() const { return count; }
+    int32_t getLast() const { return last; }
+    int32_t getMin() const { return count ? minValue : 0; }
+    int32_t getMax() const { return count ? maxValue : 0; }
+    uint64_t getEnergy() const { return energy; }
+
+    // Media redondeada al entero más próximo
+    int32_t getMean() const {
+        if (count == 0) return 0;
+        const int64_t half = (sum >= 0) ? count / 2 : -static_cast<int64_t>(count / 2);
+        return static_cast<int32_t>((sum + half) / static_cast<int64_t>(count));
+    }
+
+    uint64_t getMeanSquare() const { return count ? energy / count : 0; }
+
+    // Potencia sin la componente continua: (energía - suma²/n) / n en mV², exacta salvo el
+    // truncado final. Con sum = q·n + r (0 <= r < n) se evita suma² (desborda 64 bits) y el
+    // redondeo de la media, que con la DC del micrófono (~1250 mV) costaría ~1250 mV².
+    uint64_t getVariance() const {
+        if (count == 0) return 0;
+        const int64_t n = count;
+        int64_t q = sum / n;
+        int64_t r = sum % n;
+        if (r < 0) {
+            q--;
+            r += n;
+        }
+        const int64_t spread = static_cast<int64_t>(energy) - q * q * n - 2 * q * r -
+                               static_cast<int64_t>(static_cast<uint64_t>(r) * static_cast<uint64_t>(r) / count);
+        return spread > 0 ? static_cast<uint64_t>(spread) / count : 0;
+    }
+
+    // Valor eficaz del intervalo en mV
+    uint32_t getRms() const { return fixedSqrt64(getMeanSquare()); }
+
+    // Leq del intervalo en centi-dB re 1 mV: 10 * log10(media de cuadrados)
+    int32_t getLeqCentiDb() const { return count ? fixedPowerToCentiDb(getMeanSquare()) : 0; }
+
+private:
+    uint32_t count;
+    int64_t sum;
+    uint64_t energy;
+    int32_t minValue;
+    int32_t maxValue;
+    int32_t last;
+};
+
+/**
+ * Ciclo de medida de la ruta de punto fijo, con los campos de ciclo de NoiseSensor
+ *
+ * Acumula las muestras del ciclo en curso (media, pico, mínimo y valor eficaz, que es el
+ * promedio legal) y, de los ciclos cerrados, el mayor y el menor promedio legal y cuántos
+ * hay. El esclavo cierra el ciclo al cumplirse su duración, igual que llama a
+ * NoiseSensor::resetCycle() con isCycleComplete(); restart() (CMD_RESET) lo empieza de
+ * nuevo sin contarlo.
+ */
+class LevelCycle {
+public:
+    LevelCycle() : cycles(0), legalMax(0), legalMin(UINT32_MAX), startMs(0) {}
+
+    void restart(uint32_t nowMs) {
+        samples.reset();
+        startMs = nowMs;
+    }
+
+    void close(uint32_t nowMs) {
+        if (samples.getCount() > 0) {
+            const uint32_t rms = samples.getRms();
+            if (rms > legalMax) legalMax = rms;
+            if (rms < legalMin) legalMin = rms;
+        }
+        cycles++;
+        restart(nowMs);
+    }
+
+    void addSums(const BlockSums& block, size_t n, int32_t lastValue) { samples.addSums(block, n, lastValue); }
+
+    const LevelStats& getSamples() const { return samples; }
+    uint32_t getStartMs() const { return startMs; }
+    uint32_t getCycles() const { return cycles; }
+
+    // Promedio legal: valor eficaz de las muestras del ciclo en curso
+    uint32_t getLegal() const { return samples.getRms(); }
+
+    uint32_t getLegalMax() const {
+        const uint32_t rms = samples.getCount() ? samples.getRms() : 0;
+        return rms > legalMax ? rms : legalMax;
+    }
+
+    uint32_t getLegalMin() const {
+        const uint32_t rms = samples.getCount() ? samples.getRms() : UINT32_MAX;
+        const uint32_t low = rms < legalMin ? rms : legalMin;
+        return low == UINT32_MAX ? 0 : low;
+    }
+
+private:
+    LevelStats samples;
+    uint32_t cycles;
+    uint32_t legalMax;
+    uint32_t legalMin;
+    uint32_t startMs;
+};
+
+#endif // NOISE_LEVEL_STATS_H
@@ -0,0 +1,160 @@
+#include "NoiseSensorHub.h"
+#include <cstring>
+
+NoiseSensorHub::NoiseSensorHub(const Config& config)
+    : config(config), bus(nullptr), nextLeaf(0), sweeps(0) {
+    memset(leaves, 0, sizeof(leaves));
+    memset(map, 0, sizeof(map));
+}
+
+bool NoiseSensorHub::begin(TwoWire& wire) {
+    if (config.leafCount == 0 || config.leafCount > NOISE_HUB_MAX_LEAVES || config.pollIntervalMs == 0) {
+        return false;
+    }
+    for (uint8_t i = 0; i < config.leafCount; i++) {
+        if (config.leafAddresses[i] < MIN_I2C_ADDRESS || config.leafAddresses[i] > MAX_I2C_ADDRESS) {
+            return false;
+        }
+    }
+    // Firma Arduino-ESP32 en modo maestro: begin(int sda, int scl, uint32_t frequency)
+    if (!wire.begin(config.sdaPin, config.sclPin, config.frequency)) {
+        return false;
+    }
+    wire.setTimeOut(config.busTimeoutMs);
+    bus = &wire;
+
+    // Un plazo por hoja: el barrido completo dura pollIntervalMs
+    const uint32_t slotUs = config.pollIntervalMs * 1000UL / config.leafCount;
+    scheduler.start(static_cast<int64_t>(micros()), slotUs > 0 ? slotUs : 1);
+    return true;
+}
+
+void NoiseSensorHub::update(int64_t nowUs) {
+    if (bus == nullptr || !scheduler.poll(nowUs)) {
+        return;
+    }
+    NOISE_TRACE_SCOPE(TRACE_HUB_POLL);
+    pollLeaf(nextLeaf, static_cast<uint32_t>(nowUs / 1000));
+    if (++nextLeaf >= config.leafCount) {
+        nextLeaf = 0;
+        sweeps++;
+    }
+}
+
+bool NoiseSensorHub::pollLeaf(uint8_t index, uint32_t nowMs) {
+    Leaf& leaf = leaves[index];
+    const uint8_t address = config.leafAddresses[index];
+
+    // Mismo patrón que los maestros de ejemplo: comando, STOP, pausa corta y lectura
+    bool ok = false;
+    SensorData data;
+    bus->beginTransmission(address);
+    bus->write(static_cast<uint8_t>(CMD_GET_DATA));
+    if (bus->endTransmission() == 0) {
+        delayMicroseconds(200);
+        const size_t received = bus->requestFrom(address, sizeof(SensorData));
+        if (received >= sizeof(SensorData)) {
+            bus->readBytes(reinterpret_cast<uint8_t*>(&data), sizeof(data));
+            ok = true;
+        }
+        while (bus->available()) {
+            bus->read();
+        }
+    }
+
+    if (!ok) {
+        leaf.flags = static_cast<uint8_t>(leaf.flags & ~HUB_ENTRY_ONLINE);
+        return false;
+    }
+
+    const SensorData& current = leaf.slots[leaf.active];
+    const bool isNew = !(leaf.flags & HUB_ENTRY_VALID) || data.timestamp != current.timestamp;
+    if (isNew) {
+        // Escribir la copia inactiva y publicarla cambiando el índice
+        const uint8_t next = leaf.active ^ 1;
+        leaf.slots[next] = data;
+        leaf.active = next;
+        leaf.updatedMs = nowMs;
+        leaf.records = leaf.records + 1;
+
+        leaf.history[leaf.historyHead] = data;
+        leaf.historyHead = static_cast<uint8_t>((leaf.historyHead + 1) % NOISE_HUB_HISTORY);
+        if (leaf.historyCount < NOISE_HUB_HISTORY) {
+            leaf.historyCount++;
+        }
+    }
+    leaf.flags = HUB_ENTRY_VALID | HUB_ENTRY_ONLINE;
+    return true;
+}
+
+bool NoiseSensorHub::getEntry(uint8_t index, HubEntry& out, int64_t nowUs) const {
+    if (index >= config.leafCount) {
+        return false;
+    }
+    const Leaf& leaf = leaves[index];
+    const uint32_t nowMs = static_cast<uint32_t>(nowUs / 1000);
+    const uint8_t flags = leaf.flags;
+    const uint32_t age = nowMs - leaf.updatedMs;
+
+    out.address = config.leafAddresses[index];
+    out.flags = flags;
+    out.ageMs = static_cast<uint16_t>(age > 65535 ? 65535 : age);
+    out.records = leaf.records;
+    out.data = leaf.slots[leaf.active];
+    if (!(flags & HUB_ENTRY_VALID) || age > config.staleAfterMs) {
+        out.flags |= HUB_ENTRY_STALE;
+    }
+    if (!(flags & HUB_ENTRY_VALID)) {
+        out.ageMs = 65535;
+    }
+    return true;
+}
+
+bool NoiseSensorHub::getHistory(uint8_t index, uint8_t historyIndex, SensorData& out) const {
+    if (index >= config.leafCount || historyIndex >= leaves[index].historyCount) {
+        return false;
+    }
+    const Leaf& leaf = leaves[index];
+    const uint8_t pos = static_cast<uint8_t>((leaf.historyHead + NOISE_HUB_HISTORY - 1 - historyIndex) % NOISE_HUB_HISTORY);
+    out = leaf.history[pos];
+    return true;
+}
+
+void NoiseSensorHub::freezeMap(uint32_t nowMs) {
+    HubMapHeader header;
+    header.leafCount = config.leafCount;
+    header.onlineCount = 0;
+    header.entryBytes = sizeof(HubEntry);
+    header.sweeps = sweeps;
+
+    HubEntry* entries = reinterpret_cast<HubEntry*>(&map[sizeof(HubMapHeader)]);
+    for (uint8_t i = 0; i < config.leafCount; i++) {
+        HubEntry entry;
+        getEntry(i, entry, static_cast<int64_t>(nowMs) * 1000);
+        if (entry.flags & HUB_ENTRY_ONLINE) {
+            header.onlineCount++;
+        }
+        memcpy(&entries[i], &entry, sizeof(entry));
+    }
+    memcpy(map, &header, sizeof(header));
+}
+
+size_t NoiseSensorHub::readMapChunk(uint16_t offset, uint8_t* out, int64_t nowUs) {
+    const uint16_t total = getMapBytes();
+    if (offset >= total) {
+        return 0;
+    }
+    if (offset == 0) {
+        freezeMap(static_cast<uint32_t>(nowUs / 1000));
+    }
+    const size_t remaining = total - offset;
+    const size_t length = remaining < HUB_CHUNK_PAYLOAD ? remaining : HUB_CHUNK_PAYLOAD;
+
+    HubChunkHeader header;
+    header.offset = offset;
+    header.length = static_cast<uint8_t>(length);
+    header.flags = (offset + length >= total) ? 0x01 : 0x00;
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + sizeof(header), &map[offset], length);
+    return sizeof(header) + length;
+}
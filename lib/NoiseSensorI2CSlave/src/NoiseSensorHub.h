@@ -0,0 +1,123 @@
+#ifndef NOISE_SENSOR_HUB_H
+#define NOISE_SENSOR_HUB_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "I2CProtocol.h"
+#include "DeadlineScheduler.h"
+#include "HotTrace.h"
+
+// Hojas que puede sondear un hub (cada una ocupa ~48 bytes en el mapa y 2 registros de caché)
+#ifndef NOISE_HUB_MAX_LEAVES
+#define NOISE_HUB_MAX_LEAVES 20
+#endif
+
+// Registros del histórico guardados por hoja
+#ifndef NOISE_HUB_HISTORY
+#define NOISE_HUB_HISTORY 4
+#endif
+
+static_assert(NOISE_HUB_MAX_LEAVES > 0 && NOISE_HUB_MAX_LEAVES <= 255, "NOISE_HUB_MAX_LEAVES debe estar entre 1 y 255");
+static_assert(NOISE_HUB_HISTORY > 0 && NOISE_HUB_HISTORY <= 255, "NOISE_HUB_HISTORY debe estar entre 1 y 255");
+
+static constexpr size_t HUB_MAP_BYTES = sizeof(HubMapHeader) + NOISE_HUB_MAX_LEAVES * sizeof(HubEntry);
+static_assert(HUB_MAP_BYTES <= 65535, "El mapa del hub no cabe en un offset de 16 bits");
+
+/**
+ * Hub: maestro con caché de las hojas en el segundo controlador I2C
+ *
+ * En una topología en árbol, el hub corre NoiseSensorI2CSlave hacia el maestro central
+ * (Wire) y sondea sus hojas en otro bus (Wire1 por defecto) con CMD_GET_DATA. Guarda el
+ * último registro y un histórico corto de cada una. El maestro central lee todas las hojas
+ * como un único mapa de registros (CMD_HUB_MAP) en bloques consecutivos.
+ *
+ * update() sondea como mucho una hoja por llamada, repartidas a lo largo de
+ * pollIntervalMs. Cada hoja tiene dos copias del registro: el sondeo escribe la inactiva y
+ * luego cambia el índice, así que onRequest() nunca espera al bus de hojas ni lee un
+ * registro a medio escribir. Al pedir el offset 0 el mapa se congela entero: los bloques
+ * siguientes son coherentes entre sí aunque lleguen sondeos entre medias.
+ *
+ * Requiere un chip con dos controladores I2C (ESP32, ESP32-S2, ESP32-S3; no ESP32-C3).
+ */
+class NoiseSensorHub {
+public:
+    struct Config {
+        uint8_t sdaPin = 6;                            // SDA del bus de hojas
+        uint8_t sclPin = 7;                            // SCL del bus de hojas
+        uint32_t frequency = 400000;                   // Reloj del bus de hojas
+        uint8_t leafAddresses[NOISE_HUB_MAX_LEAVES] = {}; // Direcciones de las hojas
+        uint8_t leafCount = 0;                         // Hojas en leafAddresses
+        uint32_t pollIntervalMs = 1000;                // Barrido completo de todas las hojas
+        uint32_t staleAfterMs = 5000;                  // Antigüedad a partir de la cual una entrada se marca STALE
+        uint16_t busTimeoutMs = 10;                    // Límite de una transacción con una hoja colgada
+    };
+
+    explicit NoiseSensorHub(const Config& config);
+
+    /**
+     * Iniciar el bus de hojas como maestro
+     * @param bus Controlador I2C distinto del del esclavo
+     * @return false si la configuración no es válida o el bus no arranca
+     */
+#if !defined(SOC_I2C_NUM) || SOC_I2C_NUM > 1
+    bool begin(TwoWire& bus = Wire1);
+#else
+    bool begin(TwoWire& bus);
+#endif
+
+    /**
+     * Sondear la siguiente hoja si ha vencido su plazo (llamar desde loop)
+     * @param nowUs Tiempo local en µs
+     */
+    void update(int64_t nowUs);
+
+    /**
+     * Escribir un bloque del mapa agregado (HubChunkHeader + hasta HUB_CHUNK_PAYLOAD bytes)
+     * @param offset Posición en el mapa; 0 congela el mapa con las antigüedades actuales
+     * @param out Buffer de al menos RESPONSE_BUFFER_SIZE bytes
+     * @param nowUs Tiempo local en µs
+     * @return Bytes escritos (0 si el offset está fuera del mapa)
+     */
+    size_t readMapChunk(uint16_t offset, uint8_t* out, int64_t nowUs);
+
+    /**
+     * Obtener la entrada actual de una hoja
+     * @return false si el índice no existe
+     */
+    bool getEntry(uint8_t leaf, HubEntry& out, int64_t nowUs) const;
+
+    /**
+     * Obtener un registro del histórico de una hoja (0 = más reciente)
+     * @return false si no existe
+     */
+    bool getHistory(uint8_t leaf, uint8_t index, SensorData& out) const;
+
+    uint8_t getLeafCount() const { return config.leafCount; }
+    uint16_t getMapBytes() const { return static_cast<uint16_t>(sizeof(HubMapHeader) + config.leafCount * sizeof(HubEntry)); }
+    uint32_t getSweeps() const { return sweeps; }
+
+private:
+    struct Leaf {
+        SensorData slots[2];               // Doble buffer: el sondeo escribe el inactivo
+        volatile uint8_t active;
+        volatile uint8_t flags;            // HUB_ENTRY_VALID / HUB_ENTRY_ONLINE
+        volatile uint32_t updatedMs;       // Último registro nuevo (32 bits: lectura atómica)
+        volatile uint32_t records;
+        SensorData history[NOISE_HUB_HISTORY];
+        uint8_t historyHead;
+        uint8_t historyCount;
+    };
+
+    Config config;
+    TwoWire* bus;
+    DeadlineScheduler scheduler;
+    Leaf leaves[NOISE_HUB_MAX_LEAVES];
+    uint8_t nextLeaf;
+    uint32_t sweeps;
+    uint8_t map[HUB_MAP_BYTES];            // Mapa congelado por el bloque de offset 0
+
+    bool pollLeaf(uint8_t index, uint32_t nowMs);
+    void freezeMap(uint32_t nowMs);
+};
+
+#endif // NOISE_SENSOR_HUB_H
@@ -1,29 +1,143 @@
 #include "NoiseSensorI2CSlave.h"
 #include <cstring>
+#include <cstdarg>
+#include <cstdio>
+#include <cmath>
 #if defined(ARDUINO_ARCH_ESP32)
 #include "soc/soc_caps.h"
+#include "esp_timer.h"
 #endif
 
 // Instancia estática para los callbacks
 NoiseSensorI2CSlave* NoiseSensorI2CSlave::instance = nullptr;
 
+// Buffer de logging estático: Print::printf() reserva heap con líneas largas
+char NoiseSensorI2CSlave::logBuffer[NOISE_LOG_BUFFER_SIZE];
+
+#if NOISE_REPLAY
+TraceReader* NoiseSensorI2CSlave::replaySource = nullptr;
+#endif
+
+#if NOISE_CAPTURE_SAMPLES
+// Buffer de captura preasignado: grabar no reserva heap
+int16_t NoiseSensorI2CSlave::captureBuffer[NOISE_CAPTURE_SAMPLES];
+#endif
+
+#if NOISE_FIXED_POINT
+// Zona de trabajo de las etapas de la cadena, repartida en begin()
+alignas(16) uint8_t NoiseSensorI2CSlave::pipelineArena[NOISE_PIPELINE_ARENA_BYTES];
+#endif
+
+#if defined(ARDUINO_ARCH_ESP32)
+// Los callbacks I2C corren en la tarea del driver, en paralelo con loop(): update() registra
+// cada SensorData en las sesiones delta (track()) mientras onRequest() codifica y onReceive()
+// confirma. Con el transporte serie, handleCommand()/buildResponse() corren además en
+// serviceStream() (loop). Los cursores son de cada transporte (TransportState); lo compartido
+// (sesiones delta, suscripciones, contadores de PerfStats) se toca con este cerrojo: sección
+// crítica de unos µs, sin Serial, Wire ni flash dentro.
+static portMUX_TYPE commandMux = portMUX_INITIALIZER_UNLOCKED;
+
+class CommandLock {
+public:
+    CommandLock() { portENTER_CRITICAL(&commandMux); }
+    ~CommandLock() { portEXIT_CRITICAL(&commandMux); }
+};
+#else
+// Host: los callbacks I2C simulados corren en el mismo hilo que update()
+class CommandLock {
+public:
+    CommandLock() {}
+};
+#endif
+
 NoiseSensorI2CSlave::NoiseSensorI2CSlave(const Config& config) 
     : config(config),
+      noiseSensor(toNoiseConfig(config)),
       dataReady(false),
       initialized(false),
+      serving(false),
       adcActive(false),
-      lastUpdate(0),
+      bootUs(0),
+      bootCheckFailed(false),
+      adcCheckRunning(false),
+      adcCheckSignal(false),
+      adcCheckSamples(0),
+      adcCheckCpuUs(0),
+      adcCheckNextUs(0),
+      lastAdcCheckUs(0),
+      callbackBeats(0),
+      callbackEnterUs(0),
+      lastBeats(0),
+      recoverBeats(0),
+      lastBeatUs(0),
+      lineLowSinceUs(0),
+      hangStartUs(0),
+      recoverAtUs(0),
+      levelShift(0.0f),
+      levelSum(0.0f),
+      levelSumSq(0.0f),
+      levelCount(0),
       instanceOwner(false),
-      lastCommand(CMD_GET_STATUS),
-      pendingReset(false) {
-    // Configurar NoiseSensor
-    NoiseSensor::Config noiseConfig;
-    noiseConfig.adcPin = config.adcPin;
-    noiseConfig.logLevel = config.logLevel;
-    noiseSensor = NoiseSensor(noiseConfig);
-    
+      pendingReset(false),
+      pendingLatch(false),
+      latchRequestMicros(0),
+      snapshotReady(false),
+      pendingTimeSync(false),
+      syncMasterUs(0),
+      syncLocalUs(0),
+      historyHead(0),
+      historyCount(0),
+      requestedSubscriptions(0),
+      windowsRequestMs(0),
+      weightedRequestMs(0),
+      inferredSubscriptions(0),
+      activeSubscriptions(0xFFFFFFFF),
+      skippedWindowUpdates(0),
+      heapFreeAtBegin(0),
+      heapMinFreeSinceBegin(0),
+      lastUpdateCallUs(0),
+      measureCycles(0),
+      measureCalls(0)
+#if NOISE_FIXED_POINT
+      , pipeline(pipelineArena, sizeof(pipelineArena)),
+      levelSink(fixedStats, fixedCycle, windows, SLIDING_WINDOW_COUNT),
+      weightingSink(timeWeighting),
+      pendingSamples(0),
+      streamCheckCode(0)
+#endif
+#if NOISE_CAPTURE_SAMPLES
+      , capture(captureBuffer, NOISE_CAPTURE_SAMPLES),
+      pendingCaptureMs(0)
+#endif
+#if NOISE_FLASH_LOG
+      , logWriteUs(0),
+      logMaxWriteUs(0)
+#endif
+#if NOISE_HUB
+      , hub(nullptr)
+#endif
+      {
     // Inicializar estructura de datos
     memset(&sensorData, 0, sizeof(sensorData));
+    memset(&snapshot, 0, sizeof(snapshot));
+    memset(&windowExtremes, 0, sizeof(windowExtremes));
+    memset(&busHealth, 0, sizeof(busHealth));
+    memset(history, 0, sizeof(history));
+#if NOISE_FIXED_POINT
+    memset(&sensorDataFixed, 0, sizeof(sensorDataFixed));
+    memset(&weightedLevels, 0, sizeof(weightedLevels));
+    weightingSink.subscription = SUB_WEIGHTED;
+    dcBlocker.subscription = SUB_WEIGHTED;   // Solo alimenta a TimeWeighting
+#endif
+    i2cState.reset();
+#if NOISE_STREAM
+    streamState.reset();
+#endif
+#if NOISE_FLASH_LOG
+    // La posición de lectura del log es de I2C hasta que otro transporte la pida
+    i2cState.logActive = true;
+    logReader = &i2cState;
+#endif
     
     // Establecer instancia para callbacks estáticos (solo una instancia permitida)
     if (instance == nullptr) {
@@ -32,9 +146,35 @@ NoiseSensorI2CSlave::NoiseSensorI2CSlave(const Config& config)
     }
 }
 
+void NoiseSensorI2CSlave::TransportState::reset() {
+    lastCommand = CMD_GET_STATUS;
+    historyRequestIndex = 0;
+    deltaSessionIndex = 0;
+#if NOISE_CAPTURE_SAMPLES
+    captureOffset = 0;
+#endif
+#if NOISE_FLASH_LOG
+    pendingLogSeek = LOG_SEEK_NONE;
+    logSeekTimestamp = 0;
+    logSeekCursor = 0;
+    logResumeCursor = 0;
+    logResumeValid = false;
+    logActive = false;
+    logFrameLength = 0;
+#endif
+#if NOISE_TRACE
+    traceReadCore = 0;
+#endif
+#if NOISE_HUB
+    hubMapOffset = 0;
+    hubLeafIndex = 0;
+    hubHistoryIndex = 0;
+#endif
+}
+
 void NoiseSensorI2CSlave::begin() {
     if (!instanceOwner) {
-        if (config.logLevel >= NoiseSensor::LOG_ERROR) {
+        if (logEnabled(NoiseSensor::LOG_ERROR)) {
             Serial.println("ERROR: Solo se permite una instancia de NoiseSensorI2CSlave por programa.");
         }
         return;
@@ -42,79 +182,218 @@ void NoiseSensorI2CSlave::begin() {
 
     // Validar configuración usando el método isValid()
     if (!isValid()) {
-        if (config.logLevel >= NoiseSensor::LOG_ERROR) {
+        if (logEnabled(NoiseSensor::LOG_ERROR)) {
             if (config.i2cAddress < MIN_I2C_ADDRESS || config.i2cAddress > MAX_I2C_ADDRESS) {
-                Serial.printf("ERROR: Dirección I2C inválida (0x%02X). Debe estar entre 0x%02X y 0x%02X\n", 
-                              config.i2cAddress, MIN_I2C_ADDRESS, MAX_I2C_ADDRESS);
+                logPrintf("ERROR: Dirección I2C inválida (0x%02X). Debe estar entre 0x%02X y 0x%02X\n",
+                          config.i2cAddress, MIN_I2C_ADDRESS, MAX_I2C_ADDRESS);
             }
             if (!isValidGpioPin(config.sdaPin)) {
-                Serial.printf("ERROR: Pin SDA inválido (%d).\n", config.sdaPin);
+                logPrintf("ERROR: Pin SDA inválido (%d).\n", config.sdaPin);
             }
             if (!isValidGpioPin(config.sclPin)) {
-                Serial.printf("ERROR: Pin SCL inválido (%d).\n", config.sclPin);
+                logPrintf("ERROR: Pin SCL inválido (%d).\n", config.sclPin);
             }
             if (!isValidAdcPin(config.adcPin)) {
-                Serial.printf("ERROR: Pin ADC inválido (%d) para esta plataforma.\n", config.adcPin);
+                logPrintf("ERROR: Pin ADC inválido (%d) para esta plataforma.\n", config.adcPin);
+            }
+            if (config.latchPin != PIN_DISABLED && !isValidGpioPin(config.latchPin)) {
+                logPrintf("ERROR: Pin de latch inválido (%d).\n", config.latchPin);
             }
             if (config.sdaPin == config.sclPin) {
-                Serial.println("ERROR: SDA y SCL no pueden usar el mismo pin.");
+                logPrintf("ERROR: SDA y SCL no pueden usar el mismo pin (%d).\n", config.sdaPin);
             }
             if (config.updateInterval < MIN_UPDATE_INTERVAL) {
-                Serial.printf("ERROR: Intervalo de actualización inválido (%lu ms). Debe ser >= %lu ms\n", 
-                              config.updateInterval, MIN_UPDATE_INTERVAL);
+                logPrintf("ERROR: Intervalo de actualización inválido (%lu ms). Debe ser >= %lu ms\n",
+                          config.updateInterval, MIN_UPDATE_INTERVAL);
+            }
+            if (config.sampleRateHz != 0 &&
+                (config.sampleRateHz < ADC_STREAM_MIN_RATE || config.sampleRateHz > ADC_STREAM_MAX_RATE)) {
+                logPrintf("ERROR: Frecuencia de muestreo inválida (%lu Hz). Debe estar entre %lu y %lu Hz\n",
+                          static_cast<unsigned long>(config.sampleRateHz),
+                          static_cast<unsigned long>(ADC_STREAM_MIN_RATE),
+                          static_cast<unsigned long>(ADC_STREAM_MAX_RATE));
+            }
+            if (config.adaptiveInterval &&
+                (config.minAdaptiveInterval < MIN_UPDATE_INTERVAL || config.minAdaptiveInterval > config.updateInterval ||
+                 config.maxAdaptiveInterval < config.updateInterval || config.maxAdaptiveInterval > MAX_ADAPTIVE_INTERVAL)) {
+                logPrintf("ERROR: Límites del intervalo adaptativo inválidos (%lu-%lu ms). Deben cumplir %lu <= mín <= updateInterval <= máx <= %lu\n",
+                          config.minAdaptiveInterval, config.maxAdaptiveInterval, MIN_UPDATE_INTERVAL, MAX_ADAPTIVE_INTERVAL);
+            }
+            if (config.adaptiveInterval && !(config.quietStdDevMv < config.activeStdDevMv)) {
+                char quiet[16];
+                char active[16];
+                logPrintf("ERROR: quietStdDevMv (%s) debe ser menor que activeStdDevMv (%s).\n",
+                          formatFloat2(config.quietStdDevMv, quiet, sizeof(quiet)),
+                          formatFloat2(config.activeStdDevMv, active, sizeof(active)));
+            }
+            if (config.decimationRatio < Decimator::MIN_RATIO || config.decimationRatio > Decimator::MAX_RATIO) {
+                logPrintf("ERROR: Factor de decimación inválido (%u). Debe estar entre %u y %u\n",
+                          config.decimationRatio, Decimator::MIN_RATIO, Decimator::MAX_RATIO);
+            }
+            if (!isValidWindows(config)) {
+                logPrintf("ERROR: Ventanas deslizantes inválidas. Cada una debe estar entre %u y %lu ms\n",
+                          SLIDING_BUCKETS, static_cast<unsigned long>(MAX_SLIDING_WINDOW_MS));
+            }
+            if (config.adcAttenuation > 3) {
+                logPrintf("ERROR: Atenuación del ADC inválida (%u). Debe estar entre 0 y 3\n", config.adcAttenuation);
+            }
+            if (!isValidTransports(config)) {
+                logPrintf("ERROR: Transportes inválidos (0x%02X). TRANSPORT_SERIAL requiere NOISE_STREAM=1 y serialPort\n", config.transports);
             }
         }
         return;
     }
     
-    if (config.logLevel >= NoiseSensor::LOG_INFO) {
+    // El bus se atiende lo primero: tras un reset el maestro ve la identidad y el estado
+    // "arrancando" en milisegundos. La verificación del ADC y el primer registro siguen en update().
+    if ((config.transports & TRANSPORT_I2C) && !startWire()) {
+        return;
+    }
+#if NOISE_STREAM
+    if (config.transports & TRANSPORT_SERIAL) {
+        stream.begin(config.serialPort);
+    }
+#endif
+    bootUs = localMicros();
+    serving = true;
+    perfStats.recordBootServe(static_cast<uint32_t>(bootUs));
+
+    if (logEnabled(NoiseSensor::LOG_INFO)) {
         Serial.println("=== Inicializando NoiseSensor I2C Slave ===");
-        Serial.printf("Dirección I2C: 0x%02X\n", config.i2cAddress);
-        Serial.printf("SDA Pin: %d, SCL Pin: %d\n", config.sdaPin, config.sclPin);
-        Serial.printf("ADC Pin: %d\n", config.adcPin);
+        logPrintf("Dirección I2C: 0x%02X (atendiendo a los %lu us del reset)\n", config.i2cAddress,
+                  static_cast<unsigned long>(bootUs));
+        logPrintf("SDA Pin: %d, SCL Pin: %d\n", config.sdaPin, config.sclPin);
+        logPrintf("ADC Pin: %d\n", config.adcPin);
+    }
+
+    // Línea de latch compartida: un flanco congela el snapshot en todos los esclavos a la vez
+    if (config.latchPin != PIN_DISABLED) {
+        pinMode(config.latchPin, INPUT_PULLUP);
+        attachInterrupt(digitalPinToInterrupt(config.latchPin), onLatchStatic, FALLING);
+    }
+
+    if (logEnabled(NoiseSensor::LOG_INFO)) {
+        Serial.println("I2C esclavo configurado");
+        if (config.latchPin != PIN_DISABLED) {
+            logPrintf("Latch Pin: %d\n", config.latchPin);
+        }
     }
     
+    // Inicializar sensor de ruido (con punto fijo la ruta entera lo sustituye)
+#if !NOISE_FIXED_POINT
+    noiseSensor.begin();
+#endif
+    analogSetPinAttenuation(config.adcPin, static_cast<adc_attenuation_t>(config.adcAttenuation));
+#if NOISE_FIXED_POINT
+    // La tabla de calibración se construye una vez: la ruta caliente solo indexa
+    const bool efuse = calibration.begin(config.adcPin, config.adcAttenuation, NOISE_ADC_FULL_SCALE_MV);
+    if (logEnabled(NoiseSensor::LOG_INFO)) {
+        logPrintf("Calibración ADC: %s (atenuación %u, %ld mV a fondo de escala)\n",
+                  efuse ? "eFuse" : "lineal", config.adcAttenuation,
+                  static_cast<long>(calibration.toMilliVolts(4095)));
+    }
+    // Las etapas de la librería cierran la cadena: ven el bloque ya transformado. LevelStats
+    // recibe los mV con la DC (SensorData conserva su significado); el bloqueo de DC va detrás
+    // y solo cambia lo que ve TimeWeighting, donde la polarización dominaría la energía
+    if (!pipeline.isPrepared()) {
+        pipeline.add(&levelSink);
+        if (config.dcBlock) {
+            pipeline.add(&dcBlocker);
+        }
+        pipeline.add(&weightingSink);
+        pipeline.prepare();
+        fixedCycle.restart(static_cast<uint32_t>(localMicros() / 1000));
+        if (logEnabled(NoiseSensor::LOG_INFO)) {
+            logPrintf("Cadena de bloques: %u etapas, zona de trabajo %u/%u bytes\n",
+                      pipeline.getStageCount(), static_cast<unsigned>(pipeline.getArena().getUsed()),
+                      static_cast<unsigned>(pipeline.getArena().getSize()));
+        }
+    }
+    // Los kernels PIE se comparan una vez con los escalares; si difieren se usan los escalares
+    if (blockKernelsVectorized()) {
+        const uint32_t mismatches = blockKernelsSelfCheck();
+        if (mismatches != 0 && logEnabled(NoiseSensor::LOG_ERROR)) {
+            logPrintf("ERROR: kernels de bloque PIE distintos de los escalares en %lu casos, se usan los escalares\n",
+                      static_cast<unsigned long>(mismatches));
+        }
+    }
+    startAdcStream();
+#endif
+    
+    if (config.adaptiveInterval) {
+        adaptive.configure(config.updateInterval, config.minAdaptiveInterval, config.maxAdaptiveInterval,
+                           config.quietStdDevMv, config.activeStdDevMv, config.quietIntervals);
+    }
+    for (uint8_t i = 0; i < SLIDING_WINDOW_COUNT; i++) {
+        windows[i].configure(config.slidingWindowMs[i]);
+    }
+
+    // La señal del micrófono se verifica en las siguientes llamadas a update(), sin bloquear
+    startADCCheck(localMicros());
+}
+
+bool NoiseSensorI2CSlave::startWire() {
     // Configurar tamaño de buffer I2C (debe hacerse antes de begin() para afectar I2C_BUFFER_LENGTH)
     const size_t buf = Wire.setBufferSize(64);
-    if (buf < 64 && config.logLevel >= NoiseSensor::LOG_ERROR) {
-        Serial.printf("ERROR: Wire.setBufferSize(64) devolvió %u\n", static_cast<unsigned>(buf));
-        return;
+    if (buf < 64) {
+        if (logEnabled(NoiseSensor::LOG_ERROR)) {
+            logPrintf("ERROR: Wire.setBufferSize(64) devolvió %u\n", static_cast<unsigned>(buf));
+        }
+        return false;
     }
 
     // Configurar I2C como esclavo
     // Firma Arduino-ESP32: begin(uint8_t slaveAddr, int sda, int scl, uint32_t frequency)
     if (!Wire.begin(config.i2cAddress, config.sdaPin, config.sclPin, 100000)) {
-        if (config.logLevel >= NoiseSensor::LOG_ERROR) {
+        if (logEnabled(NoiseSensor::LOG_ERROR)) {
             Serial.println("ERROR: Fallo al inicializar I2C en modo esclavo (Wire.begin).");
         }
-        return;
+        return false;
     }
 
     Wire.onRequest(onRequestStatic);  // Callback cuando el maestro solicita datos
     Wire.onReceive(onReceiveStatic);  // Callback cuando el maestro envía datos
-    
-    if (config.logLevel >= NoiseSensor::LOG_INFO) {
-        Serial.println("I2C esclavo configurado");
+    return true;
+}
+
+void NoiseSensorI2CSlave::serviceBoot() {
+    if (!stepADCCheck(localMicros())) {
+        return;
     }
-    
-    // Inicializar sensor de ruido
-    noiseSensor.begin();
-    
-    // Verificar que el ADC está recibiendo señal del micrófono
-    adcActive = checkADCSignal();
-    
+    adcActive = adcCheckSignal;
     if (!adcActive) {
-        if (config.logLevel >= NoiseSensor::LOG_ERROR) {
+        if (logEnabled(NoiseSensor::LOG_ERROR)) {
             Serial.println("ERROR: No se detecta señal en el ADC. Verifica la conexión del micrófono.");
         }
-        // No marcar como inicializado si no hay señal ADC
+        // Sin señal no se publican registros; se reintenta con la cadencia de la supervisión
+        bootCheckFailed = true;
+        startADCCheck(localMicros() + ADC_CHECK_PERIOD_US);
         return;
     }
-    
-    // Marcar como inicializado solo si todo fue exitoso
+
+    // Marcar como inicializado solo si todo fue exitoso.
+    // A partir de aquí la librería no reserva heap: se registra la referencia para vigilarlo.
     initialized = true;
+    lastAdcCheckUs = localMicros();
+    // El primer intervalo cuenta desde que el bus está activo: la verificación queda dentro
+    scheduler.start(bootCheckFailed ? lastAdcCheckUs : bootUs, static_cast<uint32_t>(config.updateInterval * 1000UL));
+#if NOISE_FLASH_LOG
+    // Montar el log recorre las cabeceras de página (~1 ms por cada 64 KB)
+    if (flashLog.begin(openLogPartition(NOISE_LOG_PARTITION))) {
+        if (logEnabled(NoiseSensor::LOG_INFO)) {
+            logPrintf("Log en flash: %lu KB, cursor más antiguo 0x%08lX, siguiente 0x%08lX\n",
+                      static_cast<unsigned long>(flashLog.getCapacityBytes() / 1024),
+                      static_cast<unsigned long>(flashLog.getOldestCursor()),
+                      static_cast<unsigned long>(flashLog.getNextCursor()));
+        }
+    } else if (logEnabled(NoiseSensor::LOG_ERROR)) {
+        logPrintf("ERROR: No hay partición '%s' para el log en flash (mín. 8 KB).\n", NOISE_LOG_PARTITION);
+    }
+#endif
+    heapFreeAtBegin = heapReport().freeNow;
+    heapMinFreeSinceBegin = heapFreeAtBegin;
     
-    if (config.logLevel >= NoiseSensor::LOG_INFO) {
+    if (logEnabled(NoiseSensor::LOG_INFO)) {
         Serial.println("Sensor de ruido inicializado");
         Serial.println("ADC activo - Micrófono detectado");
         Serial.println("Esperando solicitudes I2C...");
@@ -123,164 +402,937 @@ void NoiseSensorI2CSlave::begin() {
 }
 
 void NoiseSensorI2CSlave::update() {
-    // No hacer nada si no está inicializado
-    if (!initialized) {
+    // No hacer nada si begin() no llegó a activar el bus
+    if (!serving) {
         return;
     }
+    NOISE_TRACE_SCOPE(TRACE_UPDATE);
+
+    const int64_t callMicros = localMicros();
+    if (lastUpdateCallUs != 0) {
+        perfStats.recordLoopPeriod(static_cast<uint32_t>(callMicros - lastUpdateCallUs));
+    }
+    lastUpdateCallUs = callMicros;
+
+#if NOISE_STREAM
+    // Antes que las acciones pendientes: las pedidas por serie se procesan en este mismo update()
+    serviceStream();
+#endif
+
+    // Procesar acciones pedidas por I2C fuera del callback (contexto no crítico).
+    // El latch va antes del reset para no perder la ventana que el maestro quería congelar.
+    if (pendingTimeSync) {
+        pendingTimeSync = false;
+        timeSync.sync(syncMasterUs, syncLocalUs);
+    }
+
+    refreshSubscriptions();
+
+    if (pendingLatch) {
+        pendingLatch = false;
+        latchSnapshot();
+    }
 
-    // Procesar acciones pedidas por I2C fuera del callback (contexto no crítico)
     if (pendingReset) {
         pendingReset = false;
+#if NOISE_FIXED_POINT
+        flushPendingSamples();   // Las muestras ya leídas pertenecen al ciclo que se descarta
+        fixedCycle.restart(static_cast<uint32_t>(localMicros() / 1000));
+#else
         noiseSensor.resetCycle();
+#endif
+    }
+
+#if NOISE_CAPTURE_SAMPLES
+    if (pendingCaptureMs != 0) {
+        const uint16_t durationMs = pendingCaptureMs;
+        pendingCaptureMs = 0;
+        i2cState.captureOffset = 0;
+#if NOISE_STREAM
+        streamState.captureOffset = 0;
+#endif
+        // Solo el ADC continuo da muestras a tasa fija; las de update() tienen el jitter del loop
+#if NOISE_FIXED_POINT
+        if (adcStream.isRunning()) {
+            capture.start(localMicros(), durationMs, adcStream.getRateHz());
+        } else
+#endif
+        {
+            (void)durationMs;
+            capture.refuse();
+            if (logEnabled(NoiseSensor::LOG_ERROR)) {
+                Serial.println("WARNING: Captura rechazada: requiere ADC continuo (NOISE_FIXED_POINT y sampleRateHz).");
+            }
+        }
     }
+#endif
     
-    // Actualizar sensor de ruido
-    noiseSensor.update();
+#if NOISE_FLASH_LOG
+    serviceLogReader();
+#endif
+
+#if NOISE_HUB
+    // Como mucho una transacción con una hoja por llamada (limitada por busTimeoutMs)
+    if (hub != nullptr) {
+        hub->update(localMicros());
+    }
+#endif
     
-    // Verificar periódicamente que el ADC sigue activo (cada 10 segundos, menos frecuente)
-    static unsigned long lastADCCheck = 0;
-    unsigned long currentMillis = millis();
-    if (currentMillis - lastADCCheck >= 10000) {
-        lastADCCheck = currentMillis;
-        bool previousState = adcActive;
-        adcActive = checkADCSignal();
-        
-        if (!adcActive && previousState && config.logLevel >= NoiseSensor::LOG_INFO) {
-            Serial.println("WARNING: Se perdió la señal del ADC");
-        } else if (adcActive && !previousState && config.logLevel >= NoiseSensor::LOG_INFO) {
-            Serial.println("INFO: Señal del ADC recuperada");
+    // Actualizar sensor de ruido: la ruta entera sustituye a NoiseSensor (una sola lectura del ADC)
+    const uint32_t measureStart = ESP.getCycleCount();
+#if NOISE_FIXED_POINT
+    if (adcStream.isRunning()) {
+        drainAdcStream();
+    } else {
+        // Conversión calibrada a mV enteros; la cadena procesa las muestras por bloques
+        streamBlock[pendingSamples++] = static_cast<int16_t>(readAdcMilliVolts());
+        if (pendingSamples == STREAM_BLOCK_SAMPLES) {
+            flushPendingSamples();
         }
     }
-    
-    // Actualizar datos cada intervalo configurado
-    if (currentMillis - lastUpdate >= config.updateInterval) {
-        lastUpdate = currentMillis;
-        
-        const auto& measurements = noiseSensor.getMeasurements();
-        
-        sensorData.noise = measurements.noise;
-        sensorData.noiseAvg = measurements.noiseAvg;
-        sensorData.noisePeak = measurements.noisePeak;
-        sensorData.noiseMin = measurements.noiseMin;
-        sensorData.noiseAvgLegal = measurements.noiseAvgLegal;
-        sensorData.noiseAvgLegalMax = measurements.noiseAvgLegalMax;
-        sensorData.lowNoiseLevel = measurements.lowNoiseLevel;
-        sensorData.cycles = measurements.cycles;
+#else
+    noiseSensor.update();
+#endif
+    measureCycles += ESP.getCycleCount() - measureStart;
+    measureCalls++;
+#if !NOISE_FIXED_POINT
+    // En la ruta de punto fijo levelSink alimenta las ventanas y la varianza del intervalo por bloques
+    if (config.adaptiveInterval) {
+        trackLevel();
+    }
+#endif
+    trackWindows();
+
+    superviseBus();
+
+    // Arranque: las medidas ya corren mientras se verifica el ADC; los registros esperan a la verificación
+    if (!initialized) {
+        serviceBoot();
+    }
+
+    // Actualizar datos en cada plazo absoluto (el retraso de una llamada no se acumula)
+    if (initialized && scheduler.poll(localMicros())) {
+        NOISE_TRACE_SCOPE(TRACE_AGGREGATION);
+        const uint32_t lateUs = scheduler.getLastLateUs();
+        if (lateUs > LATE_UPDATE_THRESHOLD * 1000UL) {
+            perfStats.recordLateUpdate(lateUs);
+        }
         
+        const int64_t aggregationStart = localMicros();
+#if NOISE_FIXED_POINT
+        flushPendingSamples();
+#endif
+        fillSensorData(sensorData, aggregationStart);
+        pushHistory(sensorData);
+#if NOISE_FLASH_LOG
+        appendLog();
+#endif
+        {
+            // encode()/acknowledge() corren en el callback I2C: la línea base no cambia a mitad
+            CommandLock lock;
+            for (uint8_t i = 0; i < NOISE_DELTA_SESSIONS; i++) {
+                deltaSessions[i].track(sensorData, config.deltaDeadbandsMv);
+            }
+        }
+        if (config.adaptiveInterval) {
+            adaptInterval();
+        }
+        if (!(activeSubscriptions & SUB_WINDOWS)) {
+            // Sin suscripción los extremos solo se publican una vez por intervalo
+            publishWindows(aggregationStart);
+        }
+        if (!dataReady) {
+            const uint32_t firstFrameUs = static_cast<uint32_t>(localMicros());
+            perfStats.recordFirstFrame(firstFrameUs);
+            if (logEnabled(NoiseSensor::LOG_INFO)) {
+                logPrintf("Primer registro válido a los %lu us del reset (%lu us tras activar el bus)\n",
+                          static_cast<unsigned long>(firstFrameUs),
+                          static_cast<unsigned long>(firstFrameUs - static_cast<uint32_t>(bootUs)));
+            }
+        }
         dataReady = true;
+        sampleHeap();
+
+#if NOISE_FIXED_POINT
+        const uint32_t samples = fixedStats.getCount();
+        sensorDataFixed.noiseMv = fixedStats.getLast();
+        sensorDataFixed.noiseAvgMv = fixedStats.getMean();
+        sensorDataFixed.noisePeakMv = fixedStats.getMax();
+        sensorDataFixed.noiseMinMv = fixedStats.getMin();
+        sensorDataFixed.leqCentiDb = fixedStats.getLeqCentiDb();
+        sensorDataFixed.samples = samples;
+        sensorDataFixed.timestamp = sensorData.timestamp;
+        fixedStats.reset();
+
+        if (activeSubscriptions & SUB_WEIGHTED) {
+            weightedLevels.fastCentiDb = timeWeighting.getFastCentiDb();
+            weightedLevels.slowCentiDb = timeWeighting.getSlowCentiDb();
+            weightedLevels.impulseCentiDb = timeWeighting.getImpulseCentiDb();
+            weightedLevels.fastMaxCentiDb = timeWeighting.getFastMaxCentiDb();
+            weightedLevels.slowMaxCentiDb = timeWeighting.getSlowMaxCentiDb();
+            weightedLevels.impulseMaxCentiDb = timeWeighting.getImpulseMaxCentiDb();
+            weightedLevels.sampleRateHz = timeWeighting.getSampleRate();
+            timeWeighting.resetMax();
+        } else {
+            // Detectores parados: aproximación por el Leq del intervalo (sampleRateHz = 0 lo indica)
+            weightedLevels.fastCentiDb = weightedLevels.slowCentiDb = weightedLevels.impulseCentiDb =
+                sensorDataFixed.leqCentiDb;
+            weightedLevels.fastMaxCentiDb = weightedLevels.slowMaxCentiDb = weightedLevels.impulseMaxCentiDb =
+                sensorDataFixed.leqCentiDb;
+            weightedLevels.sampleRateHz = 0;
+        }
+        weightedLevels.timestamp = sensorData.timestamp;
+        if (!adcStream.isRunning() && sensorData.intervalMs > 0) {
+            // Una muestra por update(): los coeficientes siguen la tasa medida del loop
+            const uint32_t rateHz = static_cast<uint32_t>(static_cast<uint64_t>(samples) * 1000 / sensorData.intervalMs);
+            timeWeighting.setSampleRate(rateHz);
+            pipeline.setSampleRate(rateHz);
+        }
+#endif
+#if NOISE_STREAM
+        pushRecord();
+#endif
+        perfStats.recordAggregation(static_cast<uint32_t>(localMicros() - aggregationStart));
         
-        if (config.logLevel >= NoiseSensor::LOG_INFO) {
+        if (logEnabled(NoiseSensor::LOG_INFO)) {
             Serial.println("=== Datos del Sensor ===");
-            Serial.printf("Actual: %.2f mV\n", sensorData.noise);
-            Serial.printf("Promedio: %.2f mV\n", sensorData.noiseAvg);
-            Serial.printf("Pico: %.2f mV\n", sensorData.noisePeak);
-            Serial.printf("Mínimo: %.2f mV\n", sensorData.noiseMin);
-            Serial.printf("Promedio Legal: %.2f mV\n", sensorData.noiseAvgLegal);
-            Serial.printf("Máximo Legal: %.2f mV\n", sensorData.noiseAvgLegalMax);
-            Serial.printf("Nivel Base: %d mV\n", sensorData.lowNoiseLevel);
-            Serial.printf("Ciclos: %u\n", sensorData.cycles);
+            char num[16];
+            logPrintf("Actual: %s mV\n", formatFloat2(sensorData.noise, num, sizeof(num)));
+            logPrintf("Promedio: %s mV\n", formatFloat2(sensorData.noiseAvg, num, sizeof(num)));
+            logPrintf("Pico: %s mV\n", formatFloat2(sensorData.noisePeak, num, sizeof(num)));
+            logPrintf("Mínimo: %s mV\n", formatFloat2(sensorData.noiseMin, num, sizeof(num)));
+            logPrintf("Promedio Legal: %s mV\n", formatFloat2(sensorData.noiseAvgLegal, num, sizeof(num)));
+            logPrintf("Máximo Legal: %s mV\n", formatFloat2(sensorData.noiseAvgLegalMax, num, sizeof(num)));
+            logPrintf("Nivel Base: %d mV\n", sensorData.lowNoiseLevel);
+            logPrintf("Ciclos: %u\n", sensorData.cycles);
+            if (config.adaptiveInterval) {
+                logPrintf("Intervalo: %u ms (siguiente: %lu ms)\n", sensorData.intervalMs, getUpdateInterval());
+            }
+            logPrintf("Timestamp: %llu us%s\n", static_cast<unsigned long long>(sensorData.timestamp),
+                      timeSync.isSynced() ? "" : " (sin sincronizar)");
+            logPrintf("Heap libre: %lu B (mín. desde begin: %lu B)\n",
+                      static_cast<unsigned long>(heapReport().freeNow),
+                      static_cast<unsigned long>(heapMinFreeSinceBegin));
+#if NOISE_FIXED_POINT
+            logPrintf("Punto fijo: media %ld mV, pico %ld mV, mín %ld mV, Leq %ld.%02ld dB\n",
+                      static_cast<long>(sensorDataFixed.noiseAvgMv),
+                      static_cast<long>(sensorDataFixed.noisePeakMv),
+                      static_cast<long>(sensorDataFixed.noiseMinMv),
+                      static_cast<long>(sensorDataFixed.leqCentiDb / 100),
+                          static_cast<long>(abs(sensorDataFixed.leqCentiDb % 100)));
+            logPrintf("Máximos F/S/I: %ld.%02ld / %ld.%02ld / %ld.%02ld dB\n",
+                      static_cast<long>(weightedLevels.fastMaxCentiDb / 100),
+                      static_cast<long>(abs(weightedLevels.fastMaxCentiDb % 100)),
+                      static_cast<long>(weightedLevels.slowMaxCentiDb / 100),
+                      static_cast<long>(abs(weightedLevels.slowMaxCentiDb % 100)),
+                      static_cast<long>(weightedLevels.impulseMaxCentiDb / 100),
+                      static_cast<long>(abs(weightedLevels.impulseMaxCentiDb % 100)));
+            if (samples > 0) {
+                logPrintf("Ciclos/muestra (punto fijo): %lu\n", static_cast<unsigned long>(measureCycles / samples));
+            }
+            if (adcStream.isRunning()) {
+                logPrintf("ADC continuo: %lu muestras decimadas, desbordes %lu\n",
+                          static_cast<unsigned long>(samples),
+                          static_cast<unsigned long>(adcStream.getOverruns()));
+            }
+#endif
+            if (measureCalls > 0) {
+                // Mismo punto de medida con y sin NOISE_FIXED_POINT: comparable entre builds en el chip
+                logPrintf("Ciclos de medida por update(): %lu\n", static_cast<unsigned long>(measureCycles / measureCalls));
+            }
             Serial.println();
         }
-        
+        measureCycles = 0;
+        measureCalls = 0;
+
+#if NOISE_FIXED_POINT
+        // Mismo momento que NoiseSensor: el registro que cierra el ciclo todavía lo incluye
+        const uint32_t nowMs = static_cast<uint32_t>(aggregationStart / 1000);
+        if (nowMs - fixedCycle.getStartMs() >= FIXED_CYCLE_MS) {
+            if (logEnabled(NoiseSensor::LOG_INFO)) {
+                Serial.println("Ciclo completado - datos listos para enviar");
+            }
+            fixedCycle.close(nowMs);
+        }
+#else
         if (noiseSensor.isCycleComplete()) {
-            if (config.logLevel >= NoiseSensor::LOG_INFO) {
+            if (logEnabled(NoiseSensor::LOG_INFO)) {
                 Serial.println("Ciclo completado - datos listos para enviar");
             }
             noiseSensor.resetCycle();
         }
+#endif
+    }
+
+    // Una lectura de la verificación del ADC como mucho, después de la agregación
+    if (initialized) {
+        superviseADC();
+    }
+}
+
+#if NOISE_FIXED_POINT
+void NoiseSensorI2CSlave::startAdcStream() {
+    if (config.sampleRateHz == 0) {
+        return;
+    }
+    decimator.setRatio(config.decimationRatio);
+    // Los buffers del driver se reservan aquí, antes de la referencia de heap de begin()
+    if (!adcStream.begin(config.adcPin, config.sampleRateHz, config.adcAttenuation)) {
+        if (logEnabled(NoiseSensor::LOG_ERROR)) {
+            Serial.println("ERROR: No se pudo iniciar el ADC continuo, se usa la lectura por muestra.");
+        }
+        return;
+    }
+    timeWeighting.setSampleRate(config.sampleRateHz / config.decimationRatio);
+    pipeline.setSampleRate(config.sampleRateHz / config.decimationRatio);
+    if (logEnabled(NoiseSensor::LOG_INFO)) {
+        logPrintf("ADC continuo: %lu Hz, decimación %u -> %lu Hz, kernels de bloque %s\n",
+                  static_cast<unsigned long>(config.sampleRateHz), config.decimationRatio,
+                  static_cast<unsigned long>(config.sampleRateHz / config.decimationRatio),
+                  blockKernelsVectorized() ? "PIE" : "escalares");
+    }
+}
+
+void NoiseSensorI2CSlave::drainAdcStream() {
+    NOISE_TRACE_SCOPE(TRACE_DRAIN_ADC);
+    // Vaciar lo acumulado por el DMA desde la última llamada, bloque a bloque.
+    // Con el límite de bloques una ráfaga no alarga el loop indefinidamente.
+    const uint8_t maxBlocks = 32;
+    for (uint8_t b = 0; b < maxBlocks; b++) {
+        const size_t n = adcStream.read(streamBlock, STREAM_BLOCK_SAMPLES);
+        if (n == 0) {
+            break;
+        }
+        streamCheckCode = streamBlock[n - 1];
+#if NOISE_CAPTURE_SAMPLES
+        capture.add(streamBlock, n, localMicros());
+#endif
+        const size_t m = decimator.process(streamBlock, n, decimatedBlock);
+        // Códigos de 12 bits a mV calibrados en el propio bloque (el resultado cabe en int16_t)
+        for (size_t i = 0; i < m; i++) {
+            decimatedBlock[i] = static_cast<int16_t>(calibration.toMilliVolts(decimatedBlock[i]));
+        }
+        levelSink.setTime(localMicros());
+        pipeline.process(decimatedBlock, m);
+    }
+}
+
+void NoiseSensorI2CSlave::flushPendingSamples() {
+    // Lectura por muestra: la cadena corre cuando se llena el bloque y antes de agregar
+    if (pendingSamples > 0) {
+        levelSink.setTime(localMicros());
+        pipeline.process(streamBlock, pendingSamples);
+        pendingSamples = 0;
+    }
+}
+#endif
+
+#if !NOISE_FIXED_POINT
+float NoiseSensorI2CSlave::currentLevel() const {
+    return noiseSensor.getMeasurements().noise;
+}
+
+void NoiseSensorI2CSlave::trackLevel() {
+    const float level = currentLevel();
+    if (levelCount == 0) {
+        levelShift = level;
+    }
+    const float d = level - levelShift;
+    levelSum += d;
+    levelSumSq += d * d;
+    levelCount++;
+}
+#endif
+
+void NoiseSensorI2CSlave::trackWindows() {
+    // Las ventanas siempre reciben el nivel (en la ruta de punto fijo, los extremos de cada
+    // bloque desde levelSink); con suscripción los extremos se publican en cada llamada y la
+    // lectura por I2C es una copia sin efectos
+    const int64_t nowUs = localMicros();
+#if !NOISE_FIXED_POINT
+    const float level = currentLevel();
+    for (uint8_t i = 0; i < SLIDING_WINDOW_COUNT; i++) {
+        windows[i].add(level, nowUs);
+    }
+#endif
+    if (activeSubscriptions & SUB_WINDOWS) {
+        publishWindows(nowUs);
+    } else {
+        skippedWindowUpdates++;
+    }
+}
+
+void NoiseSensorI2CSlave::publishWindows(int64_t nowUs) {
+    for (uint8_t i = 0; i < SLIDING_WINDOW_COUNT; i++) {
+        windowExtremes.maxMv[i] = windows[i].getMax();
+        windowExtremes.minMv[i] = windows[i].getMin();
+        windowExtremes.spanMs[i] = windows[i].getSpanMs(nowUs);
+    }
+    // Sin suscripción solo se publica en la agregación: la lectura puede llegar un intervalo tarde
+    windowExtremes.flags = (activeSubscriptions & SUB_WINDOWS) ? 0 : WINDOWS_STALE;
+    windowExtremes.timestamp = timeSync.toMaster(nowUs);
+}
+
+void NoiseSensorI2CSlave::refreshSubscriptions() {
+    if (!config.lazyStages) {
+        activeSubscriptions = 0xFFFFFFFF;
+        return;
+    }
+    // Una lectura reciente de un comando mantiene su etapa activa durante subscriptionHoldMs
+    const uint32_t nowMs = static_cast<uint32_t>(localMicros() / 1000);
+    uint32_t inferred = 0;
+    if (config.subscriptionHoldMs > 0) {
+        const uint32_t windowsMs = windowsRequestMs;
+        const uint32_t weightedMs = weightedRequestMs;
+        if (windowsMs != 0 && nowMs - windowsMs < config.subscriptionHoldMs) {
+            inferred |= SUB_WINDOWS;
+        }
+        if (weightedMs != 0 && nowMs - weightedMs < config.subscriptionHoldMs) {
+            inferred |= SUB_WEIGHTED;
+        }
+    }
+    inferredSubscriptions = inferred;
+
+    const uint32_t active = requestedSubscriptions | inferred;
+#if NOISE_FIXED_POINT
+    if ((active & SUB_WEIGHTED) && !(activeSubscriptions & SUB_WEIGHTED) && fixedStats.getCount() > 0) {
+        // Los detectores retoman en régimen con la potencia del intervalo en curso (sin la DC si se bloquea)
+        timeWeighting.prime(config.dcBlock ? fixedStats.getVariance() : fixedStats.getMeanSquare());
+    }
+    pipeline.setActiveMask(active);
+#endif
+    activeSubscriptions = active;
+}
+
+void NoiseSensorI2CSlave::adaptInterval() {
+    // Desviación típica del nivel en el intervalo cerrado (una raíz por registro)
+    float stdDev = 0.0f;
+#if NOISE_FIXED_POINT
+    // Todas las muestras del intervalo, ya reducidas por bloques en fixedStats (antes de su reset)
+    if (fixedStats.getCount() > 1) {
+        stdDev = sqrtf(static_cast<float>(fixedStats.getVariance()));
+    }
+#else
+    if (levelCount > 1) {
+        const float mean = levelSum / levelCount;
+        const float variance = levelSumSq / levelCount - mean * mean;
+        stdDev = variance > 0.0f ? sqrtf(variance) : 0.0f;
+    }
+    levelSum = 0.0f;
+    levelSumSq = 0.0f;
+    levelCount = 0;
+#endif
+
+    // El siguiente plazo se ancla al último: el cambio no introduce deriva
+    scheduler.setPeriod(adaptive.update(stdDev) * 1000UL);
+}
+
+void NoiseSensorI2CSlave::superviseADC() {
+    // Verificar periódicamente que el ADC sigue activo (cada 10 segundos, menos frecuente)
+    const int64_t nowUs = localMicros();
+    if (!adcCheckRunning) {
+        if (nowUs - lastAdcCheckUs < ADC_CHECK_PERIOD_US) {
+            return;
+        }
+        lastAdcCheckUs = nowUs;
+        startADCCheck(nowUs);
+    }
+    if (!stepADCCheck(nowUs)) {
+        return;
+    }
+    bool previousState = adcActive;
+    adcActive = adcCheckSignal;
+
+    if (!adcActive && previousState && logEnabled(NoiseSensor::LOG_INFO)) {
+        Serial.println("WARNING: Se perdió la señal del ADC");
+    } else if (adcActive && !previousState && logEnabled(NoiseSensor::LOG_INFO)) {
+        Serial.println("INFO: Señal del ADC recuperada");
+    }
+}
+
+void NoiseSensorI2CSlave::superviseBus() {
+    if (config.busHangMs == 0 || !(config.transports & TRANSPORT_I2C)) {
+        return;
+    }
+    const int64_t nowUs = localMicros();
+    const int64_t hangUs = static_cast<int64_t>(config.busHangMs) * 1000;
+
+    const uint32_t beats = callbackBeats;
+    if (beats != lastBeats) {
+        lastBeats = beats;
+        lastBeatUs = nowUs;
+        lineLowSinceUs = 0;   // El periférico acaba de atender al maestro: una línea en bajo es tráfico
+    }
+
+    // En reposo SDA y SCL están en alto; una transacción las baja como mucho unos ms. Con el
+    // bus ocupado (otros esclavos) esta muestra puede caer siempre en mitad de una transacción:
+    // linesStuck() lo descarta antes de reiniciar
+    busHealth.lines = readBusLines();
+    const bool idle = busHealth.lines == 0x03;
+    if (idle) {
+        lineLowSinceUs = 0;
+    } else if (lineLowSinceUs == 0) {
+        lineLowSinceUs = nowUs;
+    }
+
+    if (busHealth.state == BUS_RECOVERING) {
+        // Recuperado cuando el bus vuelve al reposo o el maestro consigue un callback
+        if (idle || beats != recoverBeats) {
+            const int64_t recoverUs = nowUs - hangStartUs;
+            busHealth.lastRecoverUs = static_cast<uint32_t>(recoverUs > UINT32_MAX ? UINT32_MAX : recoverUs);
+            if (busHealth.lastRecoverUs > busHealth.maxRecoverUs) {
+                busHealth.maxRecoverUs = busHealth.lastRecoverUs;
+            }
+            busHealth.state = BUS_OK;
+            if (logEnabled(NoiseSensor::LOG_INFO)) {
+                logPrintf("INFO: Bus I2C recuperado en %lu us\n", static_cast<unsigned long>(busHealth.lastRecoverUs));
+            }
+        } else if (nowUs - recoverAtUs >= hangUs) {
+            // Sigue colgado (p. ej. otro dispositivo retiene la línea): se reintenta con la misma cadencia
+            busHealth.failedRecoveries++;
+            recoverBus(nowUs, busHealth.lastCause);
+        }
+        return;
+    }
+
+    const uint32_t enterUs = callbackEnterUs;
+    if (lineLowSinceUs != 0 && nowUs - lineLowSinceUs >= hangUs) {
+        if (linesStuck()) {
+            busHealth.lineHangs++;
+            hangStartUs = lineLowSinceUs;
+            recoverBus(nowUs, BUS_HANG_LINE_LOW);
+        } else {
+            lineLowSinceUs = 0;   // Las líneas se mueven: el bus trabaja
+        }
+    } else if (enterUs != 0 && static_cast<uint32_t>(static_cast<uint32_t>(nowUs) - enterUs) >= hangUs) {
+        busHealth.callbackHangs++;
+        hangStartUs = nowUs - static_cast<uint32_t>(static_cast<uint32_t>(nowUs) - enterUs);
+        recoverBus(nowUs, BUS_HANG_CALLBACK);
+    } else if (config.busSilenceMs != 0 && lastBeatUs != 0 &&
+               nowUs - lastBeatUs >= static_cast<int64_t>(config.busSilenceMs) * 1000) {
+        busHealth.silentHangs++;
+        hangStartUs = lastBeatUs;
+        recoverBus(nowUs, BUS_HANG_SILENT);
+    }
+}
+
+bool NoiseSensorI2CSlave::linesStuck() {
+    // Colgado = ninguna línea cambia en toda la ráfaga y alguna está en bajo. Con tráfico SCL
+    // cambia cada pocos µs; SDA puede seguir en bajo mucho rato (bytes a 0) y no basta sola.
+    // Unos 400 µs de loop, solo cuando una línea lleva busHangMs en bajo
+    const uint8_t first = readBusLines();
+    if (first == 0x03) {
+        return false;
+    }
+    for (uint8_t i = 1; i < BUS_CONFIRM_READS; i++) {
+        delayMicroseconds(BUS_CONFIRM_SPACING_US);
+        if (readBusLines() != first) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint8_t NoiseSensorI2CSlave::readBusLines() const {
+    return static_cast<uint8_t>((digitalRead(config.sdaPin) == HIGH ? 0x01 : 0) |
+                                (digitalRead(config.sclPin) == HIGH ? 0x02 : 0));
+}
+
+void NoiseSensorI2CSlave::recoverBus(int64_t nowUs, uint8_t cause) {
+    NOISE_TRACE_SCOPE(TRACE_BUS_RECOVERY);
+    // Solo se reinicia el periférico: medidas, histórico, snapshots y sesiones siguen intactos
+    Wire.end();
+    const bool ok = startWire();
+    const int64_t endUs = localMicros();
+    busHealth.lastReinitUs = static_cast<uint32_t>(endUs - nowUs);
+    busHealth.recoveries++;
+    busHealth.lastCause = cause;
+    busHealth.state = BUS_RECOVERING;
+    recoverAtUs = endUs;
+    recoverBeats = callbackBeats;
+    callbackEnterUs = 0;
+    lineLowSinceUs = 0;
+    lastBeatUs = 0;           // El silencio solo se vigila de nuevo cuando el maestro vuelva a hablar
+    if (logEnabled(NoiseSensor::LOG_ERROR)) {
+        logPrintf("WARNING: Bus I2C colgado (causa %u, SDA=%u SCL=%u), Wire reiniciado en %lu us%s\n",
+                  cause, busHealth.lines & 0x01, (busHealth.lines >> 1) & 0x01,
+                  static_cast<unsigned long>(busHealth.lastReinitUs), ok ? "" : " con error");
     }
 }
 
 // Callbacks estáticos que redirigen a la instancia (deben ser mínimos)
 void IRAM_ATTR NoiseSensorI2CSlave::onRequestStatic() {
     if (instance != nullptr) {
+        NOISE_TRACE_SCOPE(TRACE_ON_REQUEST);
+        const int64_t start = localMicros();
+        instance->callbackEnterUs = static_cast<uint32_t>(start) | 1;
+        instance->callbackBeats = instance->callbackBeats + 1;
         instance->onRequest();
+        instance->callbackEnterUs = 0;
+        instance->perfStats.countRequest(static_cast<uint32_t>(localMicros() - start));
     }
 }
 
 void IRAM_ATTR NoiseSensorI2CSlave::onReceiveStatic(int numBytes) {
     if (instance != nullptr) {
+        NOISE_TRACE_SCOPE(TRACE_ON_RECEIVE);
+        const int64_t start = localMicros();
+        instance->callbackEnterUs = static_cast<uint32_t>(start) | 1;
+        instance->callbackBeats = instance->callbackBeats + 1;
         instance->onReceive(numBytes);
+        instance->callbackEnterUs = 0;
+        instance->perfStats.countReceive(static_cast<uint32_t>(localMicros() - start));
+    }
+}
+
+// ISR de la línea de latch: solo marca la petición, la copia se hace en update()
+void IRAM_ATTR NoiseSensorI2CSlave::onLatchStatic() {
+    if (instance != nullptr) {
+        instance->latchRequestMicros = localMicros();
+        instance->pendingLatch = true;
     }
 }
 
 // Implementación de los callbacks
 void NoiseSensorI2CSlave::onRequest() {
     // IMPORTANTE (ESP32-C3): onRequest() debe escribir SIEMPRE al menos 1 byte
-    if (!initialized) {
-        uint8_t zero = 0x00;
-        Wire.write(&zero, 1);
-        return;
+    size_t len = 0;
+    if (serving) {
+        CommandLock lock;
+        len = buildResponse(i2cState, i2cState.lastCommand, responseBuffer);
+    }
+    if (len == 0) {
+        responseBuffer[0] = 0x00;
+        len = 1;
     }
+    Wire.write(responseBuffer, len);
+}
 
-    uint8_t cmd = lastCommand;
+// Tabla de despacho generada en compilación: los comandos desactivados en
+// NOISE_COMMAND_MASK quedan en nullptr y sus manejadores no se enlazan.
+#define NOISE_HANDLER(cmd, fn) (commandEnabled(cmd) ? &NoiseSensorI2CSlave::fn : nullptr)
 
-    switch (cmd) {
-        case CMD_GET_DATA:
-            if (!dataReady) {
-                uint8_t zero = 0x00;
-                Wire.write(&zero, 1);
-                return;
-            }
-            Wire.write((uint8_t*)&sensorData, sizeof(sensorData));
-            return;
+const NoiseSensorI2CSlave::ResponseHandler NoiseSensorI2CSlave::responseHandlers[COMMAND_TABLE_SIZE] = {
+    nullptr,                                            // 0x00
+    NOISE_HANDLER(CMD_GET_DATA, respondData),           // 0x01
+    NOISE_HANDLER(CMD_GET_AVG, respondAvg),             // 0x02
+    NOISE_HANDLER(CMD_GET_PEAK, respondPeak),           // 0x03
+    NOISE_HANDLER(CMD_GET_MIN, respondMin),             // 0x04
+    NOISE_HANDLER(CMD_GET_LEGAL, respondLegal),         // 0x05
+    NOISE_HANDLER(CMD_GET_LEGAL_MAX, respondLegalMax),  // 0x06
+    NOISE_HANDLER(CMD_GET_STATUS, respondStatus),       // 0x07
+    nullptr,                                            // 0x08 CMD_RESET (solo escritura)
+    NOISE_HANDLER(CMD_IDENTIFY, respondIdentity),       // 0x09 CMD_PING / CMD_IDENTIFY
+    NOISE_HANDLER(CMD_GET_READY, respondReady),         // 0x0A
+    nullptr,                                            // 0x0B CMD_LATCH (solo escritura)
+    NOISE_HANDLER(CMD_GET_SNAPSHOT, respondSnapshot),   // 0x0C
+    nullptr,                                            // 0x0D CMD_TIME_SYNC (solo escritura)
+    NOISE_HANDLER(CMD_GET_TIME, respondTime),           // 0x0E
+    NOISE_HANDLER(CMD_GET_HISTORY, respondHistory),     // 0x0F
+#if NOISE_FIXED_POINT
+    NOISE_HANDLER(CMD_GET_DATA_FIXED, respondDataFixed), // 0x10
+#else
+    nullptr,                                            // 0x10 CMD_GET_DATA_FIXED
+#endif
+    NOISE_HANDLER(CMD_GET_HEAP, respondHeap),           // 0x11
+    NOISE_HANDLER(CMD_GET_STATS, respondStats),         // 0x12
+    NOISE_HANDLER(CMD_GET_JITTER, respondJitter),       // 0x13
+    nullptr,                                            // 0x14 CMD_CAPTURE_START (solo escritura)
+#if NOISE_CAPTURE_SAMPLES
+    NOISE_HANDLER(CMD_GET_CAPTURE_STATUS, respondCaptureStatus), // 0x15
+    NOISE_HANDLER(CMD_GET_CAPTURE_CHUNK, respondCaptureChunk),   // 0x16
+#else
+    nullptr,                                            // 0x15 CMD_GET_CAPTURE_STATUS
+    nullptr,                                            // 0x16 CMD_GET_CAPTURE_CHUNK
+#endif
+    NOISE_HANDLER(CMD_GET_DELTA, respondDelta),         // 0x17
+    NOISE_HANDLER(CMD_GET_WINDOWS, respondWindows),     // 0x18
+#if NOISE_FIXED_POINT
+    NOISE_HANDLER(CMD_GET_WEIGHTED, respondWeighted),   // 0x19
+#else
+    nullptr,                                            // 0x19 CMD_GET_WEIGHTED
+#endif
+    nullptr,                                            // 0x1A CMD_LOG_SEEK (solo escritura)
+#if NOISE_FLASH_LOG
+    NOISE_HANDLER(CMD_LOG_READ, respondLogRead),        // 0x1B
+    NOISE_HANDLER(CMD_GET_LOG_STATUS, respondLogStatus),// 0x1C
+#else
+    nullptr,                                            // 0x1B CMD_LOG_READ
+    nullptr,                                            // 0x1C CMD_GET_LOG_STATUS
+#endif
+#if NOISE_HUB
+    NOISE_HANDLER(CMD_HUB_MAP, respondHubMap),          // 0x1D
+    NOISE_HANDLER(CMD_HUB_HISTORY, respondHubHistory),  // 0x1E
+#else
+    nullptr,                                            // 0x1D CMD_HUB_MAP
+    nullptr,                                            // 0x1E CMD_HUB_HISTORY
+#endif
+#if NOISE_TRACE
+    NOISE_HANDLER(CMD_TRACE_READ, respondTraceRead),    // 0x1F
+#else
+    nullptr,                                            // 0x1F CMD_TRACE_READ
+#endif
+    nullptr,                                            // 0x20 CMD_SUBSCRIBE (solo escritura)
+    NOISE_HANDLER(CMD_GET_SUBSCRIPTION, respondSubscription), // 0x21
+    NOISE_HANDLER(CMD_GET_BUS_HEALTH, respondBusHealth), // 0x22
+#if NOISE_STREAM
+    NOISE_HANDLER(CMD_GET_STREAM_STATS, respondStreamStats) // 0x23
+#else
+    nullptr                                             // 0x23 CMD_GET_STREAM_STATS
+#endif
+};
 
-        case CMD_GET_AVG:
-            Wire.write((uint8_t*)&sensorData.noiseAvg, sizeof(float));
-            return;
+#undef NOISE_HANDLER
 
-        case CMD_GET_PEAK:
-            Wire.write((uint8_t*)&sensorData.noisePeak, sizeof(float));
-            return;
+size_t NoiseSensorI2CSlave::buildResponse(TransportState& state, uint8_t cmd, uint8_t* out) {
+    const ResponseHandler handler = (cmd < COMMAND_TABLE_SIZE) ? responseHandlers[cmd] : nullptr;
+    if (handler == nullptr) {
+        perfStats.countUnknownCommand();
+        return 0;
+    }
+    const size_t len = (this->*handler)(state, out);
+    if (len == 0) {
+        perfStats.countNotReady();
+    }
+    return len;
+}
 
-        case CMD_GET_MIN:
-            Wire.write((uint8_t*)&sensorData.noiseMin, sizeof(float));
-            return;
+// Manejadores de respuesta: escriben en out y devuelven la longitud (0 = responder 0x00)
+size_t NoiseSensorI2CSlave::respondData(TransportState&, uint8_t* out) {
+    return dataReady ? respondWith(out, sensorData) : 0;
+}
 
-        case CMD_GET_LEGAL:
-            Wire.write((uint8_t*)&sensorData.noiseAvgLegal, sizeof(float));
-            return;
+size_t NoiseSensorI2CSlave::respondAvg(TransportState&, uint8_t* out) {
+    return respondWith(out, sensorData.noiseAvg);
+}
 
-        case CMD_GET_LEGAL_MAX:
-            Wire.write((uint8_t*)&sensorData.noiseAvgLegalMax, sizeof(float));
-            return;
+size_t NoiseSensorI2CSlave::respondPeak(TransportState&, uint8_t* out) {
+    return respondWith(out, sensorData.noisePeak);
+}
 
-        case CMD_GET_STATUS: {
-            uint8_t status = dataReady ? 0x01 : 0x00;
-            Wire.write(&status, 1);
-            return;
-        }
+size_t NoiseSensorI2CSlave::respondMin(TransportState&, uint8_t* out) {
+    return respondWith(out, sensorData.noiseMin);
+}
 
-        case CMD_GET_READY: {
-            uint8_t ready = isReady() ? 0x01 : 0x00;
-            Wire.write(&ready, 1);
-            return;
-        }
+size_t NoiseSensorI2CSlave::respondLegal(TransportState&, uint8_t* out) {
+    return respondWith(out, sensorData.noiseAvgLegal);
+}
+
+size_t NoiseSensorI2CSlave::respondLegalMax(TransportState&, uint8_t* out) {
+    return respondWith(out, sensorData.noiseAvgLegalMax);
+}
 
-        case CMD_PING: // CMD_PING y CMD_IDENTIFY comparten valor (0x09)
-        /* case CMD_IDENTIFY: */ {
-            SensorIdentity identity;
-            identity.sensorType = SENSOR_TYPE_NOISE;
-            identity.versionMajor = VERSION_MAJOR;
-            identity.versionMinor = VERSION_MINOR;
-            identity.status = 0;
-            if (initialized) identity.status |= 0x01;
-            if (adcActive) identity.status |= 0x02;
-            if (dataReady) identity.status |= 0x04;
-            identity.i2cAddress = config.i2cAddress;
-            Wire.write((uint8_t*)&identity, sizeof(identity));
+size_t NoiseSensorI2CSlave::respondStatus(TransportState&, uint8_t* out) {
+    out[0] = dataReady ? 0x01 : 0x00;
+    return 1;
+}
+
+size_t NoiseSensorI2CSlave::respondReady(TransportState&, uint8_t* out) {
+    out[0] = isReady() ? 0x01 : 0x00;
+    return 1;
+}
+
+size_t NoiseSensorI2CSlave::respondIdentity(TransportState&, uint8_t* out) {
+    SensorIdentity identity;
+    identity.sensorType = SENSOR_TYPE_NOISE;
+    identity.versionMajor = VERSION_MAJOR;
+    identity.versionMinor = VERSION_MINOR;
+    identity.status = 0;
+    if (initialized) identity.status |= 0x01;
+    if (adcActive) identity.status |= 0x02;
+    if (dataReady) identity.status |= 0x04;
+    if (snapshotReady) identity.status |= 0x08;
+    if (timeSync.isSynced()) identity.status |= 0x10;
+    if (serving && !dataReady) identity.status |= 0x20;
+    if (NOISE_FIXED_POINT) identity.status |= 0x40;
+    identity.i2cAddress = config.i2cAddress;
+    return respondWith(out, identity);
+}
+
+size_t NoiseSensorI2CSlave::respondSnapshot(TransportState&, uint8_t* out) {
+    return snapshotReady ? respondWith(out, snapshot) : 0;
+}
+
+size_t NoiseSensorI2CSlave::respondTime(TransportState&, uint8_t* out) {
+    TimeSyncStatus ts;
+    ts.now = getTimestamp();
+    ts.offsetUs = timeSync.getOffsetUs();
+    ts.driftPpb = timeSync.getDriftPpb();
+    ts.syncCount = timeSync.getSyncCount();
+    return respondWith(out, ts);
+}
+
+size_t NoiseSensorI2CSlave::respondHistory(TransportState& state, uint8_t* out) {
+    SensorData record;
+    return getHistory(state.historyRequestIndex, record) ? respondWith(out, record) : 0;
+}
+
+size_t NoiseSensorI2CSlave::respondHeap(TransportState&, uint8_t* out) {
+    return respondWith(out, heapReport());
+}
+
+size_t NoiseSensorI2CSlave::respondStats(TransportState&, uint8_t* out) {
+    return respondWith(out, perfStats.report());
+}
+
+size_t NoiseSensorI2CSlave::respondJitter(TransportState&, uint8_t* out) {
+    return respondWith(out, scheduler.getHistogram());
+}
+
+size_t NoiseSensorI2CSlave::respondDelta(TransportState& state, uint8_t* out) {
+    return dataReady ? deltaSessions[state.deltaSessionIndex].encode(sensorData, out) : 0;
+}
+
+size_t NoiseSensorI2CSlave::respondWindows(TransportState&, uint8_t* out) {
+    return respondWith(out, windowExtremes);
+}
+
+size_t NoiseSensorI2CSlave::respondSubscription(TransportState&, uint8_t* out) {
+    return respondWith(out, getSubscriptionStatus());
+}
+
+size_t NoiseSensorI2CSlave::respondBusHealth(TransportState&, uint8_t* out) {
+    return respondWith(out, busHealth);
+}
+
+#if NOISE_STREAM
+size_t NoiseSensorI2CSlave::respondStreamStats(TransportState&, uint8_t* out) {
+    return respondWith(out, stream.getStats());
+}
+
+void NoiseSensorI2CSlave::serviceStream() {
+    // Pocas peticiones por llamada: una ráfaga del maestro no retrasa el plazo de agregación
+    for (uint8_t i = 0; i < NOISE_STREAM_REQUESTS_PER_UPDATE; i++) {
+        const size_t len = stream.poll();
+        if (len == 0) {
             return;
         }
+        const uint8_t* request = stream.request();
+        const uint8_t cmd = request[0];
+        const size_t argCount = (len - 1 > 8) ? 8 : len - 1;
 
-        default: {
-            uint8_t zero = 0x00;
-            Wire.write(&zero, 1);
-            return;
+        // Mismo contenido que la lectura I2C, precedido del comando; escrito en la trama de salida.
+        // Petición y respuesta juntas con los cursores de streamState: un comando I2C no los cambia
+        uint8_t* out = stream.payload();
+        out[0] = cmd;
+        size_t respLen;
+        {
+            CommandLock lock;
+            handleCommand(streamState, cmd, request + 1, argCount, localMicros());
+            respLen = buildResponse(streamState, cmd, out + 1);
         }
+        if (respLen == 0) {
+            out[1] = 0x00;
+            respLen = 1;
+        }
+        stream.send(STREAM_RESPONSE, stream.requestSequence(), 1 + respLen);
     }
 }
 
+void NoiseSensorI2CSlave::pushRecord() {
+    if (!stream.isActive() || !config.streamRecords) {
+        return;
+    }
+    const uint8_t sequence = stream.nextRecordSequence();
+    stream.send(STREAM_RECORD, sequence, respondWith(stream.payload(), sensorData));
+#if NOISE_FIXED_POINT
+    stream.send(STREAM_RECORD_FIXED, sequence, respondWith(stream.payload(), sensorDataFixed));
+#endif
+    stream.countRecord();
+}
+#endif
+
+#if NOISE_FIXED_POINT
+size_t NoiseSensorI2CSlave::respondDataFixed(TransportState&, uint8_t* out) {
+    return dataReady ? respondWith(out, sensorDataFixed) : 0;
+}
+
+size_t NoiseSensorI2CSlave::respondWeighted(TransportState&, uint8_t* out) {
+    return dataReady ? respondWith(out, weightedLevels) : 0;
+}
+#endif
+
+#if NOISE_CAPTURE_SAMPLES
+size_t NoiseSensorI2CSlave::respondCaptureStatus(TransportState&, uint8_t* out) {
+    return respondWith(out, capture.status());
+}
+
+size_t NoiseSensorI2CSlave::respondCaptureChunk(TransportState& state, uint8_t* out) {
+    const uint32_t offset = state.captureOffset;
+    const size_t len = capture.readChunk(offset, out, localMicros());
+    if (len > sizeof(CaptureChunkHeader)) {
+        // Lectura secuencial: la siguiente petición sin offset continúa tras este bloque
+        state.captureOffset = offset + static_cast<uint32_t>(len - sizeof(CaptureChunkHeader));
+    }
+    return len;
+}
+#endif
+
+#if NOISE_FLASH_LOG
+size_t NoiseSensorI2CSlave::respondLogRead(TransportState& state, uint8_t* out) {
+    // Cada trama se entrega una vez: update() prepara la siguiente de este transporte
+    state.logActive = true;
+    const uint8_t len = state.logFrameLength;
+    if (len == 0) {
+        return 0;
+    }
+    memcpy(out, state.logFrame, len);
+    state.logFrameLength = 0;
+    return len;
+}
+
+size_t NoiseSensorI2CSlave::respondLogStatus(TransportState&, uint8_t* out) {
+    return respondWith(out, getLogStatus());
+}
+#endif
+
+#if NOISE_HUB
+size_t NoiseSensorI2CSlave::respondHubMap(TransportState& state, uint8_t* out) {
+    if (hub == nullptr) {
+        return 0;
+    }
+    const uint16_t offset = state.hubMapOffset;
+    const size_t len = hub->readMapChunk(offset, out, localMicros());
+    if (len > sizeof(HubChunkHeader)) {
+        // Lectura secuencial: la siguiente petición sin offset continúa tras este bloque
+        state.hubMapOffset = static_cast<uint16_t>(offset + (len - sizeof(HubChunkHeader)));
+    }
+    return len;
+}
+
+size_t NoiseSensorI2CSlave::respondHubHistory(TransportState& state, uint8_t* out) {
+    SensorData record;
+    if (hub == nullptr || !hub->getHistory(state.hubLeafIndex, state.hubHistoryIndex, record)) {
+        return 0;
+    }
+    return respondWith(out, record);
+}
+#endif
+
+#if NOISE_TRACE
+size_t NoiseSensorI2CSlave::respondTraceRead(TransportState& state, uint8_t* out) {
+    // Un núcleo por respuesta; se pasa al siguiente cuando el actual queda vacío
+    TraceChunkHeader header;
+    uint32_t lost;
+    TraceEvent* events = reinterpret_cast<TraceEvent*>(out + sizeof(header));
+    const size_t n = traceRead(state.traceReadCore, events, TRACE_CHUNK_EVENTS, lost);
+    header.core = state.traceReadCore;
+    header.count = static_cast<uint8_t>(n);
+    header.lost = static_cast<uint16_t>(lost > 0xFFFF ? 0xFFFF : lost);
+    header.cpuMhz = static_cast<uint16_t>(getCpuFrequencyMhz());
+    header.reserved = 0;
+    memcpy(out, &header, sizeof(header));
+    if (n < TRACE_CHUNK_EVENTS) {
+        state.traceReadCore = static_cast<uint8_t>((state.traceReadCore + 1) % TRACE_CORES);
+    }
+    return sizeof(header) + n * sizeof(TraceEvent);
+}
+#endif
+
 void NoiseSensorI2CSlave::onReceive(int numBytes) {
+    // Capturar el tiempo local cuanto antes: es la referencia de CMD_TIME_SYNC
+    const int64_t rxMicros = localMicros();
+
     if (numBytes <= 0) {
         return;
     }
@@ -290,38 +1342,458 @@ void NoiseSensorI2CSlave::onReceive(int numBytes) {
         return;
     }
 
-    lastCommand = static_cast<uint8_t>(cmd);
+    i2cState.lastCommand = static_cast<uint8_t>(cmd);
 
+    // Argumentos opcionales tras el byte de comando (el resto se descarta)
+    uint8_t args[8];
+    size_t argCount = 0;
     while (Wire.available()) {
-        (void)Wire.read();
+        int b = Wire.read();
+        if (b >= 0 && argCount < sizeof(args)) {
+            args[argCount++] = static_cast<uint8_t>(b);
+        }
+    }
+
+    CommandLock lock;
+    handleCommand(i2cState, i2cState.lastCommand, args, argCount, rxMicros);
+}
+
+void NoiseSensorI2CSlave::handleCommand(TransportState& state, uint8_t cmd, const uint8_t* args, size_t argCount,
+                                        int64_t rxMicros) {
+    // Las lecturas de etapas costosas cuentan como suscripción implícita (ver refreshSubscriptions)
+    if (cmd == CMD_GET_WINDOWS || cmd == CMD_GET_WEIGHTED) {
+        uint32_t nowMs = static_cast<uint32_t>(rxMicros / 1000);
+        nowMs = nowMs ? nowMs : 1;
+        if (cmd == CMD_GET_WINDOWS) {
+            windowsRequestMs = nowMs;
+        } else {
+            weightedRequestMs = nowMs;
+        }
     }
 
-    if (lastCommand == CMD_RESET) {
+    if (cmd == CMD_RESET && commandEnabled(CMD_RESET)) {
         pendingReset = true;
+    } else if (cmd == CMD_LATCH && commandEnabled(CMD_LATCH)) {
+        latchRequestMicros = rxMicros;
+        pendingLatch = true;
+    } else if (cmd == CMD_TIME_SYNC && commandEnabled(CMD_TIME_SYNC)) {
+        if (argCount == sizeof(uint64_t)) {
+            uint64_t masterUs;
+            memcpy(&masterUs, args, sizeof(masterUs));
+            syncMasterUs = masterUs;
+            syncLocalUs = rxMicros;
+            pendingTimeSync = true;
+        }
+    } else if (cmd == CMD_GET_HISTORY && commandEnabled(CMD_GET_HISTORY)) {
+        state.historyRequestIndex = (argCount > 0) ? args[0] : 0;
+    } else if (cmd == CMD_GET_DELTA && commandEnabled(CMD_GET_DELTA)) {
+        const uint8_t arg = (argCount > 0) ? args[0] : 0;
+        const uint8_t session = arg & 0x7F;
+        state.deltaSessionIndex = (session < NOISE_DELTA_SESSIONS) ? session : 0;
+        if (arg & 0x80) {
+            deltaSessions[state.deltaSessionIndex].reset();
+        } else {
+            // Segundo byte: secuencia de la última trama recibida (confirma su línea base)
+            deltaSessions[state.deltaSessionIndex].acknowledge((argCount > 1) ? args[1] : 0);
+        }
+    } else if (cmd == CMD_SUBSCRIBE && commandEnabled(CMD_SUBSCRIBE)) {
+        uint32_t mask = 0;
+        if (argCount >= sizeof(uint32_t)) {
+            memcpy(&mask, args, sizeof(mask));
+        }
+        requestedSubscriptions = mask;
+    }
+#if NOISE_CAPTURE_SAMPLES
+    else if (cmd == CMD_CAPTURE_START && commandEnabled(CMD_CAPTURE_START)) {
+        if (argCount >= sizeof(uint16_t)) {
+            uint16_t durationMs;
+            memcpy(&durationMs, args, sizeof(durationMs));
+            pendingCaptureMs = durationMs;
+        }
+    } else if (cmd == CMD_GET_CAPTURE_CHUNK && commandEnabled(CMD_GET_CAPTURE_CHUNK)) {
+        if (argCount >= sizeof(uint32_t)) {
+            uint32_t offset;
+            memcpy(&offset, args, sizeof(offset));
+            state.captureOffset = offset;
+        }
+    }
+#endif
+#if NOISE_FLASH_LOG
+    else if (cmd == CMD_LOG_SEEK && commandEnabled(CMD_LOG_SEEK)) {
+        // La búsqueda lee flash: se hace en update(); hasta entonces CMD_LOG_READ responde 0x00
+        if (argCount >= sizeof(uint64_t)) {
+            uint64_t timestamp;
+            memcpy(&timestamp, args, sizeof(timestamp));
+            state.logSeekTimestamp = timestamp;
+            state.pendingLogSeek = LOG_SEEK_TIME;
+        } else if (argCount >= sizeof(uint32_t)) {
+            uint32_t cursor;
+            memcpy(&cursor, args, sizeof(cursor));
+            state.logSeekCursor = cursor;
+            state.pendingLogSeek = LOG_SEEK_CURSOR;
+        } else {
+            state.pendingLogSeek = LOG_SEEK_OLDEST;
+        }
+        state.logFrameLength = 0;
+        state.logActive = true;
+    }
+#endif
+#if NOISE_HUB
+    else if (cmd == CMD_HUB_MAP && commandEnabled(CMD_HUB_MAP)) {
+        if (argCount >= sizeof(uint16_t)) {
+            uint16_t offset;
+            memcpy(&offset, args, sizeof(offset));
+            state.hubMapOffset = offset;
+        }
+    } else if (cmd == CMD_HUB_HISTORY && commandEnabled(CMD_HUB_HISTORY)) {
+        state.hubLeafIndex = (argCount > 0) ? args[0] : 0;
+        state.hubHistoryIndex = (argCount > 1) ? args[1] : 0;
+    }
+#endif
+}
+
+void NoiseSensorI2CSlave::requestLatch() {
+    latchRequestMicros = localMicros();
+    pendingLatch = true;
+}
+
+#if NOISE_CAPTURE_SAMPLES
+void NoiseSensorI2CSlave::startCapture(uint16_t durationMs) {
+    pendingCaptureMs = durationMs;
+}
+
+size_t NoiseSensorI2CSlave::exportCaptureTrace(Print& out) const {
+    const CaptureStatus status = capture.status();
+    if (!capture.isReady() || status.sampleRateHz == 0) {
+        return 0;
+    }
+
+    TraceHeader header;
+    header.magic = TRACE_MAGIC;
+    header.version = TRACE_VERSION;
+    header.flags = TRACE_FLAG_FIXED_RATE;
+    header.reserved = 0;
+    header.sampleRateHz = status.sampleRateHz;
+    header.sampleCount = status.samples;
+    header.startUs = capture.getStartUs();
+
+    size_t written = out.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+    written += out.write(reinterpret_cast<const uint8_t*>(capture.getSamples()), status.samples * sizeof(int16_t));
+    return written;
+}
+#endif
+
+#if NOISE_FLASH_LOG
+void NoiseSensorI2CSlave::appendLog() {
+    if (!flashLog.isReady()) {
+        return;
+    }
+    NOISE_TRACE_SCOPE(TRACE_LOG_APPEND);
+    // Solo cuenta como escritura la llamada que vuelca una página (borrado de sector incluido)
+    const uint32_t before = flashLog.getPagesWritten() + flashLog.getWriteErrors();
+    const int64_t start = localMicros();
+    flashLog.append(sensorData);
+    if (flashLog.getPagesWritten() + flashLog.getWriteErrors() != before) {
+        const uint32_t us = static_cast<uint32_t>(localMicros() - start);
+        logWriteUs += us;
+        if (us > logMaxWriteUs) {
+            logMaxWriteUs = us;
+        }
+    }
+}
+
+void NoiseSensorI2CSlave::serviceLogReader() {
+    if (!flashLog.isReady()) {
+        return;
+    }
+    serviceLogFrame(i2cState);
+#if NOISE_STREAM
+    serviceLogFrame(streamState);
+#endif
+}
+
+void NoiseSensorI2CSlave::serviceLogFrame(TransportState& state) {
+    const uint8_t seek = state.pendingLogSeek;
+    if (seek != LOG_SEEK_NONE) {
+        state.pendingLogSeek = LOG_SEEK_NONE;
+        if (seek == LOG_SEEK_TIME) {
+            flashLog.seekTime(state.logSeekTimestamp);
+        } else if (seek == LOG_SEEK_CURSOR) {
+            flashLog.seekCursor(state.logSeekCursor);
+        } else {
+            flashLog.seekOldest();
+        }
+        logReader = &state;
+        state.logResumeValid = false;
+        state.logFrameLength = 0;
+    }
+    if (!state.logActive || state.logFrameLength != 0) {
+        return;  // Sin lector, o la trama anterior no se ha leído
+    }
+    if (logReader != &state) {
+        // El otro transporte movió la posición de lectura: retomar tras lo último entregado
+        if (state.logResumeValid) {
+            flashLog.seekCursor(state.logResumeCursor);
+        } else {
+            flashLog.seekOldest();
+        }
+        logReader = &state;
+    }
+
+    SensorData record;
+    uint32_t cursor;
+    if (flashLog.next(record, cursor)) {
+        state.logResumeCursor = cursor + 1;
+        state.logResumeValid = true;
+        state.logFrame[0] = LOG_RECORD;
+        memcpy(&state.logFrame[1], &cursor, sizeof(cursor));
+        memcpy(&state.logFrame[1 + sizeof(cursor)], &record, sizeof(record));
+        state.logFrameLength = LOG_FRAME_BYTES;
+    } else {
+        state.logFrame[0] = LOG_END;
+        state.logFrameLength = 1;
+    }
+}
+
+bool NoiseSensorI2CSlave::flushLog() {
+    if (!flashLog.isReady()) {
+        return false;
+    }
+    const int64_t start = localMicros();
+    const bool ok = flashLog.flush();
+    const uint32_t us = static_cast<uint32_t>(localMicros() - start);
+    logWriteUs += us;
+    if (us > logMaxWriteUs) {
+        logMaxWriteUs = us;
+    }
+    return ok;
+}
+
+LogStatus NoiseSensorI2CSlave::getLogStatus() const {
+    LogStatus status;
+    status.oldestCursor = flashLog.getOldestCursor();
+    status.nextCursor = flashLog.getNextCursor();
+    status.capacityBytes = flashLog.getCapacityBytes();
+    status.pagesWritten = flashLog.getPagesWritten();
+    status.rawBytes = flashLog.getRawBytes();
+    status.storedBytes = flashLog.getStoredBytes();
+    status.writeErrors = flashLog.getWriteErrors();
+    status.maxWriteUs = logMaxWriteUs;
+    status.throughputBps = logWriteUs > 0
+        ? static_cast<uint32_t>(static_cast<uint64_t>(status.storedBytes) * 1000000ULL / logWriteUs)
+        : 0;
+    return status;
+}
+#endif
+
+void NoiseSensorI2CSlave::syncTime(uint64_t masterUs) {
+    timeSync.sync(masterUs, localMicros());
+}
+
+uint64_t NoiseSensorI2CSlave::getTimestamp() const {
+    return timeSync.toMaster(localMicros());
+}
+
+bool NoiseSensorI2CSlave::getHistory(uint8_t index, SensorData& out) const {
+    if (index >= historyCount) {
+        return false;
+    }
+    // historyHead apunta a la siguiente posición libre; el más reciente está justo detrás
+    const uint8_t pos = static_cast<uint8_t>((historyHead + HISTORY_LENGTH - 1 - index) % HISTORY_LENGTH);
+    out = history[pos];
+    return true;
+}
+
+SubscriptionStatus NoiseSensorI2CSlave::getSubscriptionStatus() const {
+    SubscriptionStatus status;
+    status.requested = requestedSubscriptions;
+    status.inferred = inferredSubscriptions;
+    status.active = activeSubscriptions;
+    status.skipped = skippedWindowUpdates;
+#if NOISE_FIXED_POINT
+    status.skipped += pipeline.getSkipped();
+#endif
+    return status;
+}
+
+void NoiseSensorI2CSlave::pushHistory(const SensorData& record) {
+    history[historyHead] = record;
+    historyHead = static_cast<uint8_t>((historyHead + 1) % HISTORY_LENGTH);
+    if (historyCount < HISTORY_LENGTH) {
+        historyCount++;
+    }
+}
+
+void NoiseSensorI2CSlave::latchSnapshot() {
+    const int64_t latchMicros = latchRequestMicros;
+    const int64_t nowMicros = localMicros();
+#if NOISE_FIXED_POINT
+    flushPendingSamples();
+#endif
+    fillSensorData(snapshot.data, latchMicros);
+    snapshot.sequence++;
+    snapshot.latchDelayUs = static_cast<uint32_t>(nowMicros - latchMicros);
+    snapshotReady = true;
+}
+
+HeapReport NoiseSensorI2CSlave::heapReport() const {
+    HeapReport report;
+#if defined(ARDUINO_ARCH_ESP32)
+    report.freeNow = ESP.getFreeHeap();
+    report.largestFreeBlock = ESP.getMaxAllocHeap();
+#else
+    report.freeNow = 0;
+    report.largestFreeBlock = 0;
+#endif
+    report.freeAtBegin = heapFreeAtBegin;
+    report.minFreeSinceBegin = heapMinFreeSinceBegin;
+    return report;
+}
+
+void NoiseSensorI2CSlave::sampleHeap() {
+    const uint32_t freeNow = heapReport().freeNow;
+    if (freeNow < heapMinFreeSinceBegin) {
+        heapMinFreeSinceBegin = freeNow;
+    }
+}
+
+void NoiseSensorI2CSlave::printStats() const {
+    const PerfStatsReport r = perfStats.report();
+    logPrintf("=== Rendimiento ===\n");
+    logPrintf("onRequest: %lu (máx %lu us), onReceive: %lu (máx %lu us)\n",
+              static_cast<unsigned long>(r.requests), static_cast<unsigned long>(r.requestMaxUs),
+              static_cast<unsigned long>(r.receives), static_cast<unsigned long>(r.receiveMaxUs));
+    logPrintf("Comandos desconocidos: %lu, respuestas no listas: %lu\n",
+              static_cast<unsigned long>(r.unknownCommands), static_cast<unsigned long>(r.notReady));
+    logPrintf("Periodo de loop: mín %lu us, máx %lu us\n",
+              static_cast<unsigned long>(r.loopMinUs), static_cast<unsigned long>(r.loopMaxUs));
+    logPrintf("Intervalos tardíos: %lu (máx %lu us)\n",
+              static_cast<unsigned long>(r.lateUpdates), static_cast<unsigned long>(r.maxLateUs));
+    logPrintf("Agregación: última %lu us, máx %lu us\n",
+              static_cast<unsigned long>(r.aggregationLastUs), static_cast<unsigned long>(r.aggregationMaxUs));
+    logPrintf("Verificaciones ADC: %lu (máx %lu us)\n",
+              static_cast<unsigned long>(r.adcChecks), static_cast<unsigned long>(r.adcCheckMaxUs));
+
+    const JitterHistogram& h = scheduler.getHistogram();
+    logPrintf("Intervalos: %lu, saltados: %lu, jitter máx %lu us\n",
+              static_cast<unsigned long>(h.intervals), static_cast<unsigned long>(h.skipped),
+              static_cast<unsigned long>(h.maxJitterUs));
+    uint32_t limit = JITTER_FIRST_BUCKET_US;
+    for (uint8_t i = 0; i < JITTER_BUCKETS; i++) {
+        if (i < JITTER_BUCKETS - 1) {
+            logPrintf("  < %lu us: %lu\n", static_cast<unsigned long>(limit), static_cast<unsigned long>(h.buckets[i]));
+        } else {
+            logPrintf("  >= %lu us: %lu\n", static_cast<unsigned long>(limit >> 1), static_cast<unsigned long>(h.buckets[i]));
+        }
+        limit <<= 1;
+    }
+}
+
+void NoiseSensorI2CSlave::logPrintf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    const int len = vsnprintf(logBuffer, sizeof(logBuffer), format, args);
+    va_end(args);
+    if (len > 0) {
+        // Si no cabe, se trunca en lugar de reservar memoria
+        const size_t n = (static_cast<size_t>(len) < sizeof(logBuffer)) ? static_cast<size_t>(len) : sizeof(logBuffer) - 1;
+        Serial.write(reinterpret_cast<const uint8_t*>(logBuffer), n);
     }
 }
 
+const char* NoiseSensorI2CSlave::formatFloat2(float value, char* buf, size_t len) {
+    // Sin %f: el dtoa de newlib reserva heap para sus enteros grandes
+    const bool negative = value < 0.0f;
+    const uint32_t centis = static_cast<uint32_t>((negative ? -value : value) * 100.0f + 0.5f);
+    snprintf(buf, len, "%s%lu.%02lu", negative ? "-" : "",
+             static_cast<unsigned long>(centis / 100), static_cast<unsigned long>(centis % 100));
+    return buf;
+}
+
+NoiseSensor::Config NoiseSensorI2CSlave::toNoiseConfig(const Config& cfg) {
+    NoiseSensor::Config noiseConfig;
+    noiseConfig.adcPin = cfg.adcPin;
+    noiseConfig.logLevel = cfg.logLevel;
+    return noiseConfig;
+}
+
+int64_t IRAM_ATTR NoiseSensorI2CSlave::localMicros() {
+#if NOISE_REPLAY
+    if (replaySource != nullptr) {
+        return replaySource->getTimeUs();
+    }
+#endif
+#if defined(ARDUINO_ARCH_ESP32)
+    return esp_timer_get_time();
+#else
+    return static_cast<int64_t>(micros());
+#endif
+}
+
+int NoiseSensorI2CSlave::readAdcRaw() const {
+#if NOISE_REPLAY
+    if (replaySource != nullptr) {
+        return replaySource->getSample();
+    }
+#endif
+    return analogRead(config.adcPin);
+}
+
+#if NOISE_FIXED_POINT
+int32_t NoiseSensorI2CSlave::readAdcMilliVolts() const {
+    // Conversión calibrada por tabla (también para las muestras reproducidas)
+    return calibration.toMilliVolts(readAdcRaw());
+}
+#endif
+
+void NoiseSensorI2CSlave::fillSensorData(SensorData& out, int64_t localUs) const {
+#if NOISE_FIXED_POINT
+    // Mismo significado por campo que NoiseSensor::getMeasurements(), desde los acumuladores
+    // enteros del ciclo. Solo la conversión final a float, una vez por registro.
+    const LevelStats& cycle = fixedCycle.getSamples();
+    out.noise = static_cast<float>(fixedStats.getLast());
+    out.noiseAvg = static_cast<float>(cycle.getMean());
+    out.noisePeak = static_cast<float>(cycle.getMax());
+    out.noiseMin = static_cast<float>(cycle.getMin());
+    out.noiseAvgLegal = static_cast<float>(fixedCycle.getLegal());
+    out.noiseAvgLegalMax = static_cast<float>(fixedCycle.getLegalMax());
+    const uint32_t lowMv = fixedCycle.getLegalMin();
+    out.lowNoiseLevel = static_cast<uint16_t>(lowMv > UINT16_MAX ? UINT16_MAX : lowMv);
+    out.cycles = fixedCycle.getCycles();
+#else
+    const auto& measurements = noiseSensor.getMeasurements();
+
+    out.noise = measurements.noise;
+    out.noiseAvg = measurements.noiseAvg;
+    out.noisePeak = measurements.noisePeak;
+    out.noiseMin = measurements.noiseMin;
+    out.noiseAvgLegal = measurements.noiseAvgLegal;
+    out.noiseAvgLegalMax = measurements.noiseAvgLegalMax;
+    out.lowNoiseLevel = measurements.lowNoiseLevel;
+    out.cycles = measurements.cycles;
+#endif
+    const unsigned long intervalMs = getUpdateInterval();
+    out.intervalMs = static_cast<uint16_t>(intervalMs > UINT16_MAX ? UINT16_MAX : intervalMs);
+    out.timestamp = timeSync.toMaster(localUs);
+}
+
 bool NoiseSensorI2CSlave::setConfig(const Config& newConfig) {
-    if (initialized) {
-        if (config.logLevel >= NoiseSensor::LOG_ERROR) {
+    if (serving) {
+        if (logEnabled(NoiseSensor::LOG_ERROR)) {
             Serial.println("ERROR: No se puede cambiar la configuración después de begin().");
         }
         return false;
     }
 
     if (!validateConfig(newConfig)) {
-        if (config.logLevel >= NoiseSensor::LOG_ERROR) {
+        if (logEnabled(NoiseSensor::LOG_ERROR)) {
             Serial.println("ERROR: Configuración inválida, no se aplicó.");
         }
         return false;
     }
 
     config = newConfig;
-
-    NoiseSensor::Config noiseConfig;
-    noiseConfig.adcPin = config.adcPin;
-    noiseConfig.logLevel = config.logLevel;
-    noiseSensor = NoiseSensor(noiseConfig);
+    noiseSensor = NoiseSensor(toNoiseConfig(config));
 
     return true;
 }
@@ -330,38 +1802,87 @@ bool NoiseSensorI2CSlave::isReady() const {
     return initialized && adcActive;
 }
 
-bool NoiseSensorI2CSlave::checkADCSignal() {
-    const auto& measurements = noiseSensor.getMeasurements();
-    
-    const int numSamples = 5;
-    bool hasValidValues = false;
-    
-    for (int i = 0; i < numSamples; i++) {
-        int adcValue = analogRead(config.adcPin);
-        if (adcValue > 0 && adcValue < 4095) {
-            hasValidValues = true;
-        }
-        delay(5);
+void NoiseSensorI2CSlave::startADCCheck(int64_t startUs) {
+    adcCheckRunning = true;
+    adcCheckSignal = false;
+    adcCheckSamples = 0;
+    adcCheckCpuUs = 0;
+    adcCheckNextUs = startUs;
+}
+
+bool NoiseSensorI2CSlave::stepADCCheck(int64_t nowUs) {
+    // Una lectura por llamada, separadas ADC_CHECK_SPACING_US: el loop nunca se bloquea
+    if (!adcCheckRunning || nowUs < adcCheckNextUs) {
+        return false;
     }
-    
-    bool noiseSensorActive = (measurements.noise > 0.0 || 
-                              measurements.noiseAvg > 0.0 ||
-                              measurements.cycles > 0);
-    
-    if (noiseSensorActive) {
-        return true;
+    NOISE_TRACE_SCOPE(TRACE_CHECK_ADC);
+    const int64_t start = localMicros();
+#if NOISE_FIXED_POINT
+    int adcValue;
+    if (adcStream.isRunning()) {
+        // El ADC1 es del DMA: se usa la última muestra drenada (0 si no llegó ningún bloque desde la anterior)
+        adcValue = streamCheckCode;
+        streamCheckCode = 0;
+    } else {
+        adcValue = readAdcRaw();
     }
-    
-    return hasValidValues;
+#else
+    const int adcValue = readAdcRaw();
+#endif
+    if (adcValue > 0 && adcValue < 4095) {
+        adcCheckSignal = true;
+    }
+    adcCheckCpuUs += static_cast<uint32_t>(localMicros() - start);
+    adcCheckNextUs = nowUs + ADC_CHECK_SPACING_US;
+    if (++adcCheckSamples < ADC_CHECK_SAMPLES) {
+        return false;
+    }
+
+#if NOISE_FIXED_POINT
+    if (fixedStats.getLast() > 0 || fixedCycle.getSamples().getMean() > 0 || fixedCycle.getCycles() > 0) {
+        adcCheckSignal = true;
+    }
+#else
+    const auto& measurements = noiseSensor.getMeasurements();
+    if (measurements.noise > 0.0f || measurements.noiseAvg > 0.0f || measurements.cycles > 0) {
+        adcCheckSignal = true;
+    }
+#endif
+    adcCheckRunning = false;
+    perfStats.recordAdcCheck(adcCheckCpuUs);
+    return true;
 }
 
 bool NoiseSensorI2CSlave::validateConfig(const Config& cfg) {
+#if NOISE_ENABLE_VALIDATION
     return (cfg.i2cAddress >= MIN_I2C_ADDRESS && cfg.i2cAddress <= MAX_I2C_ADDRESS) &&
            (cfg.updateInterval >= MIN_UPDATE_INTERVAL) &&
            isValidGpioPin(cfg.sdaPin) &&
            isValidGpioPin(cfg.sclPin) &&
            isValidAdcPin(cfg.adcPin) &&
+           (cfg.latchPin == PIN_DISABLED || isValidGpioPin(cfg.latchPin)) &&
+           (cfg.sampleRateHz == 0 || (cfg.sampleRateHz >= ADC_STREAM_MIN_RATE && cfg.sampleRateHz <= ADC_STREAM_MAX_RATE)) &&
+           (cfg.decimationRatio >= Decimator::MIN_RATIO && cfg.decimationRatio <= Decimator::MAX_RATIO) &&
+           (cfg.adcAttenuation <= 3) &&
+           isValidWindows(cfg) &&
+           isValidTransports(cfg) &&
+           (!cfg.adaptiveInterval ||
+            (cfg.minAdaptiveInterval >= MIN_UPDATE_INTERVAL && cfg.minAdaptiveInterval <= cfg.updateInterval &&
+             cfg.maxAdaptiveInterval >= cfg.updateInterval && cfg.maxAdaptiveInterval <= MAX_ADAPTIVE_INTERVAL &&
+             cfg.quietStdDevMv < cfg.activeStdDevMv)) &&
            (cfg.sdaPin != cfg.sclPin);
+#else
+    (void)cfg;
+    return true;
+#endif
+}
+
+bool NoiseSensorI2CSlave::isValidTransports(const Config& cfg) {
+    if ((cfg.transports & (TRANSPORT_I2C | TRANSPORT_SERIAL)) == 0 ||
+        (cfg.transports & ~(TRANSPORT_I2C | TRANSPORT_SERIAL)) != 0) {
+        return false;
+    }
+    return !(cfg.transports & TRANSPORT_SERIAL) || (NOISE_STREAM && cfg.serialPort != nullptr);
 }
 
 bool NoiseSensorI2CSlave::isValidGpioPin(uint8_t pin) {
@@ -370,6 +1891,7 @@ bool NoiseSensorI2CSlave::isValidGpioPin(uint8_t pin) {
 #elif defined(ARDUINO_ARCH_ESP32) && defined(SOC_GPIO_PIN_COUNT)
     return pin < SOC_GPIO_PIN_COUNT;
 #else
+    (void)pin;
     return true;
 #endif
 }
@@ -379,7 +1901,18 @@ bool NoiseSensorI2CSlave::isValidAdcPin(uint8_t pin) {
     // ESP32-C3 ADC1: GPIO0-4
     return pin <= 4;
 #else
+    (void)pin;
     return true;
 #endif
 }
 
+bool NoiseSensorI2CSlave::isValidWindows(const Config& cfg) {
+    // Al menos 1 ms por sub-bloque
+    for (uint8_t i = 0; i < SLIDING_WINDOW_COUNT; i++) {
+        if (cfg.slidingWindowMs[i] < SLIDING_BUCKETS || cfg.slidingWindowMs[i] > MAX_SLIDING_WINDOW_MS) {
+            return false;
+        }
+    }
+    return true;
+}
+
@@ -3,50 +3,145 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include "I2CProtocol.h"
 #include "NoiseSensor.h"
+#include "TimeSync.h"
+#include "LevelStats.h"
+#include "PerfStats.h"
+#include "DeadlineScheduler.h"
+#include "AdaptiveInterval.h"
+#include "AdcStream.h"
+#include "Decimator.h"
+#include "PcmCapture.h"
+#include "AdcTrace.h"
+#include "DeltaSession.h"
+#include "AdcCalibration.h"
+#include "SlidingExtremes.h"
+#include "TimeWeighting.h"
+#include "FlashLog.h"
+#include "NoiseSensorHub.h"
+#include "BlockPipeline.h"
+#include "HotTrace.h"
+#include "StreamTransport.h"
+
+// Número de registros guardados en el histórico (configurable con -DNOISE_HISTORY_LENGTH=N)
+#ifndef NOISE_HISTORY_LENGTH
+#define NOISE_HISTORY_LENGTH 16
+#endif
+
+// Ruta de procesado en punto fijo (sin float en la adquisición): -DNOISE_FIXED_POINT=1
+#ifndef NOISE_FIXED_POINT
+#define NOISE_FIXED_POINT 0
+#endif
+
+// Selección de funcionalidades en compilación (lo desactivado no se enlaza):
+//   -DNOISE_ENABLE_LOG=0         elimina todo el logging por Serial
+//   -DNOISE_ENABLE_VALIDATION=0  elimina la validación de configuración
+//   -DNOISE_COMMAND_MASK=0x...   bit N = comando N atendido (por defecto todos)
+#ifndef NOISE_ENABLE_LOG
+#define NOISE_ENABLE_LOG 1
+#endif
+
+#ifndef NOISE_ENABLE_VALIDATION
+#define NOISE_ENABLE_VALIDATION 1
+#endif
+
+// Tamaño del buffer estático de logging (las líneas más largas se truncan)
+#ifndef NOISE_LOG_BUFFER_SIZE
+#define NOISE_LOG_BUFFER_SIZE 96
+#endif
+
+// Muestras del buffer de captura cruda (int16_t, estático; 0 = sin captura)
+#ifndef NOISE_CAPTURE_SAMPLES
+#define NOISE_CAPTURE_SAMPLES 4096
+#endif
+
+// Sesiones de maestro con estado delta independiente (CMD_GET_DELTA)
+#ifndef NOISE_DELTA_SESSIONS
+#define NOISE_DELTA_SESSIONS 4
+#endif
+
+// Log persistente de registros en una partición de datos (requiere la partición en la tabla)
+#ifndef NOISE_FLASH_LOG
+#define NOISE_FLASH_LOG 0
+#endif
+
+#ifndef NOISE_LOG_PARTITION
+#define NOISE_LOG_PARTITION "noiselog"
+#endif
+
+// Modo hub: servir el mapa de las hojas de un NoiseSensorHub (attachHub()) con CMD_HUB_MAP
+#ifndef NOISE_HUB
+#define NOISE_HUB 0
+#endif
+
+// Transporte serie binario (UART / USB-CDC) con el protocolo de comandos y registros empujados
+#ifndef NOISE_STREAM
+#define NOISE_STREAM 0
+#endif
+
+// Peticiones por serie atendidas como mucho en cada update()
+#ifndef NOISE_STREAM_REQUESTS_PER_UPDATE
+#define NOISE_STREAM_REQUESTS_PER_UPDATE 4
+#endif
+
+// Reproducción de trazas (build de host): -DNOISE_REPLAY=1 sustituye el reloj y las
+// lecturas del ADC de la librería por una traza (setReplaySource())
+#ifndef NOISE_REPLAY
+#define NOISE_REPLAY 0
+#endif
+
+// Fondo de escala (mV) de la tabla lineal usada si el chip no tiene calibración en eFuse (atenuación 11 dB)
+#ifndef NOISE_ADC_FULL_SCALE_MV
+#define NOISE_ADC_FULL_SCALE_MV 2500
+#endif
+
+#ifndef NOISE_COMMAND_MASK
+#define NOISE_COMMAND_MASK 0xFFFFFFFFFFFFFFFFULL
+#endif
 
 // Constantes para configuración I2C
-static constexpr uint8_t DEFAULT_I2C_ADDRESS = 0x08; //0x08
-static constexpr uint8_t MIN_I2C_ADDRESS = 0x08;
-static constexpr uint8_t MAX_I2C_ADDRESS = 0x77;
 static constexpr unsigned long MIN_UPDATE_INTERVAL = 10; // ms
 static constexpr unsigned long DEFAULT_UPDATE_INTERVAL = 1000; // ms 1000
+static constexpr unsigned long MAX_ADAPTIVE_INTERVAL = 60000;  // ms, cabe en SensorData::intervalMs
+static constexpr uint32_t FIXED_CYCLE_MS = 120000;              // Ruta de punto fijo: duración del ciclo de medida (la de NoiseSensor por defecto)
+static constexpr unsigned long LATE_UPDATE_THRESHOLD = 20;     // ms de retraso para contar un intervalo como tardío
+static constexpr uint8_t ADC_CHECK_SAMPLES = 5;                 // Lecturas de una verificación de señal del ADC
+static constexpr int64_t ADC_CHECK_SPACING_US = 5000;           // Separación entre lecturas de la verificación
+static constexpr int64_t ADC_CHECK_PERIOD_US = 10000000;        // Cadencia de la supervisión del ADC (y de los reintentos al arrancar)
+static constexpr uint8_t BUS_CONFIRM_READS = 16;                // Lecturas de SDA/SCL que confirman un bus colgado antes de reiniciar Wire
+static constexpr uint32_t BUS_CONFIRM_SPACING_US = 25;          // Separación: la ráfaga cubre 40 periodos de SCL a 100 kHz
+static constexpr uint8_t PIN_DISABLED = 0xFF;          // Pin opcional no usado
+static constexpr uint8_t TRANSPORT_I2C = 0x01;         // Config::transports: esclavo I2C
+static constexpr uint8_t TRANSPORT_SERIAL = 0x02;      // Config::transports: tramas binarias por serialPort (NOISE_STREAM)
+static constexpr uint8_t HISTORY_LENGTH = NOISE_HISTORY_LENGTH;
+static constexpr size_t STREAM_BLOCK_SAMPLES = 64;    // Muestras por bloque del ADC continuo
+static constexpr uint8_t DEFAULT_DECIMATION_RATIO = 16;
+static constexpr uint32_t MAX_SLIDING_WINDOW_MS = 3600000;   // 1 h: la duración del sub-bloque en µs cabe en 32 bits
+static_assert(NOISE_HISTORY_LENGTH > 0 && NOISE_HISTORY_LENGTH <= 255, "NOISE_HISTORY_LENGTH debe estar entre 1 y 255");
+static_assert(NOISE_DELTA_SESSIONS > 0 && NOISE_DELTA_SESSIONS <= 128, "NOISE_DELTA_SESSIONS debe estar entre 1 y 128");
 
-// Estructura de datos del sensor
-struct SensorData {
-    float noise;
-    float noiseAvg;
-    float noisePeak;
-    float noiseMin;
-    float noiseAvgLegal;
-    float noiseAvgLegalMax;
-    uint16_t lowNoiseLevel;
-    uint32_t cycles;
-};
-
-// Comandos I2C
-enum I2CCommand {
-    CMD_GET_DATA = 0x01,      // Solicitar todos los datos
-    CMD_GET_AVG = 0x02,       // Solicitar promedio
-    CMD_GET_PEAK = 0x03,      // Solicitar pico
-    CMD_GET_MIN = 0x04,       // Solicitar mínimo
-    CMD_GET_LEGAL = 0x05,     // Solicitar promedio legal
-    CMD_GET_LEGAL_MAX = 0x06, // Solicitar máximo legal
-    CMD_GET_STATUS = 0x07,    // Solicitar estado
-    CMD_RESET = 0x08,         // Resetear ciclo
-    CMD_PING = 0x09,          // Identificación/detección del sensor (alias de CMD_IDENTIFY)
-    CMD_IDENTIFY = 0x09,      // Identificación y detección del sensor
-    CMD_GET_READY = 0x0A      // Verificar si está listo para enviar datos
-};
+/**
+ * Verificar en compilación si un comando está habilitado en NOISE_COMMAND_MASK
+ */
+static constexpr bool commandEnabled(uint8_t cmd) {
+    return cmd < 64 && ((static_cast<unsigned long long>(NOISE_COMMAND_MASK) >> cmd) & 1ULL) != 0;
+}
 
-// Estructura de identificación del sensor
-struct SensorIdentity {
-    uint8_t sensorType;       // Tipo de sensor (0x01 = Noise Sensor)
-    uint8_t versionMajor;     // Versión mayor
-    uint8_t versionMinor;     // Versión menor
-    uint8_t status;           // Estado: bit 0 = inicializado, bit 1 = ADC activo, bit 2 = datos listos
-    uint8_t i2cAddress;       // Dirección I2C del sensor
-} __attribute__((packed));
+static_assert(sizeof(SensorData) <= RESPONSE_BUFFER_SIZE, "SensorData no cabe en el buffer de respuesta");
+static_assert(sizeof(SensorSnapshot) <= RESPONSE_BUFFER_SIZE, "SensorSnapshot no cabe en el buffer de respuesta");
+static_assert(sizeof(TimeSyncStatus) <= RESPONSE_BUFFER_SIZE, "TimeSyncStatus no cabe en el buffer de respuesta");
+static_assert(sizeof(JitterHistogram) <= RESPONSE_BUFFER_SIZE, "JitterHistogram no cabe en el buffer de respuesta");
+static_assert(sizeof(PerfStatsReport) <= RESPONSE_BUFFER_SIZE, "PerfStatsReport no cabe en el buffer de respuesta");
+static_assert(CAPTURE_CHUNK_BYTES <= RESPONSE_BUFFER_SIZE, "El bloque de captura no cabe en el buffer de respuesta");
+static_assert(DELTA_MAX_FRAME <= RESPONSE_BUFFER_SIZE, "La trama delta no cabe en el buffer de respuesta");
+static_assert(sizeof(WindowExtremes) <= RESPONSE_BUFFER_SIZE, "WindowExtremes no cabe en el buffer de respuesta");
+static_assert(sizeof(WindowExtremes) == 48, "WindowExtremes::flags debe ocupar el relleno");
+static_assert(sizeof(TimeWeightedLevels) <= RESPONSE_BUFFER_SIZE, "TimeWeightedLevels no cabe en el buffer de respuesta");
+static_assert(LOG_FRAME_BYTES <= RESPONSE_BUFFER_SIZE, "La trama del log no cabe en el buffer de respuesta");
+static_assert(sizeof(LogStatus) <= RESPONSE_BUFFER_SIZE, "LogStatus no cabe en el buffer de respuesta");
+static_assert(sizeof(BusHealth) <= RESPONSE_BUFFER_SIZE, "BusHealth no cabe en el buffer de respuesta");
+static_assert(sizeof(StreamStats) <= RESPONSE_BUFFER_SIZE, "StreamStats no cabe en el buffer de respuesta");
 
 /**
  * Clase para manejar un sensor de ruido como esclavo I2C
@@ -55,7 +150,7 @@ class NoiseSensorI2CSlave {
 public:
     // Constantes de versión (públicas para fácil acceso)
     static constexpr uint8_t VERSION_MAJOR = 1;
-    static constexpr uint8_t VERSION_MINOR = 1;
+    static constexpr uint8_t VERSION_MINOR = 2;
     static constexpr uint8_t SENSOR_TYPE_NOISE = 0x01;
     
     /**
@@ -66,7 +161,27 @@ public:
         uint8_t sdaPin = 8;                            // Pin SDA
         uint8_t sclPin = 10;                           // Pin SCL
         uint8_t adcPin = 4;                            // Pin ADC para el sensor
+        uint8_t adcAttenuation = ADC_11db;             // Atenuación del ADC (0..3); la calibración de eFuse es por atenuación
         unsigned long updateInterval = DEFAULT_UPDATE_INTERVAL; // Intervalo de actualización en ms
+        uint8_t latchPin = PIN_DISABLED;               // Entrada de latch compartida por todos los esclavos (flanco de bajada)
+        uint32_t sampleRateHz = 0;                     // ADC continuo por DMA (requiere NOISE_FIXED_POINT, 0 = desactivado)
+        uint8_t decimationRatio = DEFAULT_DECIMATION_RATIO; // Factor del decimador CIC+FIR del ADC continuo
+        bool dcBlock = false;                          // Ruta de punto fijo: restar la DC del micrófono antes de TimeWeighting (SensorData no cambia)
+        bool adaptiveInterval = false;                 // Ajustar el intervalo de agregación según la actividad
+        unsigned long minAdaptiveInterval = 250;       // Límite inferior del intervalo adaptativo en ms (>= MIN_UPDATE_INTERVAL)
+        unsigned long maxAdaptiveInterval = 10000;     // Límite superior del intervalo adaptativo en ms (<= MAX_ADAPTIVE_INTERVAL)
+        float quietStdDevMv = 1.0f;                    // Desviación típica del nivel por debajo de la cual el intervalo está en calma
+        float activeStdDevMv = 5.0f;                   // Desviación típica a partir de la cual se acorta el intervalo
+        uint8_t quietIntervals = 3;                    // Registros en calma seguidos antes de alargar el intervalo
+        uint32_t slidingWindowMs[SLIDING_WINDOW_COUNT] = {1000, 10000, 60000}; // Duración de las ventanas de CMD_GET_WINDOWS en ms
+        float deltaDeadbandsMv[DELTA_LEVEL_FIELDS] = {2.0f, 0.5f, 1.0f, 1.0f, 0.5f, 0.5f}; // Banda muerta de CMD_GET_DELTA por campo float (orden de SensorData)
+        bool lazyStages = false;                       // Calcular las etapas SUB_* solo con suscripción (CMD_SUBSCRIBE o lecturas recientes)
+        uint32_t subscriptionHoldMs = 30000;           // Tiempo que una lectura mantiene su etapa activa (0 = solo CMD_SUBSCRIBE)
+        uint16_t busHangMs = 200;                      // SDA/SCL en bajo o callback sin terminar durante este tiempo = bus colgado (0 = sin supervisión)
+        uint8_t transports = TRANSPORT_I2C;            // Transportes activos (TRANSPORT_I2C | TRANSPORT_SERIAL)
+        Stream* serialPort = nullptr;                  // Puerto del transporte serie, ya iniciado (p. ej. &Serial1 a 2 Mbps)
+        bool streamRecords = true;                     // Empujar cada registro por el transporte serie sin petición
+        uint16_t busSilenceMs = 0;                     // Sin callbacks durante este tiempo = periférico colgado (0 = no se vigila; solo con maestros que sondean)
         NoiseSensor::LogLevel logLevel = NoiseSensor::LOG_INFO;
     };
 
@@ -103,6 +218,7 @@ public:
 
     /**
      * Obtener el objeto NoiseSensor para configuración avanzada
+     * (con NOISE_FIXED_POINT no se actualiza: SensorData sale de la ruta entera)
      * @return Referencia al objeto NoiseSensor
      */
     NoiseSensor& getNoiseSensor() { return noiseSensor; }
@@ -122,10 +238,17 @@ public:
 
     /**
      * Verificar si el sensor está inicializado correctamente
+     * Tras begin() pasa a true en un update() posterior, cuando termina la verificación del ADC
      * @return true si el sensor está inicializado y listo para usar
      */
     bool isInitialized() const { return initialized; }
 
+    /**
+     * Verificar si el bus I2C está atendiendo (desde begin(), antes de la verificación del ADC)
+     * @return true si el maestro ya puede leer la identidad y el estado
+     */
+    bool isServing() const { return serving; }
+
     /**
      * Verificar si el sensor está listo para enviar datos
      * Verifica que esté inicializado y que el ADC esté recibiendo señal
@@ -139,31 +262,449 @@ public:
      */
     bool isADCActive() const { return adcActive; }
 
+    /**
+     * Obtener el último snapshot congelado (CMD_LATCH o línea de latch)
+     * @return Referencia a la estructura SensorSnapshot
+     */
+    const SensorSnapshot& getSnapshot() const { return snapshot; }
+
+    /**
+     * Verificar si hay al menos un snapshot congelado
+     * @return true si getSnapshot() contiene datos válidos
+     */
+    bool isSnapshotReady() const { return snapshotReady; }
+
+    /**
+     * Solicitar un latch desde el propio firmware (equivale a CMD_LATCH)
+     */
+    void requestLatch();
+
+    /**
+     * Sincronizar el reloj local con el del maestro (equivale a CMD_TIME_SYNC)
+     * @param masterUs Tiempo del maestro en µs
+     */
+    void syncTime(uint64_t masterUs);
+
+    /**
+     * Obtener el tiempo sincronizado actual
+     * @return Tiempo en µs (reloj del maestro si hay sincronización)
+     */
+    uint64_t getTimestamp() const;
+
+    /**
+     * Obtener el estimador de offset/deriva
+     * @return Referencia al objeto TimeSync
+     */
+    const TimeSync& getTimeSync() const { return timeSync; }
+
+    /**
+     * Número de registros disponibles en el histórico
+     */
+    uint8_t getHistoryCount() const { return historyCount; }
+
+    /**
+     * Obtener un registro del histórico
+     * @param index 0 = más reciente
+     * @param out Registro de salida
+     * @return true si el índice existe
+     */
+    bool getHistory(uint8_t index, SensorData& out) const;
+
+    /**
+     * Obtener el estado de las suscripciones (el mismo que CMD_GET_SUBSCRIPTION)
+     * @return Estructura SubscriptionStatus
+     */
+    SubscriptionStatus getSubscriptionStatus() const;
+
+    /**
+     * Obtener el estado de la supervisión del bus (el mismo que CMD_GET_BUS_HEALTH)
+     * @return Estructura BusHealth
+     */
+    BusHealth getBusHealth() const { return busHealth; }
+
+#if NOISE_STREAM
+    /**
+     * Obtener los contadores del transporte serie (los mismos que CMD_GET_STREAM_STATS)
+     * @return Estructura StreamStats
+     */
+    const StreamStats& getStreamStats() const { return stream.getStats(); }
+#endif
+
+    /**
+     * Suscribir etapas desde el propio firmware (equivale a CMD_SUBSCRIBE)
+     * @param mask Máscara SUB_*; 0 = solo las inferidas de las lecturas
+     */
+    void subscribe(uint32_t mask) { requestedSubscriptions = mask; }
+
+#if NOISE_FIXED_POINT
+    /**
+     * Obtener los datos del último intervalo calculados en punto fijo
+     * @return Referencia a la estructura SensorDataFixed
+     */
+    const SensorDataFixed& getDataFixed() const { return sensorDataFixed; }
+
+    /**
+     * Añadir una etapa a la cadena de procesado por bloques (antes de begin())
+     * Las etapas añadidas corren en orden delante de las de la librería (LevelStats y
+     * TimeWeighting): una etapa que modifique el bloque cambia SensorDataFixed.
+     * @param stage Etapa con vida mayor que la del esclavo (global o estática)
+     * @return false si la cadena está llena o ya se llamó a begin()
+     */
+    bool addStage(BlockStage* stage) { return pipeline.add(stage); }
+#endif
+
+    /**
+     * Obtener el informe de heap (libre al terminar begin(), actual y mínimo desde begin())
+     * @return Estructura HeapReport
+     */
+    HeapReport heapReport() const;
+
+    /**
+     * Obtener los contadores de rendimiento (los mismos que CMD_GET_STATS)
+     * @return Estructura PerfStatsReport
+     */
+    PerfStatsReport getStats() const { return perfStats.report(); }
+
+    /**
+     * Poner a cero los contadores de rendimiento
+     */
+    void resetStats() { perfStats.reset(); scheduler.resetHistogram(); }
+
+    /**
+     * Intervalo de agregación en vigor (varía con adaptiveInterval)
+     * @return Intervalo en ms
+     */
+    unsigned long getUpdateInterval() const { return scheduler.getPeriodUs() / 1000UL; }
+
+    /**
+     * Obtener el histograma de retraso de los intervalos (el mismo que CMD_GET_JITTER)
+     * @return Referencia a la estructura JitterHistogram
+     */
+    const JitterHistogram& getJitterHistogram() const { return scheduler.getHistogram(); }
+
+#if NOISE_CAPTURE_SAMPLES
+    /**
+     * Grabar muestras crudas del ADC (equivale a CMD_CAPTURE_START)
+     *
+     * Solo con ADC continuo (NOISE_FIXED_POINT y sampleRateHz); si no, la captura queda
+     * en estado REFUSED.
+     * @param durationMs Duración pedida (limitada por NOISE_CAPTURE_SAMPLES)
+     */
+    void startCapture(uint16_t durationMs);
+
+    /**
+     * Obtener el estado de la captura (el mismo que CMD_GET_CAPTURE_STATUS)
+     * @return Estructura CaptureStatus
+     */
+    CaptureStatus getCaptureStatus() const { return capture.status(); }
+
+    /**
+     * Escribir la última captura como traza de ADC (formato AdcTrace.h, tasa fija)
+     * @param out Destino (Serial, fichero...)
+     * @return Bytes escritos (0 si no hay captura lista)
+     */
+    size_t exportCaptureTrace(Print& out) const;
+#endif
+
+#if NOISE_FLASH_LOG
+    /**
+     * Escribir en flash los registros que aún están en RAM (antes de dormir o apagar)
+     * @return true si no hubo error de escritura
+     */
+    bool flushLog();
+
+    /**
+     * Obtener el estado del log en flash (el mismo que CMD_GET_LOG_STATUS)
+     * @return Estructura LogStatus
+     */
+    LogStatus getLogStatus() const;
+#endif
+
+#if NOISE_HUB
+    /**
+     * Asociar el hub que sondea las hojas: update() lo atiende y CMD_HUB_MAP /
+     * CMD_HUB_HISTORY responden con su caché
+     * @param hub Hub ya iniciado con begin() (nullptr = desasociar)
+     */
+    void attachHub(NoiseSensorHub* hub) { this->hub = hub; }
+#endif
+
+#if NOISE_REPLAY
+    /**
+     * Alimentar la librería desde una traza: localMicros() devuelve el tiempo de la muestra
+     * actual y las lecturas del ADC su valor. El llamador avanza la traza (next()) antes de
+     * cada update().
+     * @param source Traza a reproducir (nullptr = volver al hardware)
+     */
+    static void setReplaySource(TraceReader* source) { replaySource = source; }
+#endif
+
+    /**
+     * Volcar los contadores de rendimiento por Serial
+     */
+    void printStats() const;
+
 private:
     Config config;
     NoiseSensor noiseSensor;
     SensorData sensorData;
     bool dataReady;
     bool initialized;
+    volatile bool serving;    // Bus activo: se atiende desde begin(), antes de initialized
     bool adcActive;
-    unsigned long lastUpdate;
+    int64_t bootUs;           // localMicros() al activar el bus
+    bool bootCheckFailed;     // La primera verificación del ADC no encontró señal
+    bool adcCheckRunning;
+    bool adcCheckSignal;      // Resultado de la última verificación terminada
+    uint8_t adcCheckSamples;
+    uint32_t adcCheckCpuUs;
+    int64_t adcCheckNextUs;
+    int64_t lastAdcCheckUs;
+    BusHealth busHealth;
+    volatile uint32_t callbackBeats;   // Callbacks I2C iniciados (latido del periférico)
+    volatile uint32_t callbackEnterUs; // Inicio del callback en curso (32 bits bajos, 0 = ninguno)
+    uint32_t lastBeats;
+    uint32_t recoverBeats;             // Latido al reiniciar Wire
+    int64_t lastBeatUs;                // Último cambio del latido (0 = sin actividad desde el reinicio)
+    int64_t lineLowSinceUs;            // Primera muestra con una línea en bajo (0 = en reposo)
+    int64_t hangStartUs;
+    int64_t recoverAtUs;
+    DeadlineScheduler scheduler;
+    AdaptiveInterval adaptive;
+    float levelShift;         // Sin NOISE_FIXED_POINT: primer nivel del intervalo, las sumas se desplazan para no perder precisión
+    float levelSum;           // Suma del nivel en el intervalo (para su desviación típica)
+    float levelSumSq;
+    uint32_t levelCount;
     bool instanceOwner;
-    volatile uint8_t lastCommand;
     volatile bool pendingReset;
+    volatile bool pendingLatch;
+    volatile int64_t latchRequestMicros;
+    SensorSnapshot snapshot;
+    bool snapshotReady;
+    TimeSync timeSync;
+    volatile bool pendingTimeSync;
+    volatile uint64_t syncMasterUs;
+    volatile int64_t syncLocalUs;
+    SensorData history[HISTORY_LENGTH];
+    uint8_t historyHead;
+    uint8_t historyCount;
+    DeltaSession deltaSessions[NOISE_DELTA_SESSIONS];
+    SlidingExtremes windows[SLIDING_WINDOW_COUNT];
+    WindowExtremes windowExtremes;  // Publicado en cada update(): onRequest solo copia
+    volatile uint32_t requestedSubscriptions;  // Máscara de CMD_SUBSCRIBE
+    volatile uint32_t windowsRequestMs;        // Última lectura de CMD_GET_WINDOWS (0 = nunca)
+    volatile uint32_t weightedRequestMs;       // Última lectura de CMD_GET_WEIGHTED (0 = nunca)
+    uint32_t inferredSubscriptions;
+    uint32_t activeSubscriptions;
+    uint32_t skippedWindowUpdates;
+    uint32_t heapFreeAtBegin;
+    uint32_t heapMinFreeSinceBegin;
+    static char logBuffer[NOISE_LOG_BUFFER_SIZE];
+    PerfStats perfStats;
+    int64_t lastUpdateCallUs;
+    uint32_t measureCycles;   // Ciclos de CPU de la medida (NoiseSensor o punto fijo) en el intervalo
+    uint32_t measureCalls;    // Llamadas a update() en el intervalo
+#if NOISE_FIXED_POINT
+    LevelStats fixedStats;
+    LevelCycle fixedCycle;       // Ciclo de FIXED_CYCLE_MS (o desde CMD_RESET): campos de SensorData
+    SensorDataFixed sensorDataFixed;
+    AdcCalibration calibration;  // Códigos a mV por tabla (eFuse), construida en begin()
+    TimeWeighting timeWeighting; // Detectores Fast/Slow/Impulse sobre las mismas muestras que fixedStats
+    TimeWeightedLevels weightedLevels;
+    static uint8_t pipelineArena[NOISE_PIPELINE_ARENA_BYTES];
+    BlockPipeline pipeline;      // Etapas del usuario + levelSink + dcBlocker + weightingSink
+    DcBlockerStage dcBlocker;    // Quita la polarización del micrófono a TimeWeighting (config.dcBlock)
+    LevelSink levelSink;         // Una reducción por bloque para fixedStats, fixedCycle y windows
+    BlockSink<TimeWeighting> weightingSink;
+    uint8_t pendingSamples;      // Sin ADC continuo: muestras de update() agrupadas en streamBlock
+    int16_t streamCheckCode;     // Con ADC continuo: última muestra cruda drenada, para la verificación de señal
+    AdcStream adcStream;
+    Decimator decimator;
+    alignas(16) int16_t streamBlock[STREAM_BLOCK_SAMPLES];
+    alignas(16) int16_t decimatedBlock[STREAM_BLOCK_SAMPLES / Decimator::MIN_RATIO + 1];
+#endif
+#if NOISE_CAPTURE_SAMPLES
+    static int16_t captureBuffer[NOISE_CAPTURE_SAMPLES];
+    PcmCapture capture;
+    volatile uint16_t pendingCaptureMs;
+#endif
+#if NOISE_FLASH_LOG
+    FlashLog flashLog;
+    uint32_t logWriteUs;                  // Tiempo total de escritura de páginas
+    uint32_t logMaxWriteUs;
+#endif
+#if NOISE_STREAM
+    StreamTransport stream;
+#endif
+#if NOISE_HUB
+    NoiseSensorHub* hub;
+#endif
+
+    /**
+     * Estado de comando de un transporte: argumentos del último comando y cursores de lectura
+     *
+     * I2C separa el comando (onReceive) de la respuesta (onRequest) en dos transacciones. Con
+     * un estado por transporte, un comando del otro transporte entre las dos no cambia lo que
+     * se responde. Lo compartido (sesiones delta, suscripciones, contadores) sigue bajo
+     * CommandLock.
+     */
+    struct TransportState {
+        uint8_t lastCommand;                  // Comando de la siguiente respuesta (I2C)
+        uint8_t historyRequestIndex;
+        uint8_t deltaSessionIndex;
+#if NOISE_CAPTURE_SAMPLES
+        volatile uint32_t captureOffset;      // CMD_RESET lo pone a cero desde update()
+#endif
+#if NOISE_FLASH_LOG
+        volatile uint8_t pendingLogSeek;      // LogSeekMode, atendido en update()
+        uint64_t logSeekTimestamp;
+        uint32_t logSeekCursor;
+        uint32_t logResumeCursor;             // Registro siguiente al último entregado
+        bool logResumeValid;
+        volatile bool logActive;              // Se le preparan tramas (I2C desde el arranque)
+        uint8_t logFrame[LOG_FRAME_BYTES];    // Siguiente respuesta de CMD_LOG_READ, preparada en update()
+        volatile uint8_t logFrameLength;      // 0 = por preparar (la respuesta la consume)
+#endif
+#if NOISE_TRACE
+        uint8_t traceReadCore;                // Núcleo de la siguiente respuesta a CMD_TRACE_READ
+#endif
+#if NOISE_HUB
+        uint16_t hubMapOffset;                // Siguiente bloque de CMD_HUB_MAP
+        uint8_t hubLeafIndex;                 // Argumentos de CMD_HUB_HISTORY
+        uint8_t hubHistoryIndex;
+#endif
+        void reset();
+    };
+    TransportState i2cState;
+#if NOISE_STREAM
+    TransportState streamState;
+#endif
+#if NOISE_FLASH_LOG
+    TransportState* logReader;                // Transporte al que sigue la posición de lectura de flashLog
+#endif
 
     // Callbacks I2C (deben ser estáticos o usar punteros)
     static NoiseSensorI2CSlave* instance;
     static void IRAM_ATTR onRequestStatic();
     static void IRAM_ATTR onReceiveStatic(int numBytes);
+    static void IRAM_ATTR onLatchStatic();
     
     void onRequest();
     void onReceive(int numBytes);
+    // Comando escrito por cualquier transporte (los argumentos, como mucho 8, se copian o se ignoran)
+    void handleCommand(TransportState& state, uint8_t cmd, const uint8_t* args, size_t argCount, int64_t rxMicros);
+#if NOISE_STREAM
+    void serviceStream();
+    void pushRecord();
+#endif
+
+    // Despacho de respuestas por tabla (índice = comando)
+    typedef size_t (NoiseSensorI2CSlave::*ResponseHandler)(TransportState& state, uint8_t* out);
+    static const ResponseHandler responseHandlers[COMMAND_TABLE_SIZE];
+    uint8_t responseBuffer[RESPONSE_BUFFER_SIZE];
+
+    size_t buildResponse(TransportState& state, uint8_t cmd, uint8_t* out);
+    size_t respondData(TransportState& state, uint8_t* out);
+    size_t respondAvg(TransportState& state, uint8_t* out);
+    size_t respondPeak(TransportState& state, uint8_t* out);
+    size_t respondMin(TransportState& state, uint8_t* out);
+    size_t respondLegal(TransportState& state, uint8_t* out);
+    size_t respondLegalMax(TransportState& state, uint8_t* out);
+    size_t respondStatus(TransportState& state, uint8_t* out);
+    size_t respondReady(TransportState& state, uint8_t* out);
+    size_t respondIdentity(TransportState& state, uint8_t* out);
+    size_t respondSnapshot(TransportState& state, uint8_t* out);
+    size_t respondTime(TransportState& state, uint8_t* out);
+    size_t respondHistory(TransportState& state, uint8_t* out);
+    size_t respondHeap(TransportState& state, uint8_t* out);
+    size_t respondStats(TransportState& state, uint8_t* out);
+    size_t respondJitter(TransportState& state, uint8_t* out);
+    size_t respondDelta(TransportState& state, uint8_t* out);
+    size_t respondWindows(TransportState& state, uint8_t* out);
+    size_t respondSubscription(TransportState& state, uint8_t* out);
+    size_t respondBusHealth(TransportState& state, uint8_t* out);
+#if NOISE_STREAM
+    size_t respondStreamStats(TransportState& state, uint8_t* out);
+#endif
+#if NOISE_FIXED_POINT
+    size_t respondDataFixed(TransportState& state, uint8_t* out);
+    size_t respondWeighted(TransportState& state, uint8_t* out);
+#endif
+#if NOISE_CAPTURE_SAMPLES
+    size_t respondCaptureStatus(TransportState& state, uint8_t* out);
+    size_t respondCaptureChunk(TransportState& state, uint8_t* out);
+#endif
+#if NOISE_FLASH_LOG
+    enum LogSeekMode : uint8_t { LOG_SEEK_NONE, LOG_SEEK_OLDEST, LOG_SEEK_TIME, LOG_SEEK_CURSOR };
+    size_t respondLogRead(TransportState& state, uint8_t* out);
+    size_t respondLogStatus(TransportState& state, uint8_t* out);
+    void appendLog();
+    void serviceLogReader();
+    void serviceLogFrame(TransportState& state);
+#endif
+#if NOISE_TRACE
+    size_t respondTraceRead(TransportState& state, uint8_t* out);
+#endif
+#if NOISE_HUB
+    size_t respondHubMap(TransportState& state, uint8_t* out);
+    size_t respondHubHistory(TransportState& state, uint8_t* out);
+#endif
+
+    template <typename T>
+    static size_t respondWith(uint8_t* out, const T& value) {
+        memcpy(out, &value, sizeof(T));
+        return sizeof(T);
+    }
+
+    // Con NOISE_ENABLE_LOG=0 la condición es constante y el compilador elimina el logging
+    bool logEnabled(NoiseSensor::LogLevel level) const {
+        return NOISE_ENABLE_LOG && config.logLevel >= level;
+    }
+    void latchSnapshot();
+    void fillSensorData(SensorData& out, int64_t localUs) const;
+    void pushHistory(const SensorData& record);
+#if !NOISE_FIXED_POINT
+    float currentLevel() const;
+    void trackLevel();
+#endif
+    void trackWindows();
+    void publishWindows(int64_t nowUs);
+    void refreshSubscriptions();
+    void adaptInterval();
+    void sampleHeap();
+#if NOISE_FIXED_POINT
+    void startAdcStream();
+    void drainAdcStream();
+    void flushPendingSamples();
+#endif
+    static void logPrintf(const char* format, ...) __attribute__((format(printf, 1, 2)));
+    static const char* formatFloat2(float value, char* buf, size_t len);
+    static NoiseSensor::Config toNoiseConfig(const Config& cfg);
+    static int64_t localMicros();
+    int readAdcRaw() const;
+#if NOISE_FIXED_POINT
+    int32_t readAdcMilliVolts() const;
+#endif
+#if NOISE_REPLAY
+    static TraceReader* replaySource;
+#endif
     
-    // Método privado para verificar señal ADC
-    bool checkADCSignal();
+    // Verificación de señal ADC repartida entre llamadas a update()
+    void startADCCheck(int64_t startUs);
+    bool stepADCCheck(int64_t nowUs);
+    void superviseADC();
+    void serviceBoot();
+    // Supervisión del bus: reinicia Wire sin tocar el estado de las medidas
+    bool startWire();
+    void superviseBus();
+    void recoverBus(int64_t nowUs, uint8_t cause);
+    bool linesStuck();
+    uint8_t readBusLines() const;   // Bit 0 = SDA en alto, bit 1 = SCL en alto (como BusHealth::lines)
     static bool validateConfig(const Config& cfg);
     static bool isValidGpioPin(uint8_t pin);
     static bool isValidAdcPin(uint8_t pin);
+    static bool isValidWindows(const Config& cfg);
+    static bool isValidTransports(const Config& cfg);
 };
 
 #endif // NOISE_SENSOR_I2C_SLAVE_H
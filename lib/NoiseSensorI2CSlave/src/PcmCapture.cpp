@@ -0,0 +1,111 @@
+#include "PcmCapture.h"
+#include <string.h>
+
+PcmCapture::PcmCapture(int16_t* buffer, uint32_t capacity)
+    : buffer(buffer),
+      capacity(capacity),
+      state(IDLE),
+      captureId(0),
+      rateHz(0),
+      targetSamples(0),
+      samples(0),
+      startUs(0),
+      durationUs(0),
+      bytesSent(0),
+      firstChunkUs(0),
+      lastChunkUs(0) {}
+
+void PcmCapture::start(int64_t nowUs, uint16_t durationMs, uint32_t rate) {
+    state = IDLE;  // Invalida las lecturas de la captura anterior antes de sobrescribir
+    captureId++;
+    rateHz = rate;
+    samples = 0;
+    startUs = nowUs;
+    durationUs = 0;
+    bytesSent = 0;
+    firstChunkUs = 0;
+    lastChunkUs = 0;
+
+    // Se graban exactamente las muestras de la duración pedida (o hasta llenar el buffer)
+    targetSamples = capacity;
+    const uint64_t wanted = static_cast<uint64_t>(rate) * durationMs / 1000;
+    if (wanted < targetSamples) {
+        targetSamples = static_cast<uint32_t>(wanted);
+    }
+    state = (targetSamples > 0) ? RECORDING : READY;
+}
+
+void PcmCapture::refuse() {
+    state = IDLE;
+    captureId++;
+    rateHz = 0;
+    samples = 0;
+    durationUs = 0;
+    bytesSent = 0;
+    firstChunkUs = 0;
+    lastChunkUs = 0;
+    state = REFUSED;
+}
+
+void PcmCapture::add(const int16_t* in, size_t n, int64_t nowUs) {
+    if (state != RECORDING) {
+        return;
+    }
+    size_t take = targetSamples - samples;
+    if (n < take) {
+        take = n;
+    }
+    memcpy(&buffer[samples], in, take * sizeof(int16_t));
+    samples += static_cast<uint32_t>(take);
+    if (samples >= targetSamples) {
+        durationUs = static_cast<uint32_t>(nowUs - startUs);
+        state = READY;
+    }
+}
+
+size_t PcmCapture::readChunk(uint32_t offset, uint8_t* out, int64_t nowUs) {
+    if (state != READY) {
+        return 0;
+    }
+
+    const uint32_t totalBytes = samples * sizeof(int16_t);
+    uint32_t length = 0;
+    if (offset < totalBytes) {
+        length = totalBytes - offset;
+        if (length > CAPTURE_CHUNK_PAYLOAD) {
+            length = CAPTURE_CHUNK_PAYLOAD;
+        }
+    }
+
+    CaptureChunkHeader header;
+    header.captureId = captureId;
+    header.length = static_cast<uint8_t>(length);
+    header.flags = (offset + length >= totalBytes) ? 0x01 : 0x00;
+    header.offset = offset;
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + sizeof(header), reinterpret_cast<const uint8_t*>(buffer) + offset, length);
+
+    if (bytesSent == 0) {
+        firstChunkUs = nowUs;
+    }
+    lastChunkUs = nowUs;
+    bytesSent += length;
+    return sizeof(header) + length;
+}
+
+CaptureStatus PcmCapture::status() const {
+    CaptureStatus s;
+    s.state = state;
+    s.reserved = 0;
+    s.captureId = captureId;
+    s.sampleRateHz = rateHz;
+    s.samples = samples;
+    s.durationUs = durationUs;
+    s.bytesSent = bytesSent;
+    s.throughputBps = 0;
+    const int64_t elapsed = lastChunkUs - firstChunkUs;
+    if (elapsed > 0) {
+        s.throughputBps = static_cast<uint32_t>(static_cast<uint64_t>(bytesSent) * 1000000ULL / static_cast<uint64_t>(elapsed));
+    }
+    return s;
+}
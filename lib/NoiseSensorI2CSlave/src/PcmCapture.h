@@ -0,0 +1,99 @@
+#ifndef NOISE_PCM_CAPTURE_H
+#define NOISE_PCM_CAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+static constexpr size_t CAPTURE_CHUNK_BYTES = 64;     // Igual al buffer de Wire
+
+// Cabecera de cada bloque leído con CMD_GET_CAPTURE_CHUNK (seguida de length bytes de muestras)
+struct CaptureChunkHeader {
+    uint16_t captureId;       // Captura a la que pertenece el bloque
+    uint8_t length;           // Bytes de muestras tras la cabecera
+    uint8_t flags;            // Bit 0 = último bloque de la captura
+    uint32_t offset;          // Offset en bytes del bloque dentro de la captura
+};
+
+static constexpr size_t CAPTURE_CHUNK_PAYLOAD = CAPTURE_CHUNK_BYTES - sizeof(CaptureChunkHeader);
+static_assert(CAPTURE_CHUNK_PAYLOAD % sizeof(int16_t) == 0, "El bloque debe contener muestras completas");
+
+// Estado de la captura (respuesta a CMD_GET_CAPTURE_STATUS)
+struct CaptureStatus {
+    uint8_t state;            // 0 = libre, 1 = grabando, 2 = lista para leer, 3 = rechazada (sin ADC continuo)
+    uint8_t reserved;
+    uint16_t captureId;       // Se incrementa en cada captura
+    uint32_t sampleRateHz;    // Tasa del ADC continuo
+    uint32_t samples;         // Muestras grabadas (int16_t, códigos crudos de 12 bits)
+    uint32_t durationUs;      // Duración real de la grabación
+    uint32_t bytesSent;       // Bytes de muestras enviados al maestro
+    uint32_t throughputBps;   // Caudal de lectura logrado (bytes/s entre el primer y el último bloque)
+};
+
+/**
+ * Captura de muestras crudas del ADC en un buffer preasignado
+ *
+ * La grabación la alimentan los bloques del ADC continuo (tasa fija: el resultado es PCM)
+ * y la lectura se hace desde onRequest() en bloques
+ * de CAPTURE_CHUNK_BYTES con cabecera: el offset permite reanudar tras un fallo de bus.
+ * Las muestras solo se leen en estado READY, cuando update() ya no escribe el buffer.
+ */
+class PcmCapture {
+public:
+    enum State : uint8_t {
+        IDLE = 0,
+        RECORDING = 1,
+        READY = 2,
+        REFUSED = 3       // Sin fuente a tasa fija: no se graba nada
+    };
+
+    PcmCapture(int16_t* buffer, uint32_t capacity);
+
+    /**
+     * Empezar una grabación (descarta la anterior)
+     * @param nowUs Tiempo local en µs
+     * @param durationMs Duración pedida
+     * @param rateHz Tasa de las muestras
+     */
+    void start(int64_t nowUs, uint16_t durationMs, uint32_t rateHz);
+
+    /**
+     * Rechazar una petición de grabación (descarta la anterior; el maestro ve el estado REFUSED)
+     */
+    void refuse();
+
+    void add(int16_t sample, int64_t nowUs) { add(&sample, 1, nowUs); }
+    void add(const int16_t* samples, size_t n, int64_t nowUs);
+
+    /**
+     * Escribir un bloque (cabecera + muestras) a partir de un offset
+     * @param offset Offset en bytes dentro de la captura
+     * @param out Buffer de CAPTURE_CHUNK_BYTES
+     * @param nowUs Tiempo local en µs (para el caudal)
+     * @return Bytes escritos en out (0 si la captura no está lista)
+     */
+    size_t readChunk(uint32_t offset, uint8_t* out, int64_t nowUs);
+
+    CaptureStatus status() const;
+
+    bool isRecording() const { return state == RECORDING; }
+    bool isReady() const { return state == READY; }
+    const int16_t* getSamples() const { return buffer; }
+    int64_t getStartUs() const { return startUs; }
+    uint32_t getCapacity() const { return capacity; }
+
+private:
+    int16_t* buffer;
+    uint32_t capacity;
+    volatile uint8_t state;
+    uint16_t captureId;
+    uint32_t rateHz;
+    uint32_t targetSamples;
+    uint32_t samples;
+    int64_t startUs;
+    uint32_t durationUs;
+    uint32_t bytesSent;
+    int64_t firstChunkUs;
+    int64_t lastChunkUs;
+};
+
+#endif // NOISE_PCM_CAPTURE_H
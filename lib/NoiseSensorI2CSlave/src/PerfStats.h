@@ -0,0 +1,130 @@
+#ifndef NOISE_PERF_STATS_H
+#define NOISE_PERF_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// Informe de contadores de rendimiento (respuesta a CMD_GET_STATS)
+struct PerfStatsReport {
+    uint32_t requests;          // onRequest() atendidos
+    uint32_t receives;          // onReceive() atendidos
+    uint32_t unknownCommands;   // Peticiones con comando desconocido o desactivado (respuesta 0x00)
+    uint32_t notReady;          // Peticiones respondidas con 0x00 por datos no listos
+    uint32_t lateUpdates;       // Intervalos de agregación ejecutados con retraso
+    uint32_t maxLateUs;         // Mayor retraso de un intervalo de agregación
+    uint32_t loopMinUs;         // Periodo mínimo entre llamadas a update()
+    uint32_t loopMaxUs;         // Periodo máximo entre llamadas a update()
+    uint32_t requestMaxUs;      // Duración máxima de onRequest()
+    uint32_t receiveMaxUs;      // Duración máxima de onReceive()
+    uint32_t aggregationLastUs; // Duración de la última agregación
+    uint32_t aggregationMaxUs;  // Duración máxima de una agregación
+    uint32_t adcChecks;         // Verificaciones de señal ADC realizadas
+    uint32_t adcCheckMaxUs;     // CPU máxima de una verificación de señal ADC (repartida entre varios update())
+    uint32_t bootServeUs;       // Del reset a I2C atendiendo (identidad y estado "arrancando")
+    uint32_t firstFrameUs;      // Del reset al primer registro válido (0 = aún no)
+};
+
+/**
+ * Contadores y medidores de rendimiento para los caminos críticos
+ *
+ * Cada campo tiene un único escritor a la vez: los callbacks I2C o loop(), y con
+ * NOISE_STREAM los dos transportes despachan comandos bajo el mismo cerrojo. Basta con
+ * load/store relajados: en ESP32-C3 (RV32IMC, sin instrucciones atómicas) compilan
+ * a lw/sw normales, sin las secciones críticas de libatomic que costaría un fetch_add.
+ */
+class PerfStats {
+public:
+    PerfStats() {
+        fields[BOOT_SERVE].store(0, std::memory_order_relaxed);
+        fields[FIRST_FRAME].store(0, std::memory_order_relaxed);
+        reset();
+    }
+
+    // Los tiempos de arranque se miden una vez y no se borran
+    void reset() {
+        for (size_t i = 0; i < RESETTABLE_COUNT; i++) {
+            fields[i].store(0, std::memory_order_relaxed);
+        }
+        fields[LOOP_MIN].store(UINT32_MAX, std::memory_order_relaxed);
+    }
+
+    void countRequest(uint32_t durationUs) { increment(REQUESTS); raiseMax(REQUEST_MAX, durationUs); }
+    void countReceive(uint32_t durationUs) { increment(RECEIVES); raiseMax(RECEIVE_MAX, durationUs); }
+    void countUnknownCommand() { increment(UNKNOWN_COMMANDS); }
+    void countNotReady() { increment(NOT_READY); }
+
+    void recordLoopPeriod(uint32_t periodUs) {
+        lowerMin(LOOP_MIN, periodUs);
+        raiseMax(LOOP_MAX, periodUs);
+    }
+
+    void recordLateUpdate(uint32_t lateUs) {
+        increment(LATE_UPDATES);
+        raiseMax(MAX_LATE, lateUs);
+    }
+
+    void recordAggregation(uint32_t durationUs) {
+        fields[AGGREGATION_LAST].store(durationUs, std::memory_order_relaxed);
+        raiseMax(AGGREGATION_MAX, durationUs);
+    }
+
+    void recordAdcCheck(uint32_t durationUs) {
+        increment(ADC_CHECKS);
+        raiseMax(ADC_CHECK_MAX, durationUs);
+    }
+
+    void recordBootServe(uint32_t sinceResetUs) { fields[BOOT_SERVE].store(sinceResetUs, std::memory_order_relaxed); }
+    void recordFirstFrame(uint32_t sinceResetUs) { fields[FIRST_FRAME].store(sinceResetUs, std::memory_order_relaxed); }
+
+    PerfStatsReport report() const {
+        PerfStatsReport r;
+        r.requests = get(REQUESTS);
+        r.receives = get(RECEIVES);
+        r.unknownCommands = get(UNKNOWN_COMMANDS);
+        r.notReady = get(NOT_READY);
+        r.lateUpdates = get(LATE_UPDATES);
+        r.maxLateUs = get(MAX_LATE);
+        r.loopMinUs = (get(LOOP_MIN) == UINT32_MAX) ? 0 : get(LOOP_MIN);
+        r.loopMaxUs = get(LOOP_MAX);
+        r.requestMaxUs = get(REQUEST_MAX);
+        r.receiveMaxUs = get(RECEIVE_MAX);
+        r.aggregationLastUs = get(AGGREGATION_LAST);
+        r.aggregationMaxUs = get(AGGREGATION_MAX);
+        r.adcChecks = get(ADC_CHECKS);
+        r.adcCheckMaxUs = get(ADC_CHECK_MAX);
+        r.bootServeUs = get(BOOT_SERVE);
+        r.firstFrameUs = get(FIRST_FRAME);
+        return r;
+    }
+
+private:
+    enum Field {
+        REQUESTS, RECEIVES, UNKNOWN_COMMANDS, NOT_READY, LATE_UPDATES, MAX_LATE,
+        LOOP_MIN, LOOP_MAX, REQUEST_MAX, RECEIVE_MAX, AGGREGATION_LAST, AGGREGATION_MAX,
+        ADC_CHECKS, ADC_CHECK_MAX, RESETTABLE_COUNT,
+        BOOT_SERVE = RESETTABLE_COUNT, FIRST_FRAME, FIELD_COUNT
+    };
+
+    std::atomic<uint32_t> fields[FIELD_COUNT];
+
+    uint32_t get(Field f) const { return fields[f].load(std::memory_order_relaxed); }
+
+    void increment(Field f) {
+        fields[f].store(get(f) + 1, std::memory_order_relaxed);
+    }
+
+    void raiseMax(Field f, uint32_t value) {
+        if (value > get(f)) {
+            fields[f].store(value, std::memory_order_relaxed);
+        }
+    }
+
+    void lowerMin(Field f, uint32_t value) {
+        if (value < get(f)) {
+            fields[f].store(value, std::memory_order_relaxed);
+        }
+    }
+};
+
+#endif // NOISE_PERF_STATS_H
@@ -0,0 +1,79 @@
+#include "SlidingExtremes.h"
+
+void SlidingExtremes::configure(uint32_t windowMs) {
+    bucketUs = windowMs * 1000UL / SLIDING_BUCKETS;
+    if (bucketUs == 0) {
+        bucketUs = 1;
+    }
+    bucketIndex = 0;
+    bucketEndUs = 0;
+    firstSampleUs = 0;
+    started = false;
+    current.valid = false;
+    current.max = 0.0f;
+    current.min = 0.0f;
+    maxQueue.clear();
+    minQueue.clear();
+}
+
+void SlidingExtremes::addRange(float maxValue, float minValue, int64_t nowUs) {
+    if (!started) {
+        started = true;
+        firstSampleUs = nowUs;
+        bucketEndUs = nowUs + bucketUs;
+    } else if (nowUs >= bucketEndUs) {
+        // Solo se divide al cambiar de sub-bloque (64 bits es caro en RV32)
+        const uint32_t skipped = static_cast<uint32_t>((nowUs - bucketEndUs) / bucketUs);
+        bucketEndUs += static_cast<int64_t>(skipped + 1) * bucketUs;
+        closeBucket(bucketIndex + skipped + 1);
+    }
+
+    if (!current.valid) {
+        current.max = maxValue;
+        current.min = minValue;
+        current.valid = true;
+        return;
+    }
+    if (maxValue > current.max) {
+        current.max = maxValue;
+    }
+    if (minValue < current.min) {
+        current.min = minValue;
+    }
+}
+
+void SlidingExtremes::closeBucket(uint32_t nextIndex) {
+    // Caducan los sub-bloques que quedan fuera de los SLIDING_BUCKETS anteriores al nuevo
+    const uint32_t oldest = nextIndex - SLIDING_BUCKETS;
+    while (maxQueue.size > 0 && static_cast<int32_t>(maxQueue.front().bucket - oldest) < 0) {
+        maxQueue.popFront();
+    }
+    while (minQueue.size > 0 && static_cast<int32_t>(minQueue.front().bucket - oldest) < 0) {
+        minQueue.popFront();
+    }
+
+    if (current.valid && static_cast<int32_t>(bucketIndex - oldest) >= 0) {
+        // Un valor dominado por uno más reciente ya no puede ser extremo de la ventana
+        while (maxQueue.size > 0 && maxQueue.back().value <= current.max) {
+            maxQueue.popBack();
+        }
+        while (minQueue.size > 0 && minQueue.back().value >= current.min) {
+            minQueue.popBack();
+        }
+        maxQueue.pushBack(Entry{current.max, bucketIndex});
+        minQueue.pushBack(Entry{current.min, bucketIndex});
+    }
+
+    bucketIndex = nextIndex;
+    current.valid = false;
+}
+
+uint32_t SlidingExtremes::getSpanMs(int64_t nowUs) const {
+    if (!started) {
+        return 0;
+    }
+    // Inicio de la ventana: principio del sub-bloque más antiguo que sigue dentro
+    const int64_t windowStartUs = bucketEndUs - static_cast<int64_t>(SLIDING_BUCKETS + 1) * bucketUs;
+    const int64_t startUs = firstSampleUs > windowStartUs ? firstSampleUs : windowStartUs;
+    return nowUs > startUs ? static_cast<uint32_t>((nowUs - startUs) / 1000) : 0;
+}
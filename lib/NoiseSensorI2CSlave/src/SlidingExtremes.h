@@ -0,0 +1,86 @@
+#ifndef NOISE_SLIDING_EXTREMES_H
+#define NOISE_SLIDING_EXTREMES_H
+
+#include <stdint.h>
+
+// Sub-bloques por ventana: la ventana avanza con una resolución de 1/20 de su duración
+static constexpr uint8_t SLIDING_BUCKETS = 20;
+
+/**
+ * Máximo y mínimo de una ventana deslizante en tiempo
+ *
+ * La ventana se divide en SLIDING_BUCKETS sub-bloques de duración fija. Cada muestra solo
+ * actualiza el máximo y el mínimo del sub-bloque en curso; al cerrarse, sus extremos
+ * entran en dos colas monótonas (decreciente para el máximo, creciente para el mínimo)
+ * y salen por delante al caducar. Coste O(1) amortizado por muestra, consulta O(1) y
+ * memoria fija sea cual sea la tasa de muestras.
+ *
+ * La ventana cubre los SLIDING_BUCKETS sub-bloques completos más el que está en curso:
+ * entre la duración nominal y 1/20 más. Un pico dentro de la duración nominal nunca se
+ * pierde. No depende de los ciclos de NoiseSensor ni de CMD_RESET.
+ */
+class SlidingExtremes {
+public:
+    SlidingExtremes() { configure(1000); }
+
+    void configure(uint32_t windowMs);
+
+    void add(float value, int64_t nowUs) { addRange(value, value, nowUs); }
+
+    // Máximo y mínimo de un grupo de muestras (un bloque) con el instante de la última
+    void addRange(float maxValue, float minValue, int64_t nowUs);
+
+    bool hasData() const { return current.valid || maxQueue.size > 0; }
+
+    float getMax() const {
+        float m = maxQueue.size > 0 ? maxQueue.front().value : current.max;
+        return (current.valid && current.max > m) ? current.max : m;
+    }
+
+    float getMin() const {
+        float m = minQueue.size > 0 ? minQueue.front().value : current.min;
+        return (current.valid && current.min < m) ? current.min : m;
+    }
+
+    // Tiempo cubierto por la ventana en ms (menor que la duración nominal tras el arranque)
+    uint32_t getSpanMs(int64_t nowUs) const;
+
+private:
+    struct Entry {
+        float value;
+        uint32_t bucket;
+    };
+
+    // Cola de capacidad fija sobre un anillo: entra por detrás, sale por ambos extremos
+    struct MonotonicQueue {
+        Entry entries[SLIDING_BUCKETS];
+        uint8_t head;
+        uint8_t size;
+
+        void clear() { head = 0; size = 0; }
+        const Entry& front() const { return entries[head]; }
+        const Entry& back() const { return entries[(head + size - 1) % SLIDING_BUCKETS]; }
+        void popFront() { head = (head + 1) % SLIDING_BUCKETS; size--; }
+        void popBack() { size--; }
+        void pushBack(const Entry& e) { entries[(head + size) % SLIDING_BUCKETS] = e; size++; }
+    };
+
+    struct Bucket {
+        float max;
+        float min;
+        bool valid;
+    };
+
+    uint32_t bucketUs;
+    uint32_t bucketIndex;     // Número del sub-bloque en curso desde el arranque
+    int64_t bucketEndUs;      // Fin del sub-bloque en curso
+    int64_t firstSampleUs;
+    bool started;
+    Bucket current;
+    MonotonicQueue maxQueue;
+    MonotonicQueue minQueue;
+
+    void closeBucket(uint32_t nextIndex);
+};
+
+#endif // NOISE_SLIDING_EXTREMES_H
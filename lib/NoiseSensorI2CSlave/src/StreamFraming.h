@@ -0,0 +1,103 @@
+#ifndef NOISE_STREAM_FRAMING_H
+#define NOISE_STREAM_FRAMING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "I2CProtocol.h"
+
+// Tramas del transporte serie binario (UART / USB-CDC), compartidas con las herramientas de host.
+//   Trama: tipo (uint8_t) + secuencia (uint8_t) + carga + CRC-16/CCITT-FALSE (little-endian)
+//   En la línea: la trama codificada en COBS, terminada en 0x00
+// La carga de STREAM_REQUEST es lo mismo que el maestro escribiría por I2C (comando +
+// argumentos); la de STREAM_RESPONSE, el comando seguido de lo que devolvería la lectura I2C
+// (0x00 = no listo). La secuencia de la petición se repite en su respuesta.
+enum StreamFrameType : uint8_t {
+    STREAM_REQUEST = 0x01,        // Maestro → esclavo: comando + argumentos
+    STREAM_RESPONSE = 0x02,       // Esclavo → maestro: comando + respuesta
+    STREAM_RECORD = 0x03,         // Esclavo → maestro sin petición: SensorData de cada intervalo
+    STREAM_RECORD_FIXED = 0x04    // Igual con SensorDataFixed (NOISE_FIXED_POINT), misma secuencia
+};
+
+static constexpr size_t STREAM_HEADER_BYTES = 2;      // Tipo + secuencia
+static constexpr size_t STREAM_CRC_BYTES = 2;
+static constexpr size_t STREAM_MAX_PAYLOAD = 1 + RESPONSE_BUFFER_SIZE;
+static constexpr size_t STREAM_MAX_FRAME = STREAM_HEADER_BYTES + STREAM_MAX_PAYLOAD + STREAM_CRC_BYTES;
+// Una trama de menos de 254 bytes añade en COBS un único byte de código, más el delimitador
+static constexpr size_t STREAM_MAX_WIRE = 1 + STREAM_MAX_FRAME + 1;
+
+static_assert(STREAM_MAX_FRAME < 254, "Las tramas deben caber en un solo bloque COBS");
+
+// CRC-16/CCITT-FALSE (polinomio 0x1021, valor inicial 0xFFFF)
+inline uint16_t streamCrc16(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * Cerrar una trama en el sitio: CRC, COBS y delimitador, sin copiar la carga
+ *
+ * La carga se escribe directamente en su sitio (p. ej. por un manejador de respuesta) y
+ * aquí solo se sustituyen los ceros por distancias: el byte de código inicial ocupa wire[0].
+ * @param wire Buffer de STREAM_MAX_WIRE bytes: tipo en wire[1], secuencia en wire[2], carga desde wire[3]
+ * @param payloadLen Bytes de carga (como mucho STREAM_MAX_PAYLOAD)
+ * @return Bytes a enviar, delimitador incluido
+ */
+inline size_t streamEncodeFrame(uint8_t* wire, size_t payloadLen) {
+    const size_t frameLen = STREAM_HEADER_BYTES + payloadLen;
+    const uint16_t crc = streamCrc16(wire + 1, frameLen);
+    wire[1 + frameLen] = static_cast<uint8_t>(crc & 0xFF);
+    wire[2 + frameLen] = static_cast<uint8_t>(crc >> 8);
+    const size_t end = 1 + frameLen + STREAM_CRC_BYTES;
+
+    size_t codePos = 0;
+    uint8_t code = 1;
+    for (size_t i = 1; i < end; i++) {
+        if (wire[i] == 0) {
+            wire[codePos] = code;
+            codePos = i;
+            code = 1;
+        } else {
+            code++;
+        }
+    }
+    wire[codePos] = code;
+    wire[end] = 0x00;
+    return end + 1;
+}
+
+/**
+ * Decodificar en el sitio una trama recibida (sin el delimitador) y comprobar su CRC
+ * @param buf Bytes COBS; al volver contiene tipo, secuencia y carga desde buf[0]
+ * @param len Bytes recibidos antes del 0x00
+ * @return Bytes de tipo + secuencia + carga, o 0 si la trama es inválida
+ */
+inline size_t streamDecodeFrame(uint8_t* buf, size_t len) {
+    size_t out = 0;
+    size_t i = 0;
+    while (i < len) {
+        const uint8_t code = buf[i++];
+        if (code == 0 || i + code - 1 > len) {
+            return 0;
+        }
+        for (uint8_t k = 1; k < code; k++) {
+            buf[out++] = buf[i++];
+        }
+        if (code < 0xFF && i < len) {
+            buf[out++] = 0;
+        }
+    }
+    if (out < STREAM_HEADER_BYTES + STREAM_CRC_BYTES) {
+        return 0;
+    }
+    const size_t frameLen = out - STREAM_CRC_BYTES;
+    const uint16_t crc = static_cast<uint16_t>(buf[frameLen] | (buf[frameLen + 1] << 8));
+    return streamCrc16(buf, frameLen) == crc ? frameLen : 0;
+}
+
+#endif // NOISE_STREAM_FRAMING_H
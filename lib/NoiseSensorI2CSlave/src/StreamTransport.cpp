@@ -0,0 +1,76 @@
+#include "StreamTransport.h"
+#include <cstring>
+
+StreamTransport::StreamTransport()
+    : port(nullptr), rxLength(0), rxOverflow(false), recordSequence(0) {
+    memset(rxBuffer, 0, sizeof(rxBuffer));
+    memset(txBuffer, 0, sizeof(txBuffer));
+    memset(&stats, 0, sizeof(stats));
+}
+
+void StreamTransport::begin(Stream* stream) {
+    port = stream;
+    rxLength = 0;
+    rxOverflow = false;
+}
+
+size_t StreamTransport::poll() {
+    if (port == nullptr) {
+        return 0;
+    }
+    while (port->available() > 0) {
+        const int b = port->read();
+        if (b < 0) {
+            break;
+        }
+        if (b != 0) {
+            if (rxLength < sizeof(rxBuffer)) {
+                rxBuffer[rxLength++] = static_cast<uint8_t>(b);
+            } else {
+                rxOverflow = true;
+            }
+            continue;
+        }
+
+        // Delimitador: una trama completa (las vacías aparecen al resincronizar y se ignoran)
+        const size_t len = rxLength;
+        const bool overflow = rxOverflow;
+        rxLength = 0;
+        rxOverflow = false;
+        if (overflow) {
+            stats.overruns++;
+            continue;
+        }
+        if (len == 0) {
+            continue;
+        }
+        const size_t frameLen = streamDecodeFrame(rxBuffer, len);
+        if (frameLen == 0) {
+            stats.crcErrors++;
+            continue;
+        }
+        if (rxBuffer[0] != STREAM_REQUEST || frameLen <= STREAM_HEADER_BYTES) {
+            continue;
+        }
+        stats.framesIn++;
+        return frameLen - STREAM_HEADER_BYTES;
+    }
+    return 0;
+}
+
+bool StreamTransport::send(uint8_t type, uint8_t sequence, size_t payloadLen) {
+    if (port == nullptr || payloadLen > STREAM_MAX_PAYLOAD) {
+        return false;
+    }
+    txBuffer[1] = type;
+    txBuffer[2] = sequence;
+    const size_t len = streamEncodeFrame(txBuffer, payloadLen);
+    if (port->availableForWrite() < static_cast<int>(len)) {
+        stats.dropped++;
+        return false;
+    }
+    port->write(txBuffer, len);
+    stats.framesOut++;
+    stats.bytesOut += static_cast<uint32_t>(len);
+    return true;
+}
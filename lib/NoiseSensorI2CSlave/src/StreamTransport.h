@@ -0,0 +1,65 @@
+#ifndef NOISE_STREAM_TRANSPORT_H
+#define NOISE_STREAM_TRANSPORT_H
+
+#include <Arduino.h>
+#include "StreamFraming.h"
+
+/**
+ * Transporte binario sobre un Stream (HardwareSerial a Mbps, USB-CDC nativo)
+ *
+ * Mismo protocolo de comandos que por I2C, en tramas COBS con CRC (StreamFraming.h), más
+ * un flujo de registros empujados sin petición. Todo se atiende desde update(): poll() lee
+ * lo disponible sin esperar y send() solo escribe si la trama cabe entera en el buffer del
+ * driver (si no, la descarta y la cuenta), así que el loop nunca se bloquea en el puerto.
+ *
+ * Sin copias intermedias: los manejadores escriben la respuesta directamente en payload(),
+ * la trama se cierra en el sitio y se entrega al driver con un solo write(). El puerto
+ * debe implementar availableForWrite() (HardwareSerial, HWCDC y USBCDC lo hacen).
+ */
+class StreamTransport {
+public:
+    StreamTransport();
+
+    /**
+     * Empezar a atender un puerto ya iniciado (Serial1.begin(2000000), USB...)
+     * @param port Puerto (nullptr = desactivar)
+     */
+    void begin(Stream* port);
+
+    bool isActive() const { return port != nullptr; }
+
+    /**
+     * Leer lo disponible del puerto hasta completar una petición
+     * @return Bytes de la petición (comando + argumentos, en request()); 0 si no hay ninguna completa
+     */
+    size_t poll();
+
+    const uint8_t* request() const { return rxBuffer + STREAM_HEADER_BYTES; }
+    uint8_t requestSequence() const { return rxBuffer[1]; }
+
+    // Carga de la siguiente trama de salida (STREAM_MAX_PAYLOAD bytes)
+    uint8_t* payload() { return txBuffer + 1 + STREAM_HEADER_BYTES; }
+
+    /**
+     * Cerrar y enviar la trama cuya carga está en payload()
+     * @return false si no cabía en el buffer del driver (descartada)
+     */
+    bool send(uint8_t type, uint8_t sequence, size_t payloadLen);
+
+    // Secuencia de los registros empujados (el maestro detecta huecos)
+    uint8_t nextRecordSequence() { return recordSequence++; }
+    void countRecord() { stats.records++; }
+
+    const StreamStats& getStats() const { return stats; }
+
+private:
+    Stream* port;
+    uint8_t rxBuffer[STREAM_MAX_FRAME + 1];   // COBS recibido; se decodifica en el sitio
+    size_t rxLength;
+    bool rxOverflow;
+    uint8_t txBuffer[STREAM_MAX_WIRE];
+    uint8_t recordSequence;
+    StreamStats stats;
+};
+
+#endif // NOISE_STREAM_TRANSPORT_H
@@ -0,0 +1,80 @@
+#ifndef NOISE_TIME_SYNC_H
+#define NOISE_TIME_SYNC_H
+
+#include <stdint.h>
+
+/**
+ * Estimador de offset y deriva entre el reloj del maestro y el reloj local (esp_timer).
+ *
+ * Cada sincronización aporta un par (tiempo maestro, tiempo local) en µs. El offset se
+ * re-ancla en cada par y la deriva se estima con la pendiente entre pares consecutivos,
+ * suavizada con una media exponencial. Todo en aritmética entera (sin FPU en ESP32-C3).
+ */
+class TimeSync {
+public:
+    // Ventana mínima entre sincronizaciones para estimar deriva (más corta = demasiado ruido)
+    static constexpr int64_t MIN_DRIFT_WINDOW_US = 1000000;
+    // Deriva máxima creíble de un cristal; por encima se trata como salto del reloj del maestro
+    static constexpr int64_t MAX_DRIFT_PPB = 1000000;
+
+    TimeSync() { reset(); }
+
+    void reset() {
+        anchorMaster = 0;
+        anchorLocal = 0;
+        driftPpb = 0;
+        syncCount = 0;
+    }
+
+    /**
+     * Registrar un par de sincronización
+     * @param masterUs Tiempo del maestro (época o monotónico) en µs
+     * @param localUs Tiempo local (esp_timer) en el momento de recibirlo
+     */
+    void sync(uint64_t masterUs, int64_t localUs) {
+        if (syncCount > 0) {
+            const int64_t dl = localUs - anchorLocal;
+            const int64_t dm = static_cast<int64_t>(masterUs - anchorMaster);
+            const int64_t err = dm - dl;
+            const int64_t maxErr = dl / (1000000000LL / MAX_DRIFT_PPB);
+
+            if (dl <= 0 || err > maxErr || err < -maxErr) {
+                // Salto del reloj del maestro (o reloj local reiniciado): la deriva ya no es válida
+                driftPpb = 0;
+            } else if (dl >= MIN_DRIFT_WINDOW_US) {
+                const int32_t measured = static_cast<int32_t>(err * 1000000000LL / dl);
+                driftPpb = (syncCount == 1) ? measured : (3 * driftPpb + measured) / 4;
+            }
+        }
+
+        anchorMaster = masterUs;
+        anchorLocal = localUs;
+        syncCount++;
+    }
+
+    /**
+     * Convertir un tiempo local al reloj del maestro
+     * @param localUs Tiempo local (esp_timer) en µs
+     * @return Tiempo sincronizado en µs (tiempo local si aún no hay sincronización)
+     */
+    uint64_t toMaster(int64_t localUs) const {
+        if (syncCount == 0) {
+            return static_cast<uint64_t>(localUs);
+        }
+        const int64_t elapsed = localUs - anchorLocal;
+        return anchorMaster + elapsed + elapsed * driftPpb / 1000000000LL;
+    }
+
+    bool isSynced() const { return syncCount > 0; }
+    int32_t getDriftPpb() const { return driftPpb; }
+    uint32_t getSyncCount() const { return syncCount; }
+    int64_t getOffsetUs() const { return static_cast<int64_t>(anchorMaster) - anchorLocal; }
+
+private:
+    uint64_t anchorMaster;
+    int64_t anchorLocal;
+    int32_t driftPpb;
+    uint32_t syncCount;
+};
+
+#endif // NOISE_TIME_SYNC_H
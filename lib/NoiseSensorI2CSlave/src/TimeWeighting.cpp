@@ -0,0 +1,20 @@
+#include "TimeWeighting.h"
+#include <math.h>
+
+// alpha = 1 - exp(-1 / (fs * tau)) en Q20, al menos 1 para que el filtro avance
+static int32_t weightingAlpha(uint32_t sampleRateHz, float tauS) {
+    const float alpha = 1.0f - expf(-1.0f / (static_cast<float>(sampleRateHz) * tauS));
+    const int32_t q = static_cast<int32_t>(alpha * (1 << 20) + 0.5f);
+    return q > 0 ? q : 1;
+}
+
+void TimeWeighting::setSampleRate(uint32_t sampleRateHz) {
+    if (sampleRateHz == 0 || sampleRateHz == rateHz) {
+        return;
+    }
+    rateHz = sampleRateHz;
+    alphaFast = weightingAlpha(sampleRateHz, TIME_WEIGHTING_FAST_S);
+    alphaSlow = weightingAlpha(sampleRateHz, TIME_WEIGHTING_SLOW_S);
+    alphaImpulseRise = weightingAlpha(sampleRateHz, TIME_WEIGHTING_IMPULSE_RISE_S);
+    alphaImpulseDecay = weightingAlpha(sampleRateHz, TIME_WEIGHTING_IMPULSE_DECAY_S);
+}
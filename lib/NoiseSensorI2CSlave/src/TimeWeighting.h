@@ -0,0 +1,109 @@
+#ifndef NOISE_TIME_WEIGHTING_H
+#define NOISE_TIME_WEIGHTING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "FixedPoint.h"
+
+// Constantes de tiempo normalizadas de los sonómetros (IEC 61672)
+static constexpr float TIME_WEIGHTING_FAST_S = 0.125f;
+static constexpr float TIME_WEIGHTING_SLOW_S = 1.0f;
+static constexpr float TIME_WEIGHTING_IMPULSE_RISE_S = 0.035f;
+static constexpr float TIME_WEIGHTING_IMPULSE_DECAY_S = 1.5f;
+
+/**
+ * Banco de detectores con ponderación temporal Fast, Slow e Impulse
+ *
+ * Cada detector es un IIR de un polo sobre el cuadrado de la muestra:
+ * y += alpha * (x² - y), con alpha = 1 - exp(-1 / (fs * tau)). Los coeficientes se
+ * calculan en setSampleRate() (Q20) y por muestra solo hay sumas y productos enteros.
+ * Impulse usa la constante de subida cuando x² supera el estado y la de bajada en otro
+ * caso. El estado es potencia en mV² con 16 bits fraccionarios: con alpha pequeño
+ * (Slow a tasas altas) el redondeo no estanca el filtro.
+ *
+ * Los máximos son del intervalo de agregación (resetMax() tras cada registro).
+ */
+class TimeWeighting {
+public:
+    TimeWeighting() : fast(0), slow(0), impulse(0), fastMax(0), slowMax(0), impulseMax(0), rateHz(0) {
+        setSampleRate(1000);
+    }
+
+    /**
+     * Recalcular los coeficientes para una tasa de muestras
+     * @param sampleRateHz Muestras por segundo que recibirá add()
+     */
+    void setSampleRate(uint32_t sampleRateHz);
+
+    void add(int16_t mv) {
+        const int64_t x2 = static_cast<int64_t>(mv) * mv << POWER_FRAC_BITS;
+        fast += step(x2 - fast, alphaFast);
+        slow += step(x2 - slow, alphaSlow);
+        impulse += step(x2 - impulse, x2 > impulse ? alphaImpulseRise : alphaImpulseDecay);
+        if (fast > fastMax) fastMax = fast;
+        if (slow > slowMax) slowMax = slow;
+        if (impulse > impulseMax) impulseMax = impulse;
+    }
+
+    void addBlock(const int16_t* in, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            add(in[i]);
+        }
+    }
+
+    // Arrancar los detectores en régimen para una potencia media dada (mV², p. ej. de LevelStats)
+    void prime(uint64_t meanSquare) {
+        const int64_t power = static_cast<int64_t>(meanSquare) << POWER_FRAC_BITS;
+        fast = slow = impulse = power;
+        fastMax = slowMax = impulseMax = power;
+    }
+
+    void resetMax() {
+        fastMax = fast;
+        slowMax = slow;
+        impulseMax = impulse;
+    }
+
+    // Niveles en centi-dB re 1 mV (como el Leq de LevelStats)
+    int32_t getFastCentiDb() const { return toCentiDb(fast); }
+    int32_t getSlowCentiDb() const { return toCentiDb(slow); }
+    int32_t getImpulseCentiDb() const { return toCentiDb(impulse); }
+    int32_t getFastMaxCentiDb() const { return toCentiDb(fastMax); }
+    int32_t getSlowMaxCentiDb() const { return toCentiDb(slowMax); }
+    int32_t getImpulseMaxCentiDb() const { return toCentiDb(impulseMax); }
+
+    uint32_t getSampleRate() const { return rateHz; }
+
+private:
+    static constexpr uint8_t POWER_FRAC_BITS = 16;
+    static constexpr uint8_t ALPHA_FRAC_BITS = 20;
+    // 10 * log10(2^16) en centi-dB: descuenta los bits fraccionarios del estado
+    static constexpr int32_t POWER_FRAC_CENTI_DB = 4816;
+
+    int64_t fast;
+    int64_t slow;
+    int64_t impulse;
+    int64_t fastMax;
+    int64_t slowMax;
+    int64_t impulseMax;
+    int32_t alphaFast;
+    int32_t alphaSlow;
+    int32_t alphaImpulseRise;
+    int32_t alphaImpulseDecay;
+    uint32_t rateHz;
+
+    static int64_t step(int64_t diff, int32_t alpha) {
+        // Con |mv| hasta 2^15, |diff| llega a 2^46 y diff·alpha (alpha hasta 2^20) no cabe en
+        // 64 bits: se multiplica por partes, diff = hi·2^20 + lo con 0 <= lo < 2^20. Mismo
+        // resultado que el producto completo redondeado, sin desbordar.
+        const int64_t hi = diff >> ALPHA_FRAC_BITS;
+        const int64_t lo = diff & ((1LL << ALPHA_FRAC_BITS) - 1);
+        return hi * alpha + ((lo * alpha + (1LL << (ALPHA_FRAC_BITS - 1))) >> ALPHA_FRAC_BITS);
+    }
+
+    static int32_t toCentiDb(int64_t power) {
+        return power > 0 ? fixedPowerToCentiDb(static_cast<uint64_t>(power)) - POWER_FRAC_CENTI_DB : 0;
+    }
+};
+
+#endif // NOISE_TIME_WEIGHTING_H
@@ -22,14 +22,6 @@ NoiseSensorI2CSlave sensor(config);
 
 void setup() {
     Serial.begin(115200);
-    delay(1000);
-
-    Serial.println("=== NoiseSensor I2C Slave (ESP32) ===");
-    Serial.printf("I2C addr: 0x%02X | SDA=%d | SCL=%d | ADC=%d\n",
-                  static_cast<unsigned>(I2C_ADDRESS),
-                  static_cast<int>(I2C_SDA_PIN),
-                  static_cast<int>(I2C_SCL_PIN),
-                  static_cast<int>(NOISE_ADC_PIN));
 
     config.i2cAddress = static_cast<uint8_t>(I2C_ADDRESS);
     config.sdaPin = static_cast<uint8_t>(I2C_SDA_PIN);
@@ -42,7 +34,17 @@ void setup() {
         Serial.println("ERROR: Configuración inválida (setConfig falló). Revisa pines/dirección.");
     }
 
+    // Sin esperas antes de begin(): el bus atiende identidad y estado "arrancando" en cuanto
+    // arranca y el ADC se verifica en los primeros update(). El log inicial puede perderse si
+    // el monitor serie se abre después.
     sensor.begin();
+
+    Serial.println("=== NoiseSensor I2C Slave (ESP32) ===");
+    Serial.printf("I2C addr: 0x%02X | SDA=%d | SCL=%d | ADC=%d\n",
+                  static_cast<unsigned>(I2C_ADDRESS),
+                  static_cast<int>(I2C_SDA_PIN),
+                  static_cast<int>(I2C_SCL_PIN),
+                  static_cast<int>(NOISE_ADC_PIN));
 }
 
 void loop() {
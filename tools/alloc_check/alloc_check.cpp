@@ -0,0 +1,184 @@
+// Comprobación de "sin heap tras begin()" en el host, contando cada reserva.
+//
+// Compilar y ejecutar en el host (sin Arduino, glibc):
+//   g++ -std=gnu++11 -O1 -Itools/host -Ilib/NoiseSensorI2CSlave/src tools/alloc_check/alloc_check.cpp
+//       tools/host/HostArduino.cpp lib/NoiseSensorI2CSlave/src/*.cpp -o alloc_check
+//   ./alloc_check [segundos]
+//   (repetir con -DNOISE_FIXED_POINT=1, -DNOISE_STREAM=1, -DNOISE_TRACE=1... para cada build)
+//
+// Sustituye malloc/calloc/realloc/free (y con ellos new/delete) por versiones que cuentan.
+// Construye el esclavo, llama a begin() y, a partir de ahí, cualquier reserva es un fallo:
+// simula segundos de update() con el reloj del núcleo de host, una lectura por cada comando
+// de la tabla de despacho en cada intervalo (con sus argumentos), escrituras de RESET, LATCH,
+// TIME_SYNC, CAPTURE_START y SUBSCRIBE, logging a LOG_INFO, printStats() y un reinicio de
+// Wire por bus colgado.
+// Termina con código 1 si hubo reservas después de begin().
+//
+// La librería NoiseSensor real no está en el host (tools/host/NoiseSensor.h la sustituye):
+// sus posibles reservas solo se ven en el chip, con CMD_GET_HEAP (en el host el informe va a 0).
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <malloc.h>
+#include "HostArduino.h"
+#include "NoiseSensorI2CSlave.h"
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void __libc_free(void* ptr);
+
+static bool armed = false;
+static unsigned long allocations = 0;       // Reservas con el contador armado
+static unsigned long totalAllocations = 0;
+static size_t armedBytes = 0;
+
+static void track(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    const size_t size = malloc_usable_size(ptr);
+    hostHeapUsed += size;
+    totalAllocations++;
+    if (armed) {
+        allocations++;
+        armedBytes += size;
+    }
+}
+
+extern "C" void* malloc(size_t size) {
+    void* ptr = __libc_malloc(size);
+    track(ptr);
+    return ptr;
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    void* ptr = __libc_calloc(count, size);
+    track(ptr);
+    return ptr;
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    if (ptr != nullptr) {
+        hostHeapUsed -= malloc_usable_size(ptr);
+    }
+    void* result = __libc_realloc(ptr, size);
+    track(result);
+    return result;
+}
+
+extern "C" void free(void* ptr) {
+    if (ptr != nullptr) {
+        hostHeapUsed -= malloc_usable_size(ptr);
+    }
+    __libc_free(ptr);
+}
+
+// Señal de micrófono: DC + tono, para que la verificación del ADC pase y haya niveles
+static uint16_t microphone(uint8_t) {
+    static uint32_t phase = 0;
+    phase += 7;
+    return static_cast<uint16_t>(1600 + ((phase & 0x3F) < 32 ? 120 : -120));
+}
+
+class NullPort : public Stream {
+public:
+    size_t write(const uint8_t*, size_t size) override { return size; }
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+};
+
+static uint8_t address = 0x08;
+
+static size_t transact(uint8_t cmd, const void* args, size_t argLen, uint8_t* response) {
+    uint8_t tx[16];
+    tx[0] = cmd;
+    memcpy(tx + 1, args, argLen);
+    return Wire.transfer(tx, 1 + argLen, response, response != nullptr ? 64 : 0);
+}
+
+int main(int argc, char** argv) {
+    const unsigned long seconds = argc > 1 ? strtoul(argv[1], nullptr, 10) : 30;
+    // stdout reserva su buffer en la primera escritura: antes de armar
+    printf("alloc_check: %lu s simulados\n", seconds);
+    fflush(stdout);
+
+    NullPort port;
+    NoiseSensorI2CSlave::Config config;
+    config.i2cAddress = address;
+    config.updateInterval = 250;
+    config.logLevel = NoiseSensor::LOG_INFO;
+    config.lazyStages = true;
+#if NOISE_STREAM
+    config.transports = TRANSPORT_I2C | TRANSPORT_SERIAL;
+    config.serialPort = &port;
+#endif
+    hostSetAnalogSource(microphone);
+    hostSetMicros(1000);
+
+    NoiseSensorI2CSlave sensor(config);
+    sensor.begin();
+    const unsigned long beginAllocations = totalAllocations;
+    armed = true;
+
+    uint8_t response[64];
+    const uint64_t endUs = 1000 + seconds * 1000000ULL;
+    uint64_t nextPollUs = 0;
+    uint32_t polls = 0;
+    uint64_t releaseUs = 0;
+    for (uint64_t nowUs = 1000; nowUs < endUs; nowUs += 1000) {
+        hostSetMicros(nowUs);
+        sensor.update();
+
+        if (nowUs >= nextPollUs) {
+            nextPollUs = nowUs + config.updateInterval * 1000ULL;
+            // Una pasada por toda la tabla: los comandos desactivados responden 0x00
+            for (uint8_t cmd = CMD_GET_DATA; cmd <= CMD_GET_STREAM_STATS; cmd++) {
+                const uint8_t index = static_cast<uint8_t>(polls % 4);
+                const uint32_t offset = 0;
+                if (cmd == CMD_RESET || cmd == CMD_LATCH || cmd == CMD_TIME_SYNC || cmd == CMD_CAPTURE_START ||
+                    cmd == CMD_SUBSCRIBE || cmd == CMD_LOG_SEEK) {
+                    continue;
+                } else if (cmd == CMD_GET_HISTORY || cmd == CMD_GET_DELTA) {
+                    transact(cmd, &index, 1, response);
+                } else if (cmd == CMD_GET_CAPTURE_CHUNK) {
+                    transact(cmd, &offset, sizeof(offset), response);
+                } else {
+                    transact(cmd, nullptr, 0, response);
+                }
+            }
+            const uint64_t masterUs = 1700000000000000ULL + nowUs;
+            const uint16_t captureMs = 100;
+            const uint32_t mask = (polls & 1) ? 0xFFFFFFFFu : 0;
+            transact(CMD_TIME_SYNC, &masterUs, sizeof(masterUs), nullptr);
+            transact(CMD_LATCH, nullptr, 0, nullptr);
+            transact(CMD_SUBSCRIBE, &mask, sizeof(mask), nullptr);
+            transact(CMD_LOG_SEEK, nullptr, 0, nullptr);
+            if (polls % 8 == 0) {
+                transact(CMD_CAPTURE_START, &captureMs, sizeof(captureMs), nullptr);
+            }
+            if (polls % 16 == 0) {
+                transact(CMD_RESET, nullptr, 0, nullptr);
+            }
+            polls++;
+        }
+
+        // Un bus colgado a mitad de la simulación: recuperación con Wire.end() + begin()
+        if (releaseUs == 0 && nowUs >= endUs / 2) {
+            hostSetPinLevel(config.sdaPin, LOW);
+            releaseUs = nowUs + 1000ULL * (config.busHangMs + 50);
+        } else if (nowUs == releaseUs) {
+            hostSetPinLevel(config.sdaPin, HIGH);
+        }
+    }
+    sensor.printStats();
+    armed = false;
+
+    printf("Reservas hasta begin(): %lu\n", beginAllocations);
+    printf("Reservas después de begin(): %lu (%zu bytes) en %lu intervalos sondeados, %u inicios de Wire\n",
+           allocations, armedBytes, static_cast<unsigned long>(polls), Wire.getBegins());
+    printf("%s\n", allocations == 0 ? "OK: sin heap tras begin()" : "FALLO: hubo reservas tras begin()");
+    return allocations == 0 ? 0 : 1;
+}
@@ -0,0 +1,228 @@
+// Equivalencia y rendimiento de los kernels de bloque (BlockKernels).
+//
+// Compilar y ejecutar en el host (sin Arduino):
+//   g++ -std=c++11 -O2 -Ilib/NoiseSensorI2CSlave/src tools/block_kernels_check/block_kernels_check.cpp
+//       lib/NoiseSensorI2CSlave/src/BlockKernels.cpp -o block_kernels_check
+//   ./block_kernels_check
+//
+// Compara blockStats()/blockSubtract() y sus versiones escalares con una referencia directa
+// (sumas en int64_t, saturación en int32_t) sobre bloques pseudoaleatorios de hasta 1024
+// muestras con cualquier alineación y offsets que saturan, y ejecuta blockKernelsSelfCheck(),
+// la misma comparación vectorial/escalar que begin() hace en el ESP32-S3. Devuelve 1 si
+// algún caso no coincide.
+//
+// En el host no hay PIE: blockStats() es la versión escalar y el rendimiento es el de la
+// referencia. Se da en muestras por µs y en ciclos (rdtsc en x86) o ns por muestra, con
+// bloques de 64 (la cadena de bloques) y de 1024. En el S3 la comparación PIE/escalar de
+// ciclos se hace con printStats() y -DNOISE_SIMD=0.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include "BlockKernels.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static const size_t MAX_SAMPLES = 1024;
+static const unsigned CASES = 20000;
+
+static uint64_t cycleCount() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static const char* cycleUnit() {
+#if defined(__x86_64__) || defined(__i386__)
+    return "ciclos";
+#else
+    return "ns";
+#endif
+}
+
+static double nowSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t lcg = 12345;
+
+static uint32_t nextRandom() {
+    lcg = lcg * 1664525u + 1013904223u;
+    return lcg;
+}
+
+// Referencia directa, sin los atajos de BlockKernels
+static void referenceStats(const int16_t* in, size_t n, BlockSums& out) {
+    out.sum = 0;
+    out.sumSq = 0;
+    out.minValue = INT16_MAX;
+    out.maxValue = INT16_MIN;
+    for (size_t i = 0; i < n; i++) {
+        out.sum += in[i];
+        out.sumSq += static_cast<uint64_t>(static_cast<int64_t>(in[i]) * in[i]);
+        out.minValue = in[i] < out.minValue ? in[i] : out.minValue;
+        out.maxValue = in[i] > out.maxValue ? in[i] : out.maxValue;
+    }
+}
+
+static void referenceSubtract(int16_t* samples, size_t n, int16_t offset) {
+    for (size_t i = 0; i < n; i++) {
+        const int32_t v = static_cast<int32_t>(samples[i]) - offset;
+        samples[i] = static_cast<int16_t>(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+    }
+}
+
+static bool sameSums(const BlockSums& a, const BlockSums& b) {
+    return a.sum == b.sum && a.sumSq == b.sumSq && a.minValue == b.minValue && a.maxValue == b.maxValue;
+}
+
+static int16_t randomSample(uint8_t pattern) {
+    const uint32_t r = nextRandom();
+    switch (pattern) {
+        case 0: return static_cast<int16_t>(r >> 16);                              // Todo el rango
+        case 1: return static_cast<int16_t>(1200 + static_cast<int16_t>(r >> 16) / 64);  // mV de micrófono
+        default: return (r >> 16) & 1 ? INT16_MIN : INT16_MAX;                    // Solo extremos
+    }
+}
+
+static unsigned long checkEquivalence() {
+    alignas(16) int16_t base[MAX_SAMPLES + 8];
+    alignas(16) int16_t expected[MAX_SAMPLES + 8];
+    alignas(16) int16_t actual[MAX_SAMPLES + 8];
+    alignas(16) int16_t scalar[MAX_SAMPLES + 8];
+    static const int16_t offsets[] = {0, 1, -1, 1234, -2048, INT16_MAX, INT16_MIN};
+    unsigned long failures = 0;
+
+    for (unsigned c = 0; c < CASES; c++) {
+        const uint8_t pattern = static_cast<uint8_t>(c % 3);
+        const size_t shift = nextRandom() % 8;
+        const size_t n = c < 2 * (MAX_SAMPLES + 1) ? c % (MAX_SAMPLES + 1) : nextRandom() % (MAX_SAMPLES + 1);
+        const int16_t offset = offsets[nextRandom() % (sizeof(offsets) / sizeof(offsets[0]))];
+        for (size_t i = 0; i < MAX_SAMPLES + 8; i++) {
+            base[i] = randomSample(pattern);
+        }
+
+        BlockSums ref, fast, slow;
+        referenceStats(&base[shift], n, ref);
+        blockStats(&base[shift], n, fast);
+        blockStatsScalar(&base[shift], n, slow);
+        if (!sameSums(ref, fast) || !sameSums(ref, slow)) {
+            if (failures++ < 5) {
+                printf("FALLO blockStats: n=%zu desplazamiento=%zu patrón=%u\n", n, shift, pattern);
+            }
+        }
+
+        memcpy(expected, base, sizeof(base));
+        memcpy(actual, base, sizeof(base));
+        memcpy(scalar, base, sizeof(base));
+        referenceSubtract(&expected[shift], n, offset);
+        blockSubtract(&actual[shift], n, offset);
+        blockSubtractScalar(&scalar[shift], n, offset);
+        if (memcmp(expected, actual, sizeof(base)) != 0 || memcmp(expected, scalar, sizeof(base)) != 0) {
+            if (failures++ < 5) {
+                printf("FALLO blockSubtract: n=%zu desplazamiento=%zu offset=%d\n", n, shift, offset);
+            }
+        }
+    }
+    return failures;
+}
+
+struct Timing {
+    double samplesPerUs;
+    double cyclesPerSample;
+};
+
+// Mejor de 5 pasadas sobre 4 M muestras en bloques de blockSize alineados a 16 bytes
+template <typename Kernel>
+static Timing measure(size_t blockSize, Kernel kernel) {
+    const size_t total = 1 << 22;
+    static std::vector<int16_t> buffer;
+    buffer.resize(total + 8);
+    int16_t* samples = buffer.data();
+    while (reinterpret_cast<uintptr_t>(samples) & 15) {
+        samples++;
+    }
+    for (size_t i = 0; i < total; i++) {
+        samples[i] = randomSample(1);
+    }
+    double bestSeconds = 1e9;
+    uint64_t bestCycles = UINT64_MAX;
+    for (int pass = 0; pass < 5; pass++) {
+        const double start = nowSeconds();
+        const uint64_t startCycles = cycleCount();
+        for (size_t i = 0; i + blockSize <= total; i += blockSize) {
+            kernel(&samples[i], blockSize);
+        }
+        const uint64_t cycles = cycleCount() - startCycles;
+        const double seconds = nowSeconds() - start;
+        bestSeconds = seconds < bestSeconds ? seconds : bestSeconds;
+        bestCycles = cycles < bestCycles ? cycles : bestCycles;
+    }
+    Timing t;
+    t.samplesPerUs = total / bestSeconds / 1e6;
+    t.cyclesPerSample = static_cast<double>(bestCycles) / total;
+    return t;
+}
+
+static volatile int64_t sink = 0;
+
+static void statsKernel(int16_t* in, size_t n) {
+    BlockSums s;
+    blockStats(in, n, s);
+    sink = sink + s.sum;
+}
+
+static void statsScalarKernel(int16_t* in, size_t n) {
+    BlockSums s;
+    blockStatsScalar(in, n, s);
+    sink = sink + s.sum;
+}
+
+// Restar y volver a sumar deja el buffer igual entre pasadas (sin saturar con mV de micrófono)
+static void subtractKernel(int16_t* in, size_t n) {
+    blockSubtract(in, n, 1200);
+    blockSubtract(in, n, -1200);
+}
+
+static void subtractScalarKernel(int16_t* in, size_t n) {
+    blockSubtractScalar(in, n, 1200);
+    blockSubtractScalar(in, n, -1200);
+}
+
+int main() {
+    const unsigned long failures = checkEquivalence();
+    printf("Referencia directa: %u casos (n de 0 a %zu, 8 alineaciones), %lu fallos\n", CASES, MAX_SAMPLES,
+           failures);
+    const uint32_t selfCheck = blockKernelsSelfCheck();
+    printf("blockKernelsSelfCheck(): %lu casos distintos (ruta %s)\n", static_cast<unsigned long>(selfCheck),
+           blockKernelsVectorized() ? "vectorial" : "escalar");
+
+    printf("\nRendimiento en el host (mejor de 5 pasadas):\n");
+    printf("%-22s %8s %14s %14s\n", "kernel", "bloque", "muestras/µs", cycleUnit());
+    const size_t blocks[] = {64, 1024};
+    for (size_t b = 0; b < sizeof(blocks) / sizeof(blocks[0]); b++) {
+        const Timing timings[] = {
+            measure(blocks[b], statsKernel),
+            measure(blocks[b], statsScalarKernel),
+            measure(blocks[b], subtractKernel),
+            measure(blocks[b], subtractScalarKernel),
+        };
+        static const char* names[] = {"blockStats", "blockStatsScalar", "blockSubtract", "blockSubtractScalar"};
+        for (size_t k = 0; k < 4; k++) {
+            // La resta se mide dos veces por pasada (ida y vuelta)
+            const double factor = k >= 2 ? 2.0 : 1.0;
+            printf("%-22s %8zu %14.0f %14.3f\n", names[k], blocks[b], timings[k].samplesPerUs * factor,
+                   timings[k].cyclesPerSample / factor);
+        }
+    }
+    return failures == 0 && selfCheck == 0 ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+// Precisión y coste de la calibración del ADC por tabla (AdcCalibration).
+//
+// Compilar y ejecutar en el host (sin Arduino):
+//   g++ -std=c++11 -O2 -Ilib/NoiseSensorI2CSlave/src tools/calibration_check/calibration_check.cpp
+//       lib/NoiseSensorI2CSlave/src/AdcCalibration.cpp -o calibration_check
+//   ./calibration_check
+//
+// Construye la tabla de 257 nodos con setCurve() a partir de varias curvas de referencia
+// (lineal y modelos suaves con la forma de las curvas de eFuse del C3 y del ESP32 a 11 dB,
+// evaluados en double como haría la calibración del chip en cada llamada) y compara los
+// 4096 códigos: error máximo y medio de toMilliVolts() frente a la curva en double,
+// y error de toCentiDb() frente a 20·log10(mV). Devuelve 1 si el error supera 1 mV o 2 centi-dB
+// (lo que prometen el README y FixedPoint.h).
+//
+// El coste por muestra se mide con el contador de ciclos del host (rdtsc en x86) para la
+// tabla y para la evaluación directa de la curva, que es lo que hace analogReadMilliVolts()
+// en cada llamada. El host tiene FPU; en el C3 la curva se evalúa en enteros de 64 bits y
+// el dB con log10f emulado, así que la diferencia es mayor.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+#include "AdcCalibration.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static const double TOLERANCE_MV = 1.0;
+static const double TOLERANCE_CENTI_DB = 2.0;
+
+static uint64_t cycleCount() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static const char* cycleUnit() {
+#if defined(__x86_64__) || defined(__i386__)
+    return "ciclos";
+#else
+    return "ns";
+#endif
+}
+
+// Curvas de referencia en double (mV para un código de 0 a 4095)
+static double linear2500(double raw) {
+    return raw * 2500.0 / 4096.0;
+}
+
+// Forma de la curva del C3 a 11 dB: casi lineal, curvatura suave en los extremos
+static double curveC3(double raw) {
+    return 0.62 * raw + 2.5e-5 * raw * raw - 3.0e-9 * raw * raw * raw;
+}
+
+// Forma de la curva del ESP32 a 11 dB: codo por encima de ~2.6 V
+static double curveEsp32(double raw) {
+    const double knee = raw > 3600 ? (raw - 3600) * (raw - 3600) * 1.2e-3 : 0;
+    return 142 + 0.8 * raw + knee;
+}
+
+struct Curve {
+    const char* name;
+    double (*model)(double raw);
+};
+
+static const Curve CURVES[] = {
+    {"lineal 2500 mV", linear2500},
+    {"modelo C3 11 dB", curveC3},
+    {"modelo ESP32 11 dB", curveEsp32},
+};
+
+static double (*currentModel)(double raw) = nullptr;
+
+static int32_t currentCurve(uint16_t raw) {
+    return static_cast<int32_t>(lround(currentModel(raw)));
+}
+
+struct Errors {
+    double maxMv;
+    double meanMv;
+    uint16_t worstCode;
+    double maxCentiDb;
+};
+
+static Errors compare(const AdcCalibration& cal) {
+    Errors e = {0, 0, 0, 0};
+    double sum = 0;
+    for (int raw = 0; raw < 4096; raw++) {
+        const double reference = currentModel(raw);
+        const double d = fabs(cal.toMilliVolts(raw) - reference);
+        sum += d;
+        if (d > e.maxMv) {
+            e.maxMv = d;
+            e.worstCode = static_cast<uint16_t>(raw);
+        }
+        // dB del valor entero en mV: el error de la tabla de log2, sin el de la interpolación
+        const int32_t mv = cal.toMilliVolts(raw);
+        if (mv > 0) {
+            const double dDb = fabs(cal.toCentiDb(raw) - 2000.0 * log10(static_cast<double>(mv)));
+            e.maxCentiDb = dDb > e.maxCentiDb ? dDb : e.maxCentiDb;
+        }
+    }
+    e.meanMv = sum / 4096;
+    return e;
+}
+
+// Ciclos por muestra: tabla frente a evaluación directa de la curva (mV y dB)
+static void benchmark(const AdcCalibration& cal) {
+    const size_t n = 1 << 20;
+    std::vector<int16_t> codes(n);
+    uint32_t lcg = 12345;
+    for (size_t i = 0; i < n; i++) {
+        lcg = lcg * 1664525u + 1013904223u;
+        codes[i] = static_cast<int16_t>(lcg >> 20);
+    }
+    uint64_t best[4] = {UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT64_MAX};
+    volatile int64_t sinkInt = 0;
+    volatile double sinkFloat = 0;
+
+    for (int pass = 0; pass < 5; pass++) {
+        int64_t acc = 0;
+        uint64_t start = cycleCount();
+        for (size_t i = 0; i < n; i++) {
+            acc += cal.toMilliVolts(codes[i]);
+        }
+        uint64_t elapsed = cycleCount() - start;
+        best[0] = elapsed < best[0] ? elapsed : best[0];
+        sinkInt = sinkInt + acc;
+
+        double facc = 0;
+        start = cycleCount();
+        for (size_t i = 0; i < n; i++) {
+            facc += curveC3(codes[i]);
+        }
+        elapsed = cycleCount() - start;
+        best[1] = elapsed < best[1] ? elapsed : best[1];
+        sinkFloat = sinkFloat + facc;
+
+        acc = 0;
+        start = cycleCount();
+        for (size_t i = 0; i < n; i++) {
+            const int32_t db = cal.toCentiDb(codes[i] | 1);
+            acc += db;
+        }
+        elapsed = cycleCount() - start;
+        best[2] = elapsed < best[2] ? elapsed : best[2];
+        sinkInt = sinkInt + acc;
+
+        float fdb = 0;
+        start = cycleCount();
+        for (size_t i = 0; i < n; i++) {
+            fdb += 20.0f * log10f(static_cast<float>(curveC3(codes[i] | 1)));
+        }
+        elapsed = cycleCount() - start;
+        best[3] = elapsed < best[3] ? elapsed : best[3];
+        sinkFloat = sinkFloat + fdb;
+    }
+    printf("\nCoste por muestra en el host (%zu códigos aleatorios, mejor de 5 pasadas):\n", n);
+    printf("  mV por tabla (toMilliVolts):         %.2f %s\n", static_cast<double>(best[0]) / n, cycleUnit());
+    printf("  mV evaluando la curva:               %.2f %s\n", static_cast<double>(best[1]) / n, cycleUnit());
+    printf("  dB por tabla (toCentiDb):            %.2f %s\n", static_cast<double>(best[2]) / n, cycleUnit());
+    printf("  dB con la curva y log10f:            %.2f %s\n", static_cast<double>(best[3]) / n, cycleUnit());
+}
+
+int main() {
+    bool ok = true;
+    AdcCalibration cal;
+    printf("%-20s %10s %10s %8s %12s\n", "Curva", "máx mV", "medio mV", "código", "máx cdB");
+    for (size_t i = 0; i < sizeof(CURVES) / sizeof(CURVES[0]); i++) {
+        currentModel = CURVES[i].model;
+        cal.setCurve(currentCurve);
+        const Errors e = compare(cal);
+        const bool pass = e.maxMv <= TOLERANCE_MV && e.maxCentiDb <= TOLERANCE_CENTI_DB;
+        ok = ok && pass;
+        printf("%-20s %10.3f %10.3f %8u %12.3f%s\n", CURVES[i].name, e.maxMv, e.meanMv, e.worstCode, e.maxCentiDb,
+               pass ? "" : "  FALLO");
+    }
+    printf("Tolerancia: %.1f mV, %.1f centi-dB\n", TOLERANCE_MV, TOLERANCE_CENTI_DB);
+
+    currentModel = curveC3;
+    cal.setCurve(currentCurve);
+    benchmark(cal);
+    return ok ? 0 : 1;
+}
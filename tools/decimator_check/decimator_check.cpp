@@ -0,0 +1,204 @@
+// Respuesta en frecuencia y rendimiento del decimador del ADC continuo (Decimator).
+//
+// Compilar y ejecutar en el host (sin Arduino):
+//   g++ -std=c++11 -O2 -Ilib/NoiseSensorI2CSlave/src tools/decimator_check/decimator_check.cpp
+//       lib/NoiseSensorI2CSlave/src/Decimator.cpp -o decimator_check
+//   ./decimator_check [ratio...]
+//
+// Para cada factor (por defecto 4, 8, 16, 32 y 64) pasa tonos de 12 bits con la DC del
+// micrófono, en bloques de 64 muestras como drainAdcStream(), y mide la ganancia de la
+// salida decimada con f relativa a la tasa de salida:
+//   - banda de paso (hasta 0.2·fs): ±0.5 dB;
+//   - transición (0.35·fs): -19.5 dB o menos;
+//   - banda eliminada (0.4·fs a 0.5·fs): -42 dB o menos;
+//   - alias: los tonos de entrada que se pliegan sobre la banda de paso, -34 dB o menos.
+// Devuelve 1 si alguna medida no cumple lo documentado en Decimator.h.
+//
+// El rendimiento se da en muestras de entrada por segundo y en ciclos (rdtsc en x86) o ns por
+// muestra. Es la cifra del host: en el C3 (160 MHz, sin multiplicación de 64 bits en un ciclo)
+// comparar con TRACE_DRAIN_ADC de las trazas.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+#include "Decimator.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static const size_t BLOCK = 64;
+static const double BIAS = 2048.0;
+static const double AMPLITUDE = 1500.0;
+
+static const double PASSBAND_DB = 0.5;
+static const double TRANSITION_DB = -19.5;
+static const double STOPBAND_DB = -42.0;
+static const double ALIAS_DB = -34.0;
+
+static uint64_t cycleCount() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static const char* cycleUnit() {
+#if defined(__x86_64__) || defined(__i386__)
+    return "ciclos";
+#else
+    return "ns";
+#endif
+}
+
+static double nowSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Ganancia en dB de un tono de entrada (frecuencia relativa a la tasa de entrada)
+static double measureGain(uint8_t ratio, double inputFreq) {
+    Decimator decimator;
+    decimator.setRatio(ratio);
+    const size_t outputs = 4096;
+    const size_t settle = 64;  // Transitorio del CIC y del FIR
+    const size_t n = (outputs + settle) * ratio;
+    int16_t in[BLOCK];
+    int16_t out[BLOCK / Decimator::MIN_RATIO + 1];
+    std::vector<double> y;
+    y.reserve(outputs + settle);
+
+    for (size_t i = 0; i < n; i += BLOCK) {
+        for (size_t k = 0; k < BLOCK; k++) {
+            in[k] = static_cast<int16_t>(lround(BIAS + AMPLITUDE * sin(2 * M_PI * inputFreq * (i + k))));
+        }
+        const size_t m = decimator.process(in, BLOCK, out);
+        for (size_t k = 0; k < m; k++) {
+            y.push_back(out[k]);
+        }
+    }
+
+    double mean = 0;
+    for (size_t k = settle; k < y.size(); k++) {
+        mean += y[k];
+    }
+    mean /= y.size() - settle;
+    double energy = 0;
+    for (size_t k = settle; k < y.size(); k++) {
+        energy += (y[k] - mean) * (y[k] - mean);
+    }
+    const double rms = sqrt(energy / (y.size() - settle));
+    // Por debajo de la cuantización de la salida la ganancia no se puede medir: se acota
+    const double floorRms = 0.5 / sqrt(3.0);
+    return 20.0 * log10((rms > floorRms ? rms : floorRms) / (AMPLITUDE / sqrt(2.0)));
+}
+
+struct Response {
+    double passMin, passMax;    // dB hasta 0.2·fs
+    double transition;          // dB a 0.35·fs
+    double stopMax;             // Peor dB entre 0.4·fs y 0.5·fs
+    double aliasMax;            // Peor dB de los tonos que se pliegan sobre la banda de paso
+    double aliasFreq;           // Frecuencia de entrada de ese tono, relativa a fs de salida
+};
+
+static Response measureResponse(uint8_t ratio) {
+    Response r = {1e9, -1e9, 0, -1e9, -1e9, 0};
+    // f relativa a la tasa de salida; la de entrada es f / ratio
+    for (double f = 0.01; f <= 0.2 + 1e-9; f += 0.01) {
+        const double g = measureGain(ratio, f / ratio);
+        r.passMin = g < r.passMin ? g : r.passMin;
+        r.passMax = g > r.passMax ? g : r.passMax;
+    }
+    r.transition = measureGain(ratio, 0.35 / ratio);
+    for (double f = 0.4; f <= 0.5 + 1e-9; f += 0.01) {
+        const double g = measureGain(ratio, f / ratio);
+        r.stopMax = g > r.stopMax ? g : r.stopMax;
+    }
+    // Tonos de entrada k·fs ± f (f en la banda de paso) hasta la frecuencia de Nyquist de entrada
+    for (unsigned k = 1; k <= ratio / 2u; k++) {
+        for (double f = 0.02; f <= 0.2 + 1e-9; f += 0.06) {
+            for (int sign = -1; sign <= 1; sign += 2) {
+                const double fin = k + sign * f;
+                if (fin >= ratio / 2.0) {
+                    continue;
+                }
+                const double g = measureGain(ratio, fin / ratio);
+                if (g > r.aliasMax) {
+                    r.aliasMax = g;
+                    r.aliasFreq = fin;
+                }
+            }
+        }
+    }
+    return r;
+}
+
+// Muestras de entrada por segundo con bloques de 64, como en drainAdcStream()
+static void benchmark(uint8_t ratio) {
+    Decimator decimator;
+    decimator.setRatio(ratio);
+    const size_t n = 1 << 22;
+    std::vector<int16_t> in(n);
+    for (size_t i = 0; i < n; i++) {
+        in[i] = static_cast<int16_t>(lround(BIAS + AMPLITUDE * sin(2 * M_PI * 0.013 * i)));
+    }
+    int16_t out[BLOCK / Decimator::MIN_RATIO + 1];
+    volatile int32_t sink = 0;
+    double bestSeconds = 1e9;
+    uint64_t bestCycles = UINT64_MAX;
+    for (int pass = 0; pass < 5; pass++) {
+        const double start = nowSeconds();
+        const uint64_t startCycles = cycleCount();
+        for (size_t i = 0; i < n; i += BLOCK) {
+            const size_t m = decimator.process(&in[i], BLOCK, out);
+            sink = sink + (m > 0 ? out[0] : 0);
+        }
+        const uint64_t cycles = cycleCount() - startCycles;
+        const double seconds = nowSeconds() - start;
+        bestSeconds = seconds < bestSeconds ? seconds : bestSeconds;
+        bestCycles = cycles < bestCycles ? cycles : bestCycles;
+    }
+    printf("  ratio %2u: %7.1f Mmuestras/s, %.2f %s por muestra de entrada\n", ratio,
+           n / bestSeconds / 1e6, static_cast<double>(bestCycles) / n, cycleUnit());
+}
+
+int main(int argc, char** argv) {
+    std::vector<uint8_t> ratios;
+    for (int i = 1; i < argc; i++) {
+        const unsigned long ratio = strtoul(argv[i], nullptr, 10);
+        if (ratio < Decimator::MIN_RATIO || ratio > Decimator::MAX_RATIO) {
+            fprintf(stderr, "Uso: decimator_check [ratio...]   (%u a %u)\n", Decimator::MIN_RATIO, Decimator::MAX_RATIO);
+            return 1;
+        }
+        ratios.push_back(static_cast<uint8_t>(ratio));
+    }
+    if (ratios.empty()) {
+        const uint8_t defaults[] = {4, 8, 16, 32, 64};
+        ratios.assign(defaults, defaults + sizeof(defaults));
+    }
+
+    bool ok = true;
+    printf("Respuesta (dB, f relativa a la tasa de salida):\n");
+    printf("%6s %18s %10s %14s %22s\n", "ratio", "paso 0-0.2", "0.35", "0.4-0.5", "peor alias");
+    for (size_t i = 0; i < ratios.size(); i++) {
+        const Response r = measureResponse(ratios[i]);
+        const bool pass = r.passMin >= -PASSBAND_DB && r.passMax <= PASSBAND_DB &&
+                          r.transition <= TRANSITION_DB && r.stopMax <= STOPBAND_DB && r.aliasMax <= ALIAS_DB;
+        ok = ok && pass;
+        printf("%6u %8.2f a %+6.2f %10.1f %14.1f %12.1f (%.2f·fs)%s\n", ratios[i], r.passMin, r.passMax,
+               r.transition, r.stopMax, r.aliasMax, r.aliasFreq, pass ? "" : "  FALLO");
+    }
+    printf("Límites: ±%.1f dB en la banda de paso, <= %.1f dB a 0.35·fs, <= %.0f dB desde 0.4·fs, alias <= %.0f dB\n",
+           PASSBAND_DB, TRANSITION_DB, STOPBAND_DB, ALIAS_DB);
+
+    printf("\nRendimiento en el host (bloques de %zu, mejor de 5 pasadas):\n", BLOCK);
+    for (size_t i = 0; i < ratios.size(); i++) {
+        benchmark(ratios[i]);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,281 @@
+// Equivalencia y coste de la ruta de punto fijo (NOISE_FIXED_POINT) frente a NoiseSensor.
+//
+// Compilar y ejecutar en el host (sin Arduino):
+//   g++ -std=gnu++11 -O2 -DNOISE_REPLAY=1 -DNOISE_FIXED_POINT=1 -Itools/host -Ilib/NoiseSensorI2CSlave/src
+//       tools/fixed_point_check/fixed_point_check.cpp tools/host/HostArduino.cpp lib/NoiseSensorI2CSlave/src/*.cpp -o fixed_point_check
+//   ./fixed_point_check [segundos] [tasa_hz]
+//
+// Genera una traza sintética con un tramo por escenario (DC del micrófono + tonos + ruido, códigos
+// de 12 bits; el firmware admite una sola instancia del esclavo) y pasa cada muestra a la vez por
+// el esclavo completo en el build de punto fijo (readAdcRaw() reproduce la traza) y por
+// NoiseSensor, la ruta float que el esclavo usa sin NOISE_FIXED_POINT (analogRead() simulado con
+// la misma muestra). En cada registro compara campo a campo el SensorData del esclavo con
+// getMeasurements(), y el Leq de SensorDataFixed con el del intervalo en double; el error cuenta
+// para el escenario en curso. Los ciclos de NoiseSensor se cierran como en el build float
+// (isCycleComplete() + resetCycle() en cada registro). Devuelve 1 si algún error supera la
+// tolerancia o si la traza no cierra ningún ciclo.
+//
+// El coste se mide con el contador de ciclos del host (rdtsc en x86) para la ruta entera y para
+// una ruta float por muestra (conversión y acumuladores en float, como NoiseSensor). El host tiene
+// FPU: en el ESP32-C3 cada operación float es una llamada de emulación y la diferencia es mayor.
+// Para la cifra real en el chip, comparar la línea "Ciclos de medida por update()" del log con
+// NOISE_FIXED_POINT=0 y =1 (misma lectura del ADC en ambos builds).
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include "HostArduino.h"
+#include "NoiseSensorI2CSlave.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#if !NOISE_REPLAY || !NOISE_FIXED_POINT
+#error "fixed_point_check necesita -DNOISE_REPLAY=1 -DNOISE_FIXED_POINT=1"
+#endif
+
+static const size_t BLOCK = 64;
+
+// Tolerancias: 1 mV de la interpolación de la tabla más el redondeo a mV enteros
+static const double TOLERANCE_MV = 1.5;
+static const double TOLERANCE_CENTI_DB = 3.0;
+
+static uint64_t cycleCount() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static const char* cycleUnit() {
+#if defined(__x86_64__) || defined(__i386__)
+    return "ciclos";
+#else
+    return "ns";
+#endif
+}
+
+struct Scenario {
+    const char* name;
+    double biasMv;
+    double toneMv;
+    double toneHz;
+    double noiseMv;
+};
+
+static uint32_t lcg = 12345;
+
+static double noise() {
+    lcg = lcg * 1664525u + 1013904223u;
+    return (static_cast<double>(lcg >> 8) / 16777216.0) * 2.0 - 1.0;
+}
+
+// Traza de tasa fija, un tramo de `seconds` por escenario. El tono sube y baja con un periodo
+// de 60 s: ciclos con niveles distintos
+static void synthesize(const Scenario* scenarios, size_t count, uint32_t seconds, uint32_t rateHz,
+                       std::vector<uint8_t>& out) {
+    TraceHeader header;
+    header.magic = TRACE_MAGIC;
+    header.version = TRACE_VERSION;
+    header.flags = TRACE_FLAG_FIXED_RATE;
+    header.reserved = 0;
+    header.sampleRateHz = rateHz;
+    header.sampleCount = static_cast<uint32_t>(count) * seconds * rateHz;
+    header.startUs = 1000000;
+    out.resize(sizeof(header) + header.sampleCount * sizeof(int16_t));
+    memcpy(out.data(), &header, sizeof(header));
+
+    int16_t* samples = reinterpret_cast<int16_t*>(out.data() + sizeof(header));
+    const uint32_t perScenario = seconds * rateHz;
+    for (uint32_t i = 0; i < header.sampleCount; i++) {
+        const Scenario& s = scenarios[i / perScenario];
+        const double t = static_cast<double>(i) / rateHz;
+        const double envelope = 0.5 + 0.5 * sin(2 * M_PI * t / 60.0);
+        const double mv = s.biasMv + envelope * s.toneMv * sin(2 * M_PI * s.toneHz * t) + s.noiseMv * noise();
+        const long code = lround(mv * 4096.0 / NOISE_ADC_FULL_SCALE_MV);
+        samples[i] = static_cast<int16_t>(code < 0 ? 0 : (code > 4095 ? 4095 : code));
+    }
+}
+
+static TraceReader* trace = nullptr;
+
+static uint16_t traceSample(uint8_t) {
+    return static_cast<uint16_t>(trace->getSample());
+}
+
+struct Errors {
+    double mv;
+    double centiDb;
+    const char* worstField;
+    unsigned long records;
+};
+
+static void check(Errors& e, const char* field, double fixed, double reference) {
+    const double d = fabs(fixed - reference);
+    if (d > e.mv) {
+        e.mv = d;
+        e.worstField = field;
+    }
+}
+
+// Esclavo de punto fijo y NoiseSensor sobre la misma traza, registro a registro. Devuelve los
+// ciclos cerrados al final.
+static uint32_t compare(TraceReader& reader, uint32_t perScenario, Errors* errors) {
+    trace = &reader;
+    hostSetAnalogSource(traceSample);
+    NoiseSensorI2CSlave::setReplaySource(&reader);
+    reader.next();
+    hostSetMicros(static_cast<uint64_t>(reader.getTimeUs()));
+
+    NoiseSensorI2CSlave::Config config;
+    config.updateInterval = 1000;
+    config.logLevel = NoiseSensor::LOG_NONE;
+    NoiseSensorI2CSlave sensor(config);
+    sensor.begin();
+    NoiseSensor::Config floatConfig;
+    floatConfig.adcPin = config.adcPin;
+    floatConfig.logLevel = NoiseSensor::LOG_NONE;
+    NoiseSensor reference(floatConfig);
+    reference.begin();
+
+    // Leq del intervalo en double (SensorDataFixed): desde el registro anterior
+    double energy = 0;
+    uint32_t count = 0;
+    uint64_t lastTimestamp = 0;
+    uint32_t index = 0;
+    do {
+        hostSetMicros(static_cast<uint64_t>(reader.getTimeUs()));
+        const double mv = reader.getSample() * static_cast<double>(NOISE_ADC_FULL_SCALE_MV) / 4096.0;
+        energy += mv * mv;
+        count++;
+        reference.update();
+        sensor.update();
+        Errors& e = errors[index++ / perScenario];
+
+        const SensorData& d = sensor.getData();
+        if (!sensor.isDataReady() || d.timestamp == lastTimestamp) {
+            continue;
+        }
+        lastTimestamp = d.timestamp;
+        const NoiseSensor::Measurements& m = reference.getMeasurements();
+        check(e, "noise", d.noise, m.noise);
+        check(e, "noiseAvg", d.noiseAvg, m.noiseAvg);
+        check(e, "noisePeak", d.noisePeak, m.noisePeak);
+        check(e, "noiseMin", d.noiseMin, m.noiseMin);
+        check(e, "noiseAvgLegal", d.noiseAvgLegal, m.noiseAvgLegal);
+        check(e, "noiseAvgLegalMax", d.noiseAvgLegalMax, m.noiseAvgLegalMax);
+        check(e, "lowNoiseLevel", d.lowNoiseLevel, m.lowNoiseLevel);
+        if (d.cycles != m.cycles) {
+            e.mv = 1e9;
+            e.worstField = "cycles";
+        }
+
+        // El registro de la primera verificación del ADC llega con el intervalo ya empezado
+        const SensorDataFixed& f = sensor.getDataFixed();
+        if (f.samples == count) {
+            const double dDb = fabs(f.leqCentiDb - 1000.0 * log10(energy / count));
+            e.centiDb = dDb > e.centiDb ? dDb : e.centiDb;
+        }
+        energy = 0;
+        count = 0;
+        e.records++;
+
+        // Como el build float: el registro que cumple el ciclo todavía lo incluye
+        if (reference.isCycleComplete()) {
+            reference.resetCycle();
+        }
+    } while (reader.next());
+    return sensor.getData().cycles;
+}
+
+// Coste por muestra de cada ruta sobre la misma señal (varias pasadas, la mejor)
+static void benchmark(const std::vector<int16_t>& raw, const AdcCalibration& cal) {
+    const size_t n = raw.size() - raw.size() % BLOCK;
+    uint64_t bestFixed = UINT64_MAX;
+    uint64_t bestFloat = UINT64_MAX;
+    volatile int64_t sinkFixed = 0;
+    volatile float sinkFloat = 0;
+    alignas(16) int16_t block[BLOCK];
+
+    for (int pass = 0; pass < 5; pass++) {
+        LevelStats stats;
+        uint64_t start = cycleCount();
+        for (size_t i = 0; i < n; i += BLOCK) {
+            for (size_t j = 0; j < BLOCK; j++) {
+                block[j] = static_cast<int16_t>(cal.toMilliVolts(raw[i + j]));
+            }
+            stats.addBlock(block, BLOCK);
+        }
+        sinkFixed = sinkFixed + stats.getLeqCentiDb();
+        uint64_t elapsed = cycleCount() - start;
+        bestFixed = elapsed < bestFixed ? elapsed : bestFixed;
+
+        const float scale = static_cast<float>(NOISE_ADC_FULL_SCALE_MV) / 4096.0f;
+        float sum = 0, energy = 0, minValue = 1e9f, maxValue = -1e9f;
+        start = cycleCount();
+        for (size_t i = 0; i < n; i++) {
+            const float mv = raw[i] * scale;
+            sum += mv;
+            energy += mv * mv;
+            if (mv < minValue) minValue = mv;
+            if (mv > maxValue) maxValue = mv;
+        }
+        sinkFloat = sinkFloat + 10.0f * log10f(energy / n) + sum + minValue + maxValue;
+        elapsed = cycleCount() - start;
+        bestFloat = elapsed < bestFloat ? elapsed : bestFloat;
+    }
+    printf("\nCoste por muestra en el host (%zu muestras, mejor de 5 pasadas):\n", n);
+    printf("  punto fijo (tabla + LevelStats por bloques): %.2f %s\n", static_cast<double>(bestFixed) / n, cycleUnit());
+    printf("  float (conversión + acumuladores float):     %.2f %s\n", static_cast<double>(bestFloat) / n, cycleUnit());
+}
+
+int main(int argc, char** argv) {
+    const uint32_t seconds = argc > 1 ? strtoul(argv[1], nullptr, 10) : 300;
+    const uint32_t rateHz = argc > 2 ? strtoul(argv[2], nullptr, 10) : 2000;
+    if (seconds == 0 || rateHz == 0) {
+        fprintf(stderr, "Uso: fixed_point_check [segundos] [tasa_hz]\n");
+        return 1;
+    }
+    AdcCalibration cal;
+    cal.setLinear(NOISE_ADC_FULL_SCALE_MV);
+
+    const Scenario scenarios[] = {
+        {"silencio", 1250, 2, 1000, 1},
+        {"conversación", 1250, 80, 440, 10},
+        {"tráfico", 1250, 400, 120, 60},
+        {"saturación", 1250, 1400, 1000, 40},
+    };
+    const size_t count = sizeof(scenarios) / sizeof(scenarios[0]);
+    std::vector<uint8_t> data;
+    synthesize(scenarios, count, seconds, rateHz, data);
+    TraceReader reader(data.data(), data.size());
+    Errors errors[count];
+    for (size_t i = 0; i < count; i++) {
+        errors[i] = Errors{0, 0, "-", 0};
+    }
+    const uint32_t cycles = compare(reader, seconds * rateHz, errors);
+
+    bool ok = cycles > 0;
+    printf("%-14s %9s %10s %10s  %s\n", "Escenario", "registros", "error mV", "error cdB", "campo peor");
+    for (size_t i = 0; i < count; i++) {
+        const Errors& e = errors[i];
+        const bool pass = e.records > 0 && e.mv <= TOLERANCE_MV && e.centiDb <= TOLERANCE_CENTI_DB;
+        ok = ok && pass;
+        printf("%-14s %9lu %10.3f %10.3f  %s%s\n", scenarios[i].name, e.records, e.mv, e.centiDb, e.worstField,
+               pass ? "" : "  FALLO");
+    }
+    printf("Ciclos cerrados: %lu%s\n", static_cast<unsigned long>(cycles), cycles > 0 ? "" : "  FALLO (traza corta)");
+    printf("Tolerancia: %.1f mV por campo, %.1f centi-dB\n", TOLERANCE_MV, TOLERANCE_CENTI_DB);
+
+    // Coste sobre el tramo del último escenario
+    const int16_t* samples = reinterpret_cast<const int16_t*>(data.data() + sizeof(TraceHeader));
+    const std::vector<int16_t> raw(samples + (count - 1) * seconds * rateHz, samples + count * seconds * rateHz);
+    benchmark(raw, cal);
+    return ok ? 0 : 1;
+}
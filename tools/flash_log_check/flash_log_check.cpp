@@ -0,0 +1,299 @@
+// Log en flash (FlashLog) sobre una flash simulada: integridad, búsqueda por tiempo, compresión y caudal.
+//
+// Compilar y ejecutar en el host (sin Arduino):
+//   g++ -std=c++11 -O2 -Ilib/NoiseSensorI2CSlave/src tools/flash_log_check/flash_log_check.cpp
+//       lib/NoiseSensorI2CSlave/src/FlashLog.cpp -o flash_log_check
+//   ./flash_log_check [KB de flash]
+//
+// La flash simulada (RamFlash) cumple las reglas de la NOR: una escritura solo puede pasar
+// bits de 1 a 0 y el borrado es por sectores de 4 KB. Cada escenario simula varios arranques
+// sobre la misma flash: unos con el reloj sincronizado desde el principio, otros sin
+// sincronizar (timestamps desde ~0 y un salto al tiempo del maestro a mitad del arranque),
+// unos con flush() al apagar y otros con corte de alimentación (se pierde la página en RAM).
+// Tras cada arranque comprueba:
+//   - que el log leído con next() es exactamente la cola de los registros confirmados;
+//   - que seekTime() coincide con un recorrido lineal (primer registro en orden del log con
+//     timestamp >= T) para cada timestamp del log, sus vecinos y los extremos.
+// El último escenario tiene más arranques que NOISE_LOG_MAX_RUNS (búsqueda lineal).
+// Devuelve 1 ante cualquier diferencia o escritura que viole las reglas de la NOR.
+//
+// Informa de la compresión (bytes de SensorData / bytes escritos en flash) y del caudal:
+// registros por segundo de CPU del host en append() y, con tiempos típicos de una NOR SPI
+// (programa de página 0.7 ms, borrado de sector 45 ms), los registros por segundo que
+// sostiene la flash.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include "FlashLog.h"
+
+static const double PAGE_PROGRAM_MS = 0.7;
+static const double SECTOR_ERASE_MS = 45.0;
+static const uint64_t MASTER_EPOCH_US = 1700000000000000ULL;
+
+class RamFlash : public LogFlashDevice {
+public:
+    explicit RamFlash(uint32_t bytes) : data(bytes, 0xFF), pagePrograms(0), sectorErases(0), violations(0) {}
+
+    uint32_t size() const override { return static_cast<uint32_t>(data.size()); }
+
+    bool read(uint32_t offset, void* dst, size_t len) override {
+        if (offset + len > data.size()) {
+            return false;
+        }
+        memcpy(dst, &data[offset], len);
+        return true;
+    }
+
+    bool write(uint32_t offset, const void* src, size_t len) override {
+        if (offset + len > data.size()) {
+            return false;
+        }
+        const uint8_t* bytes = static_cast<const uint8_t*>(src);
+        for (size_t i = 0; i < len; i++) {
+            if ((data[offset + i] & bytes[i]) != bytes[i]) {
+                violations++;  // Un 0 no vuelve a 1 sin borrar
+            }
+            data[offset + i] &= bytes[i];
+        }
+        pagePrograms++;
+        return true;
+    }
+
+    bool eraseSector(uint32_t offset) override {
+        if (offset % LOG_SECTOR_BYTES != 0 || offset + LOG_SECTOR_BYTES > data.size()) {
+            return false;
+        }
+        memset(&data[offset], 0xFF, LOG_SECTOR_BYTES);
+        sectorErases++;
+        return true;
+    }
+
+    std::vector<uint8_t> data;
+    unsigned long pagePrograms;
+    unsigned long sectorErases;
+    unsigned long violations;
+};
+
+static double nowSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Registro con niveles de un micrófono real: paseo aleatorio lento, ruido de 0.1 mV y los
+// campos de ciclo (media, máximo y mínimo acumulados) como los calcula el esclavo
+class RecordSource {
+public:
+    RecordSource() : lcg(12345), level(40.0f), cycles(0), legalSum(0), legalMax(0), lowNoise(0xFFFF) {}
+
+    SensorData make(uint64_t timestamp) {
+        level += (uniform() - 0.5f) * 2.0f;
+        level = level < 5.0f ? 5.0f : (level > 120.0f ? 120.0f : level);
+        SensorData d;
+        memset(&d, 0, sizeof(d));
+        d.noise = quantize(level + uniform());
+        d.noiseAvg = quantize(level);
+        d.noisePeak = quantize(level * 2.2f + uniform() * 4.0f);
+        d.noiseMin = quantize(level * 0.3f);
+        d.cycles = ++cycles;
+        legalSum += d.noise;
+        legalMax = d.noise > legalMax ? d.noise : legalMax;
+        lowNoise = static_cast<uint16_t>(d.noise) < lowNoise ? static_cast<uint16_t>(d.noise) : lowNoise;
+        d.noiseAvgLegal = quantize(static_cast<float>(legalSum / cycles));
+        d.noiseAvgLegalMax = legalMax;
+        d.lowNoiseLevel = lowNoise;
+        d.intervalMs = 1000;
+        d.timestamp = timestamp;
+        return d;
+    }
+
+private:
+    uint32_t lcg;
+    float level;
+    uint32_t cycles;
+    double legalSum;
+    float legalMax;
+    uint16_t lowNoise;
+
+    float uniform() {
+        lcg = lcg * 1664525u + 1013904223u;
+        return static_cast<float>(lcg >> 8) / 16777216.0f;
+    }
+    static float quantize(float mv) { return roundf(mv * 10.0f) / 10.0f; }
+};
+
+struct Scenario {
+    const char* name;
+    uint32_t flashKb;
+    unsigned boots;
+    unsigned recordsPerBoot;
+};
+
+struct Totals {
+    unsigned long records;
+    double appendSeconds;
+    unsigned long seeks;
+    unsigned long failures;
+};
+
+static bool sameRecord(const SensorData& a, const SensorData& b) {
+    return memcmp(&a, &b, sizeof(SensorData)) == 0;
+}
+
+// Compara el log con los registros confirmados y seekTime() con un recorrido lineal
+static unsigned long verify(FlashLog& log, const std::vector<SensorData>& committed, unsigned long& seeks,
+                            unsigned& runs) {
+    std::vector<SensorData> records;
+    std::vector<uint32_t> cursors;
+    SensorData record;
+    uint32_t cursor;
+    log.seekOldest();
+    while (log.next(record, cursor)) {
+        records.push_back(record);
+        cursors.push_back(cursor);
+    }
+
+    unsigned long failures = 0;
+    if (records.size() > committed.size() || records.empty() != committed.empty()) {
+        printf("  FALLO: %zu registros en el log, %zu confirmados\n", records.size(), committed.size());
+        return 1;
+    }
+    const size_t skip = committed.size() - records.size();
+    runs = records.empty() ? 0 : 1;
+    for (size_t i = 0; i < records.size(); i++) {
+        if (i > 0 && records[i].timestamp < records[i - 1].timestamp) {
+            runs++;
+        }
+        if (!sameRecord(records[i], committed[skip + i])) {
+            printf("  FALLO: el registro %zu del log no coincide con el confirmado %zu\n", i, skip + i);
+            return 1;
+        }
+    }
+
+    std::vector<uint64_t> targets;
+    targets.push_back(0);
+    targets.push_back(UINT64_MAX);
+    for (size_t i = 0; i < records.size(); i++) {
+        targets.push_back(records[i].timestamp);
+        targets.push_back(records[i].timestamp + 1);
+        if (records[i].timestamp > 0) {
+            targets.push_back(records[i].timestamp - 1);
+        }
+    }
+    for (size_t t = 0; t < targets.size(); t++) {
+        size_t expected = records.size();
+        for (size_t i = 0; i < records.size(); i++) {
+            if (records[i].timestamp >= targets[t]) {
+                expected = i;
+                break;
+            }
+        }
+        log.seekTime(targets[t]);
+        const bool found = log.next(record, cursor);
+        const bool ok = expected == records.size() ? !found
+                                                   : found && cursor == cursors[expected] &&
+                                                         sameRecord(record, records[expected]);
+        seeks++;
+        if (!ok) {
+            if (failures++ < 5) {
+                printf("  FALLO: seekTime(%llu) esperaba el registro %zu de %zu\n",
+                       static_cast<unsigned long long>(targets[t]), expected, records.size());
+            }
+        }
+    }
+    return failures;
+}
+
+static bool runScenario(const Scenario& scenario, Totals& totals) {
+    RamFlash flash(scenario.flashKb * 1024);
+    FlashLog log;
+    RecordSource source;
+    std::vector<SensorData> committed;
+    uint64_t masterUs = MASTER_EPOCH_US;
+    unsigned long failures = 0;
+    unsigned runs = 0;
+
+    printf("%s: %u KB, %u arranques de %u registros\n", scenario.name, scenario.flashKb, scenario.boots,
+           scenario.recordsPerBoot);
+    for (unsigned boot = 0; boot < scenario.boots; boot++) {
+        if (!log.begin(&flash)) {
+            printf("  FALLO: begin() con %u KB\n", scenario.flashKb);
+            return false;
+        }
+        // Arranques pares sincronizados; impares sin sincronizar hasta la mitad
+        const bool synced = boot % 2 == 0;
+        uint64_t localUs = 1000000 + (boot % 3) * 250000;
+        const double start = nowSeconds();
+        for (unsigned i = 0; i < scenario.recordsPerBoot; i++) {
+            const bool useMaster = synced || i >= scenario.recordsPerBoot / 2;
+            const SensorData d = source.make(useMaster ? masterUs : localUs);
+            log.append(d);
+            committed.push_back(d);
+            localUs += 1000000;
+            masterUs += 1000000;
+        }
+        totals.appendSeconds += nowSeconds() - start;
+        totals.records += scenario.recordsPerBoot;
+
+        // Un arranque de cada tres termina con corte de alimentación: se pierde la página en RAM
+        if (boot % 3 == 2) {
+            const size_t inRam = log.getNextCursor() & 0xFF;
+            committed.resize(committed.size() - inRam);
+            log.begin(&flash);
+        } else {
+            log.flush();
+        }
+        failures += verify(log, committed, totals.seeks, runs);
+        masterUs += 3600000000ULL;  // Una hora apagado
+    }
+    // Arranque final sin registros: tramos reconstruidos solo desde las cabeceras
+    const uint32_t rawBytes = log.getRawBytes();
+    const uint32_t storedBytes = log.getStoredBytes();
+    log.begin(&flash);
+    failures += verify(log, committed, totals.seeks, runs);
+
+    const double flashMs = flash.pagePrograms * PAGE_PROGRAM_MS + flash.sectorErases * SECTOR_ERASE_MS;
+    const unsigned long records = static_cast<unsigned long>(scenario.boots) * scenario.recordsPerBoot;
+    printf("  compresión %.2f (%lu -> %lu bytes), %lu páginas, %lu borrados\n",
+           storedBytes ? static_cast<double>(rawBytes) / storedBytes : 0.0, static_cast<unsigned long>(rawBytes),
+           static_cast<unsigned long>(storedBytes), flash.pagePrograms, flash.sectorErases);
+    printf("  %u tramos en el log al final%s\n", runs, runs > NOISE_LOG_MAX_RUNS + 1 ? " (búsqueda lineal)" : "");
+    printf("  flash ocupada %.1f ms por página escrita, %.0f registros/s sostenidos por la flash\n",
+           flash.pagePrograms ? flashMs / flash.pagePrograms : 0.0, flashMs > 0 ? records * 1000.0 / flashMs : 0.0);
+    if (flash.violations != 0) {
+        printf("  FALLO: %lu bytes escritos sin borrar\n", flash.violations);
+        failures++;
+    }
+    totals.failures += failures;
+    return failures == 0;
+}
+
+int main(int argc, char** argv) {
+    const uint32_t flashKb = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 64;
+    if (flashKb < 2 * LOG_SECTOR_BYTES / 1024) {
+        fprintf(stderr, "Uso: flash_log_check [KB de flash]   (al menos %u)\n",
+                static_cast<unsigned>(2 * LOG_SECTOR_BYTES / 1024));
+        return 1;
+    }
+    const Scenario scenarios[] = {
+        {"Sin vuelta", flashKb, 6, 300},
+        {"Con vuelta", flashKb, 12, 1500},
+        {"Más tramos que NOISE_LOG_MAX_RUNS", flashKb, 2 * NOISE_LOG_MAX_RUNS + 6, 40},
+    };
+    Totals totals = {0, 0, 0, 0};
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        ok = runScenario(scenarios[i], totals) && ok;
+    }
+    printf("\n%lu registros, %lu búsquedas comprobadas, %lu fallos\n", totals.records, totals.seeks,
+           totals.failures);
+    if (totals.appendSeconds > 0) {
+        printf("append() en el host: %.2f Mregistros/s (CPU, sin el tiempo de la flash)\n",
+               totals.records / totals.appendSeconds / 1e6);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,370 @@
+// Simulador de flota I2C: estima cuántos esclavos NoiseSensorI2CSlave puede atender un
+// maestro y con qué frescura, sobre un bus virtual con coste por bit.
+//
+// Compilar y ejecutar en el host (sin Arduino):
+//   g++ -std=c++11 -O2 -Ilib/NoiseSensorI2CSlave/src tools/fleet_sim/fleet_sim.cpp -o fleet_sim
+//   ./fleet_sim --slaves 128 --interval 1000 --duration 60
+//
+// Cada esclavo simulado reproduce la lógica de onReceive()/onRequest() del esclavo real
+// (registro de último comando, respuesta 0x00 si no hay datos, latch) con las estructuras
+// de I2CProtocol.h, así que los tamaños de trama son los del firmware.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "I2CProtocol.h"
+
+static const int64_t NS_PER_US = 1000;
+static const int64_t NS_PER_MS = 1000000;
+static const int64_t NS_PER_S = 1000000000;
+static const size_t ADDRESSES_PER_BUS = MAX_I2C_ADDRESS - MIN_I2C_ADDRESS + 1;
+
+// Modelo de coste del bus: cada byte son 9 bits (8 + ACK), más START y STOP
+struct BusModel {
+    uint32_t hz;
+    int64_t gapNs;          // Hueco del maestro entre transacciones
+    int64_t turnaroundNs;   // Espera entre la escritura del comando y la lectura (delayMicroseconds(200))
+
+    int64_t bitNs() const { return NS_PER_S / hz; }
+    int64_t transferNs(size_t bytes) const {
+        return static_cast<int64_t>(1 + 9 * (1 + bytes) + 1) * bitNs();
+    }
+};
+
+// Esclavo simulado: misma máquina de estados que NoiseSensorI2CSlave::onReceive()/onRequest()
+class SimSlave {
+public:
+    SimSlave(uint8_t address, int64_t periodNs, int64_t phaseNs)
+        : address(address), periodNs(periodNs), nextDeadlineNs(phaseNs), lastCommand(CMD_GET_STATUS),
+          dataReady(false), snapshotReady(false), recordNs(0), recordSeq(0), snapshotNs(0), snapshotSeq(0),
+          lastReadSeq(0), recordsRead(0), ageSumNs(0), ageReads(0) {
+        memset(&data, 0, sizeof(data));
+        memset(&snapshot, 0, sizeof(snapshot));
+    }
+
+    // Agregación en plazos absolutos (DeadlineScheduler)
+    void advance(int64_t nowNs) {
+        while (nowNs >= nextDeadlineNs) {
+            recordNs = nextDeadlineNs;
+            recordSeq++;
+            data.cycles = recordSeq;
+            data.timestamp = static_cast<uint64_t>(recordNs / NS_PER_US);
+            dataReady = true;
+            nextDeadlineNs += periodNs;
+        }
+    }
+
+    void onReceive(const uint8_t* bytes, size_t n, int64_t nowNs) {
+        if (n == 0) {
+            return;
+        }
+        lastCommand = bytes[0];
+        if (lastCommand == CMD_LATCH) {
+            latch(nowNs);
+        }
+    }
+
+    // Línea de latch compartida (sin coste de bus): congela la ventana en curso
+    void latch(int64_t nowNs) {
+        advance(nowNs);
+        snapshot.data = data;
+        snapshot.data.timestamp = static_cast<uint64_t>(nowNs / NS_PER_US);
+        snapshot.sequence++;
+        snapshotNs = nowNs;
+        snapshotSeq = snapshot.sequence;
+        snapshotReady = true;
+    }
+
+    size_t onRequest(uint8_t* out, int64_t nowNs) {
+        advance(nowNs);
+        size_t len = 0;
+        switch (lastCommand) {
+            case CMD_GET_DATA:
+                if (dataReady) { memcpy(out, &data, sizeof(data)); len = sizeof(data); }
+                break;
+            case CMD_GET_AVG:
+                memcpy(out, &data.noiseAvg, sizeof(float)); len = sizeof(float);
+                break;
+            case CMD_GET_STATUS:
+                out[0] = dataReady ? 0x01 : 0x00; len = 1;
+                break;
+            case CMD_GET_SNAPSHOT:
+                if (snapshotReady) { memcpy(out, &snapshot, sizeof(snapshot)); len = sizeof(snapshot); }
+                break;
+            default:
+                break;
+        }
+        if (len == 0) {
+            out[0] = 0x00;
+            len = 1;
+        }
+        return len;
+    }
+
+    // Registro entregado con la última respuesta (verdad de la simulación, no visible al maestro)
+    int64_t deliveredNs() const { return lastCommand == CMD_GET_SNAPSHOT ? snapshotNs : recordNs; }
+    uint32_t deliveredSeq() const { return lastCommand == CMD_GET_SNAPSHOT ? snapshotSeq : recordSeq; }
+
+    uint8_t address;
+    int64_t periodNs;
+    int64_t nextDeadlineNs;
+    uint8_t lastCommand;
+    bool dataReady;
+    bool snapshotReady;
+    SensorData data;
+    SensorSnapshot snapshot;
+    int64_t recordNs;
+    uint32_t recordSeq;
+    int64_t snapshotNs;
+    uint32_t snapshotSeq;
+    uint32_t lastReadSeq;
+    uint32_t recordsRead;
+    int64_t ageSumNs;
+    uint32_t ageReads;
+};
+
+enum Protocol { PROTO_DATA, PROTO_AVG, PROTO_SNAPSHOT };
+enum Strategy { STRAT_GREEDY, STRAT_PERIODIC, STRAT_ALIGNED };
+
+static const char* protocolName(Protocol p) {
+    return p == PROTO_DATA ? "GET_DATA" : p == PROTO_AVG ? "GET_AVG" : "LATCH+SNAPSHOT";
+}
+
+static const char* strategyName(Strategy s) {
+    return s == STRAT_GREEDY ? "greedy" : s == STRAT_PERIODIC ? "periodic" : "aligned";
+}
+
+struct SimOptions {
+    size_t slaves = 128;
+    int64_t intervalNs = 1000 * NS_PER_MS;
+    int64_t durationNs = 60 * NS_PER_S;
+    int64_t turnaroundNs = 200 * NS_PER_US;
+    int64_t gapNs = 50 * NS_PER_US;
+    size_t perChannel = 0;  // Esclavos por canal del multiplexor (0 = sin multiplexor si caben)
+    uint32_t seed = 1;
+};
+
+struct SimResult {
+    uint64_t polls;
+    double pollsPerSec;
+    double sweepsPerSec;
+    double utilization;
+    double meanAgeMs;
+    double maxAgeMs;
+    double worstSlaveAgeMs;   // Mayor edad media de un esclavo
+    double missedPct;
+};
+
+class FleetSim {
+public:
+    FleetSim(const SimOptions& opt, const BusModel& bus, Protocol proto, Strategy strat)
+        : opt(opt), bus(bus), proto(proto), strat(strat), nowNs(0), wireNs(0), currentChannel(-1),
+          polls(0), ageSumNs(0), ageMaxNs(0) {
+        uint32_t rng = opt.seed;
+        for (size_t i = 0; i < opt.slaves; i++) {
+            // Fase de arranque aleatoria (LCG determinista): los esclavos no agregan a la vez
+            rng = rng * 1664525u + 1013904223u;
+            const int64_t phase = static_cast<int64_t>(rng % static_cast<uint32_t>(opt.intervalNs / NS_PER_US)) * NS_PER_US;
+            slaves.push_back(SimSlave(static_cast<uint8_t>(MIN_I2C_ADDRESS + i % ADDRESSES_PER_BUS), opt.intervalNs, phase));
+        }
+    }
+
+    SimResult run() {
+        size_t next = 0;
+        int64_t sweepStartNs = 0;
+        while (nowNs < opt.durationNs) {
+            if (next == 0 && proto == PROTO_SNAPSHOT) {
+                if (strat != STRAT_GREEDY) {
+                    waitUntil(sweepStartNs);
+                    sweepStartNs = std::max(sweepStartNs + opt.intervalNs, nowNs);
+                }
+                for (size_t i = 0; i < slaves.size(); i++) {
+                    slaves[i].latch(nowNs);
+                }
+            }
+
+            size_t target = next;
+            if (proto != PROTO_SNAPSHOT) {
+                if (strat == STRAT_PERIODIC) {
+                    // Sondeos repartidos uniformemente en cada intervalo
+                    waitUntil(sweepStartNs + static_cast<int64_t>(next) * opt.intervalNs / static_cast<int64_t>(slaves.size()));
+                    if (next + 1 == slaves.size()) {
+                        sweepStartNs += opt.intervalNs;
+                    }
+                } else if (strat == STRAT_ALIGNED) {
+                    // Con la fase conocida (TIME_SYNC), sondear el esclavo cuyo registro nuevo es más antiguo
+                    target = pickAligned();
+                }
+            }
+
+            poll(target);
+            next = (next + 1) % slaves.size();
+        }
+        return result();
+    }
+
+private:
+    const SimOptions& opt;
+    BusModel bus;
+    Protocol proto;
+    Strategy strat;
+    std::vector<SimSlave> slaves;
+    int64_t nowNs;
+    int64_t wireNs;
+    int currentChannel;
+    uint64_t polls;
+    int64_t ageSumNs;
+    int64_t ageMaxNs;
+
+    void waitUntil(int64_t t) {
+        if (t > nowNs) nowNs = t;
+    }
+
+    size_t pickAligned() {
+        size_t best = 0;
+        int64_t bestNs = INT64_MAX;
+        int64_t earliestNextNs = INT64_MAX;
+        for (size_t i = 0; i < slaves.size(); i++) {
+            SimSlave& s = slaves[i];
+            s.advance(nowNs);
+            if (s.recordSeq != s.lastReadSeq && s.recordNs < bestNs) {
+                bestNs = s.recordNs;
+                best = i;
+            }
+            earliestNextNs = std::min(earliestNextNs, s.nextDeadlineNs);
+        }
+        if (bestNs == INT64_MAX) {
+            waitUntil(earliestNextNs);
+            return pickAligned();
+        }
+        return best;
+    }
+
+    void transaction(size_t bytes) {
+        const int64_t t = bus.transferNs(bytes);
+        nowNs += t + bus.gapNs;
+        wireNs += t;
+    }
+
+    void selectChannel(size_t index) {
+        if (opt.perChannel == 0) return;
+        const int channel = static_cast<int>(index / opt.perChannel);
+        if (channel != currentChannel) {
+            transaction(1);  // Escritura del registro de canal del multiplexor (TCA9548A)
+            currentChannel = channel;
+        }
+    }
+
+    void poll(size_t index) {
+        SimSlave& s = slaves[index];
+        selectChannel(index);
+
+        const uint8_t cmd = proto == PROTO_DATA ? CMD_GET_DATA : proto == PROTO_AVG ? CMD_GET_AVG : CMD_GET_SNAPSHOT;
+        transaction(1);
+        s.onReceive(&cmd, 1, nowNs);
+        nowNs += bus.turnaroundNs;
+
+        uint8_t out[RESPONSE_BUFFER_SIZE];
+        const size_t expected = proto == PROTO_DATA ? sizeof(SensorData) : proto == PROTO_AVG ? sizeof(float) : sizeof(SensorSnapshot);
+        const size_t len = s.onRequest(out, nowNs);
+        transaction(expected);  // El maestro pide siempre la trama completa
+        polls++;
+
+        if (len == expected) {
+            const int64_t age = nowNs - s.deliveredNs();
+            ageSumNs += age;
+            ageMaxNs = std::max(ageMaxNs, age);
+            s.ageSumNs += age;
+            s.ageReads++;
+            if (s.deliveredSeq() != s.lastReadSeq) {
+                s.lastReadSeq = s.deliveredSeq();
+                s.recordsRead++;
+            }
+        }
+    }
+
+    SimResult result() const {
+        SimResult r;
+        const double seconds = static_cast<double>(nowNs) / NS_PER_S;
+        r.polls = polls;
+        r.pollsPerSec = polls / seconds;
+        r.sweepsPerSec = r.pollsPerSec / slaves.size();
+        r.utilization = static_cast<double>(wireNs) / nowNs;
+        r.meanAgeMs = polls ? static_cast<double>(ageSumNs) / polls / NS_PER_MS : 0.0;
+        r.maxAgeMs = static_cast<double>(ageMaxNs) / NS_PER_MS;
+        uint64_t generated = 0;
+        uint64_t read = 0;
+        r.worstSlaveAgeMs = 0.0;
+        for (size_t i = 0; i < slaves.size(); i++) {
+            const SimSlave& s = slaves[i];
+            // Con snapshots cada latch es un registro; si no, cada agregación
+            generated += proto == PROTO_SNAPSHOT ? s.snapshot.sequence : s.recordSeq;
+            read += s.recordsRead;
+            if (s.ageReads > 0) {
+                r.worstSlaveAgeMs = std::max(r.worstSlaveAgeMs, static_cast<double>(s.ageSumNs) / s.ageReads / NS_PER_MS);
+            }
+        }
+        r.missedPct = generated ? 100.0 * (generated - std::min(read, generated)) / generated : 0.0;
+        return r;
+    }
+};
+
+static void usage() {
+    printf("Uso: fleet_sim [--slaves N] [--interval ms] [--duration s] [--turnaround us] [--gap us] [--per-channel N] [--seed N]\n");
+}
+
+int main(int argc, char** argv) {
+    SimOptions opt;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        const long value = hasValue ? strtol(argv[i + 1], nullptr, 10) : 0;
+        if (!strcmp(argv[i], "--slaves") && hasValue) { opt.slaves = static_cast<size_t>(value); i++; }
+        else if (!strcmp(argv[i], "--interval") && hasValue) { opt.intervalNs = value * NS_PER_MS; i++; }
+        else if (!strcmp(argv[i], "--duration") && hasValue) { opt.durationNs = value * NS_PER_S; i++; }
+        else if (!strcmp(argv[i], "--turnaround") && hasValue) { opt.turnaroundNs = value * NS_PER_US; i++; }
+        else if (!strcmp(argv[i], "--gap") && hasValue) { opt.gapNs = value * NS_PER_US; i++; }
+        else if (!strcmp(argv[i], "--per-channel") && hasValue) { opt.perChannel = static_cast<size_t>(value); i++; }
+        else if (!strcmp(argv[i], "--seed") && hasValue) { opt.seed = static_cast<uint32_t>(value); i++; }
+        else { usage(); return 1; }
+    }
+    if (opt.slaves == 0 || opt.intervalNs < NS_PER_MS || opt.durationNs <= 0 ||
+        opt.perChannel > ADDRESSES_PER_BUS) {
+        usage();
+        return 1;
+    }
+    // Más esclavos que direcciones: árbol con multiplexor
+    if (opt.perChannel == 0 && opt.slaves > ADDRESSES_PER_BUS) {
+        opt.perChannel = ADDRESSES_PER_BUS;
+    }
+
+    printf("Esclavos: %zu | intervalo %lld ms | turnaround %lld us | hueco %lld us | canales %zu\n\n",
+           opt.slaves, static_cast<long long>(opt.intervalNs / NS_PER_MS),
+           static_cast<long long>(opt.turnaroundNs / NS_PER_US), static_cast<long long>(opt.gapNs / NS_PER_US),
+           opt.perChannel ? (opt.slaves + opt.perChannel - 1) / opt.perChannel : static_cast<size_t>(1));
+    printf("%-7s %-15s %-9s %10s %10s %7s %11s %11s %11s %8s\n",
+           "Bus", "Protocolo", "Sondeo", "sondeos/s", "barridos/s", "uso", "edad med", "edad máx", "peor esclavo", "perdidos");
+
+    const uint32_t speeds[] = {100000, 400000, 1000000};
+    const Protocol protocols[] = {PROTO_DATA, PROTO_AVG, PROTO_SNAPSHOT};
+    const Strategy strategies[] = {STRAT_GREEDY, STRAT_PERIODIC, STRAT_ALIGNED};
+
+    for (uint32_t hz : speeds) {
+        for (Protocol p : protocols) {
+            for (Strategy s : strategies) {
+                if (p == PROTO_SNAPSHOT && s == STRAT_ALIGNED) {
+                    continue;  // El latch ya alinea todos los esclavos
+                }
+                BusModel bus = {hz, opt.gapNs, opt.turnaroundNs};
+                FleetSim sim(opt, bus, p, s);
+                const SimResult r = sim.run();
+                printf("%4lu k  %-15s %-9s %10.1f %10.3f %6.1f%% %8.1f ms %8.1f ms %8.1f ms %7.1f%%\n",
+                       static_cast<unsigned long>(hz / 1000), protocolName(p), strategyName(s),
+                       r.pollsPerSec, r.sweepsPerSec, 100.0 * r.utilization, r.meanAgeMs, r.maxAgeMs,
+                       r.worstSlaveAgeMs, r.missedPct);
+            }
+        }
+    }
+    return 0;
+}
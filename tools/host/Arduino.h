@@ -0,0 +1,75 @@
+#ifndef NOISE_HOST_ARDUINO_H
+#define NOISE_HOST_ARDUINO_H
+
+// Núcleo Arduino mínimo para compilar la librería en el host (herramientas de tools/).
+// Reloj, ADC y bus son simulados y los controla el programa de prueba (HostArduino.h).
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define IRAM_ATTR
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define FALLING 0x02
+#define ADC_11db 3
+#define digitalPinToInterrupt(p) (p)
+#define digitalPinToAnalogChannel(p) (p)
+
+typedef int adc_attenuation_t;
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t b) { return write(&b, 1); }
+    virtual size_t write(const uint8_t* buffer, size_t size) = 0;
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int availableForWrite() { return 0x7FFF; }
+    using Print::write;
+};
+
+// Serie del host: escribe en hostSerialOutput (nullptr = descartar)
+class HostSerial : public Stream {
+public:
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    size_t print(const char* text) { return write(reinterpret_cast<const uint8_t*>(text), strlen(text)); }
+    size_t println(const char* text = "") { return print(text) + print("\n"); }
+};
+
+extern HostSerial Serial;
+
+class EspClass {
+public:
+    uint32_t getFreeHeap();
+    uint32_t getMaxAllocHeap() { return getFreeHeap(); }
+    uint32_t getCycleCount();
+};
+
+extern EspClass ESP;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+uint16_t analogRead(uint8_t pin);
+void analogSetPinAttenuation(uint8_t pin, adc_attenuation_t attenuation);
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+uint32_t getCpuFrequencyMhz();
+
+#endif // NOISE_HOST_ARDUINO_H
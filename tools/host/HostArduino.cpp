@@ -0,0 +1,127 @@
+#include "HostArduino.h"
+
+HostSerial Serial;
+EspClass ESP;
+TwoWire Wire;
+TwoWire Wire1;
+FILE* hostSerialOutput = nullptr;
+size_t hostHeapUsed = 0;
+
+// Heap libre nominal de un ESP32-C3 tras arrancar Wi-Fi apagado
+static const uint32_t HOST_HEAP_BYTES = 300000;
+static const uint8_t HOST_PINS = 64;
+
+static uint64_t hostMicros = 0;
+static uint16_t (*analogSource)(uint8_t) = nullptr;
+static int8_t pinLevels[HOST_PINS];
+static bool pinLevelsReady = false;
+
+size_t HostSerial::write(const uint8_t* buffer, size_t size) {
+    if (hostSerialOutput != nullptr) {
+        fwrite(buffer, 1, size, hostSerialOutput);
+    }
+    return size;
+}
+
+uint32_t EspClass::getFreeHeap() {
+    return hostHeapUsed < HOST_HEAP_BYTES ? static_cast<uint32_t>(HOST_HEAP_BYTES - hostHeapUsed) : 0;
+}
+
+uint32_t EspClass::getCycleCount() {
+    return static_cast<uint32_t>(hostMicros * 160);
+}
+
+void hostSetMicros(uint64_t us) { hostMicros = us; }
+void hostAdvanceMicros(uint64_t us) { hostMicros += us; }
+void hostSetAnalogSource(uint16_t (*source)(uint8_t)) { analogSource = source; }
+
+void hostSetPinLevel(uint8_t pin, int level) {
+    if (!pinLevelsReady) {
+        memset(pinLevels, HIGH, sizeof(pinLevels));
+        pinLevelsReady = true;
+    }
+    if (pin < HOST_PINS) {
+        pinLevels[pin] = static_cast<int8_t>(level);
+    }
+}
+
+unsigned long millis() { return static_cast<unsigned long>(hostMicros / 1000); }
+unsigned long micros() { return static_cast<unsigned long>(hostMicros); }
+void delay(unsigned long ms) { hostMicros += ms * 1000ULL; }
+void delayMicroseconds(unsigned int us) { hostMicros += us; }
+
+uint16_t analogRead(uint8_t pin) {
+    return analogSource != nullptr ? analogSource(pin) : 2048;
+}
+
+void analogSetPinAttenuation(uint8_t, adc_attenuation_t) {}
+void pinMode(uint8_t, uint8_t) {}
+
+int digitalRead(uint8_t pin) {
+    return (pinLevelsReady && pin < HOST_PINS) ? pinLevels[pin] : HIGH;
+}
+
+void attachInterrupt(uint8_t, void (*)(), int) {}
+uint32_t getCpuFrequencyMhz() { return 160; }
+
+// --- Wire ---
+
+TwoWire::TwoWire()
+    : requestCallback(nullptr), receiveCallback(nullptr), slave(false), begins(0),
+      rxLen(0), rxPos(0), txBuffer(nullptr), txMax(0), txLen(0) {}
+
+bool TwoWire::begin(uint8_t, int, int, uint32_t) {
+    slave = true;
+    begins++;
+    return true;
+}
+
+bool TwoWire::begin(int, int, uint32_t) {
+    slave = false;
+    begins++;
+    return true;
+}
+
+bool TwoWire::end() {
+    slave = false;
+    requestCallback = nullptr;
+    receiveCallback = nullptr;
+    return true;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t len) {
+    size_t n = 0;
+    while (n < len && txLen < txMax) {
+        txBuffer[txLen++] = data[n++];
+    }
+    return n;
+}
+
+size_t TwoWire::readBytes(uint8_t* out, size_t len) {
+    size_t n = 0;
+    while (n < len && rxPos < rxLen) {
+        out[n++] = rx[rxPos++];
+    }
+    return n;
+}
+
+size_t TwoWire::transfer(const uint8_t* tx, size_t txLength, uint8_t* response, size_t responseMax) {
+    if (!slave) {
+        return 0;
+    }
+    if (txLength > 0 && receiveCallback != nullptr) {
+        rxLen = txLength < sizeof(rx) ? txLength : sizeof(rx);
+        memcpy(rx, tx, rxLen);
+        rxPos = 0;
+        receiveCallback(static_cast<int>(rxLen));
+    }
+    if (responseMax == 0 || requestCallback == nullptr) {
+        return 0;
+    }
+    txBuffer = response;
+    txMax = responseMax;
+    txLen = 0;
+    requestCallback();
+    txBuffer = nullptr;
+    return txLen;
+}
@@ -0,0 +1,22 @@
+#ifndef NOISE_HOST_CONTROL_H
+#define NOISE_HOST_CONTROL_H
+
+// Control del núcleo simulado desde los programas de prueba
+#include "Arduino.h"
+#include "Wire.h"
+
+// Reloj simulado en µs (millis()/micros() y localMicros() fuera de NOISE_REPLAY)
+void hostSetMicros(uint64_t us);
+void hostAdvanceMicros(uint64_t us);
+
+// Fuente de analogRead() (nullptr = media escala)
+void hostSetAnalogSource(uint16_t (*source)(uint8_t pin));
+
+// Nivel de digitalRead() por pin (por defecto HIGH: bus en reposo)
+void hostSetPinLevel(uint8_t pin, int level);
+
+// Destino de Serial (nullptr = descartar) y heap en uso que se resta al "libre" de ESP
+extern FILE* hostSerialOutput;
+extern size_t hostHeapUsed;
+
+#endif // NOISE_HOST_CONTROL_H
@@ -0,0 +1,128 @@
+#ifndef NOISE_HOST_NOISE_SENSOR_H
+#define NOISE_HOST_NOISE_SENSOR_H
+
+#include <math.h>
+#include <string.h>
+#include "Arduino.h"
+
+/**
+ * Sustituto de host de la librería NoiseSensor (misma interfaz pública)
+ *
+ * La librería real no se compila en el host. Este modelo lee analogRead() en cada update(),
+ * convierte a mV con escala lineal (2500 mV a fondo de escala) y da a cada campo de
+ * Measurements el significado que usa el esclavo con y sin NOISE_FIXED_POINT:
+ *
+ * - noise: última lectura.
+ * - noiseAvg / noisePeak / noiseMin: media, máximo y mínimo de las lecturas del ciclo.
+ * - noiseAvgLegal: valor eficaz de las lecturas del ciclo (promedio energético).
+ * - noiseAvgLegalMax / lowNoiseLevel: mayor y menor promedio legal de los ciclos cerrados
+ *   y del ciclo en curso.
+ * - cycles: ciclos cerrados desde el arranque.
+ *
+ * El ciclo dura CYCLE_MS (los 120 s por defecto de la librería): isCycleComplete() pasa a
+ * true al cumplirse y resetCycle() lo cierra. Un resetCycle() antes de tiempo (CMD_RESET)
+ * empieza otro sin contarlo. Los acumuladores son double: es la referencia de la ruta float
+ * en tools/fixed_point_check.
+ */
+class NoiseSensor {
+public:
+    enum LogLevel { LOG_NONE, LOG_ERROR, LOG_INFO, LOG_DEBUG };
+
+    static const unsigned long CYCLE_MS = 120000;
+
+    struct Config {
+        uint8_t adcPin = 4;
+        LogLevel logLevel = LOG_INFO;
+    };
+
+    struct Measurements {
+        float noise;
+        float noiseAvg;
+        float noisePeak;
+        float noiseMin;
+        float noiseAvgLegal;
+        float noiseAvgLegalMax;
+        uint16_t lowNoiseLevel;
+        uint32_t cycles;
+    };
+
+    NoiseSensor() : NoiseSensor(Config()) {}
+    explicit NoiseSensor(const Config& config)
+        : config(config), closedCycles(0), closedLegalMax(0), closedLegalMin(-1), complete(false) {
+        memset(&m, 0, sizeof(m));
+        startCycle();
+    }
+
+    void begin() {}
+
+    void update() {
+        const double mv = analogRead(config.adcPin) * 2500.0 / 4096.0;
+        count++;
+        sum += mv;
+        sumSq += mv * mv;
+        peak = (count == 1 || mv > peak) ? mv : peak;
+        low = (count == 1 || mv < low) ? mv : low;
+        m.noise = static_cast<float>(mv);
+        publish();
+        if (millis() - cycleStartMs >= CYCLE_MS) {
+            complete = true;
+        }
+    }
+
+    const Measurements& getMeasurements() const { return m; }
+    bool isCycleComplete() const { return complete; }
+
+    void resetCycle() {
+        if (complete && count > 0) {
+            const double legal = sqrt(sumSq / count);
+            closedLegalMax = legal > closedLegalMax ? legal : closedLegalMax;
+            closedLegalMin = (closedLegalMin < 0 || legal < closedLegalMin) ? legal : closedLegalMin;
+        }
+        if (complete) {
+            closedCycles++;
+        }
+        startCycle();
+        publish();
+    }
+
+private:
+    Config config;
+    Measurements m;
+    uint32_t count;
+    double sum;
+    double sumSq;
+    double peak;
+    double low;
+    uint32_t closedCycles;
+    double closedLegalMax;
+    double closedLegalMin;       // < 0 = ningún ciclo cerrado
+    unsigned long cycleStartMs;
+    bool complete;
+
+    void startCycle() {
+        count = 0;
+        sum = 0;
+        sumSq = 0;
+        peak = 0;
+        low = 0;
+        complete = false;
+        cycleStartMs = millis();
+    }
+
+    void publish() {
+        const double legal = count ? sqrt(sumSq / count) : 0;
+        m.noiseAvg = static_cast<float>(count ? sum / count : 0);
+        m.noisePeak = static_cast<float>(peak);
+        m.noiseMin = static_cast<float>(low);
+        m.noiseAvgLegal = static_cast<float>(legal);
+        m.noiseAvgLegalMax = static_cast<float>(count && legal > closedLegalMax ? legal : closedLegalMax);
+        double lowLegal = closedLegalMin;
+        if (count && (lowLegal < 0 || legal < lowLegal)) {
+            lowLegal = legal;
+        }
+        m.lowNoiseLevel = static_cast<uint16_t>(lowLegal < 0 ? 0 : lround(lowLegal));
+        m.cycles = closedCycles;
+    }
+};
+
+#endif // NOISE_HOST_NOISE_SENSOR_H
@@ -0,0 +1,54 @@
+#ifndef NOISE_HOST_WIRE_H
+#define NOISE_HOST_WIRE_H
+
+#include "Arduino.h"
+
+/**
+ * Periférico I2C simulado: como esclavo guarda los callbacks y hostI2CTransfer() hace de
+ * maestro (escritura y lectura) en el mismo hilo. Como maestro no hay nadie al otro lado.
+ */
+class TwoWire {
+public:
+    TwoWire();
+
+    size_t setBufferSize(size_t size) { return size; }
+    bool begin(uint8_t address, int sda, int scl, uint32_t frequency);
+    bool begin(int sda, int scl, uint32_t frequency);
+    bool end();
+    void setClock(uint32_t) {}
+    void setTimeOut(uint16_t) {}
+    void onRequest(void (*callback)()) { requestCallback = callback; }
+    void onReceive(void (*callback)(int)) { receiveCallback = callback; }
+
+    size_t write(uint8_t b) { return write(&b, 1); }
+    size_t write(const uint8_t* data, size_t len);
+    int available() { return static_cast<int>(rxLen - rxPos); }
+    int read() { return rxPos < rxLen ? rx[rxPos++] : -1; }
+    size_t readBytes(uint8_t* out, size_t len);
+
+    void beginTransmission(uint8_t) {}
+    uint8_t endTransmission(bool = true) { return 2; }  // NACK de dirección
+    uint8_t requestFrom(uint8_t, size_t, bool = true) { return 0; }
+
+    // Transacción del maestro simulado: devuelve los bytes de la respuesta (0 si no hay esclavo)
+    size_t transfer(const uint8_t* tx, size_t txLen, uint8_t* response, size_t responseMax);
+
+    uint32_t getBegins() const { return begins; }
+
+private:
+    void (*requestCallback)();
+    void (*receiveCallback)(int);
+    bool slave;
+    uint32_t begins;
+    uint8_t rx[64];
+    size_t rxLen;
+    size_t rxPos;
+    uint8_t* txBuffer;
+    size_t txMax;
+    size_t txLen;
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif // NOISE_HOST_WIRE_H
@@ -0,0 +1,164 @@
+// Reproducción de trazas de ADC en el host (NOISE_REPLAY) y rendimiento en horas de audio por segundo.
+//
+// Compilar y ejecutar en el host (sin Arduino):
+//   g++ -std=gnu++11 -O2 -DNOISE_REPLAY=1 -DNOISE_FIXED_POINT=1 -Itools/host -Ilib/NoiseSensorI2CSlave/src
+//       tools/replay_bench/replay_bench.cpp tools/host/HostArduino.cpp lib/NoiseSensorI2CSlave/src/*.cpp -o replay_bench
+//   ./replay_bench captura.nstr            # traza de exportCaptureTrace() o de otra herramienta
+//   ./replay_bench -s 3600 -r 2000         # traza sintética: segundos de audio y tasa
+//
+// Pasa cada muestra de la traza por el esclavo completo (una llamada a update() por muestra):
+// localMicros() y el núcleo de host (millis(), micros(), analogRead()) siguen a la traza, así
+// que en el build de punto fijo las muestras entran por readAdcRaw() y en el build con
+// NoiseSensor (sin -DNOISE_FIXED_POINT=1) por el analogRead() simulado. Imprime los registros
+// SensorData generados, el último registro y el rendimiento: muestras/s y horas de audio
+// procesadas por segundo de reloj.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include "HostArduino.h"
+#include "NoiseSensorI2CSlave.h"
+
+#if !NOISE_REPLAY
+#error "replay_bench necesita -DNOISE_REPLAY=1"
+#endif
+
+static TraceReader* trace = nullptr;
+
+static uint16_t traceSample(uint8_t) {
+    return static_cast<uint16_t>(trace->getSample());
+}
+
+static double nowSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void usage() {
+    fprintf(stderr, "Uso: replay_bench [traza] | replay_bench [-s segundos] [-r tasa_hz]\n");
+}
+
+static bool loadFile(const char* path, std::vector<uint8_t>& out) {
+    FILE* f = fopen(path, "rb");
+    if (f == nullptr) {
+        return false;
+    }
+    uint8_t chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        out.insert(out.end(), chunk, chunk + n);
+    }
+    fclose(f);
+    return true;
+}
+
+// Traza de tasa fija: DC del micrófono + tono con envolvente lenta + ruido
+static void synthesize(uint32_t seconds, uint32_t rateHz, std::vector<uint8_t>& out) {
+    TraceHeader header;
+    header.magic = TRACE_MAGIC;
+    header.version = TRACE_VERSION;
+    header.flags = TRACE_FLAG_FIXED_RATE;
+    header.reserved = 0;
+    header.sampleRateHz = rateHz;
+    header.sampleCount = seconds * rateHz;
+    header.startUs = 1000000;
+    out.resize(sizeof(header) + header.sampleCount * sizeof(int16_t));
+    memcpy(out.data(), &header, sizeof(header));
+
+    uint32_t lcg = 12345;
+    int16_t* samples = reinterpret_cast<int16_t*>(out.data() + sizeof(header));
+    for (uint32_t i = 0; i < header.sampleCount; i++) {
+        lcg = lcg * 1664525u + 1013904223u;
+        const double t = static_cast<double>(i) / rateHz;
+        const double envelope = 0.5 + 0.5 * sin(2 * M_PI * t / 60.0);
+        const double code = 2048 + envelope * 600 * sin(2 * M_PI * 440.0 * t) + ((lcg >> 24) & 0x3F) - 32;
+        samples[i] = static_cast<int16_t>(lround(code));
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    uint32_t seconds = 600;
+    uint32_t rateHz = 2000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seconds = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            rateHz = strtoul(argv[++i], nullptr, 10);
+        } else if (argv[i][0] != '-' && path == nullptr) {
+            path = argv[i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    std::vector<uint8_t> data;
+    if (path != nullptr) {
+        if (!loadFile(path, data)) {
+            fprintf(stderr, "No se puede leer %s\n", path);
+            return 1;
+        }
+    } else {
+        if (seconds == 0 || rateHz == 0) {
+            usage();
+            return 1;
+        }
+        synthesize(seconds, rateHz, data);
+    }
+    TraceReader reader(data.data(), data.size());
+    if (!reader.isValid()) {
+        fprintf(stderr, "Traza inválida\n");
+        return 1;
+    }
+    trace = &reader;
+
+    NoiseSensorI2CSlave::Config config;
+    config.updateInterval = 1000;
+    config.logLevel = NoiseSensor::LOG_NONE;
+    hostSetAnalogSource(traceSample);
+    NoiseSensorI2CSlave::setReplaySource(&reader);
+
+    // La primera muestra fija el reloj de begin()
+    if (!reader.next()) {
+        fprintf(stderr, "Traza vacía\n");
+        return 1;
+    }
+    hostSetMicros(static_cast<uint64_t>(reader.getTimeUs()));
+    NoiseSensorI2CSlave sensor(config);
+    sensor.begin();
+
+    unsigned long records = 0;
+    uint64_t lastTimestamp = 0;
+    uint32_t samples = 0;
+    const double start = nowSeconds();
+    do {
+        hostSetMicros(static_cast<uint64_t>(reader.getTimeUs()));
+        sensor.update();
+        samples++;
+        const SensorData& d = sensor.getData();
+        if (sensor.isDataReady() && d.timestamp != lastTimestamp) {
+            lastTimestamp = d.timestamp;
+            records++;
+        }
+    } while (reader.next());
+    const double elapsed = nowSeconds() - start;
+
+    const double audioSeconds = (reader.getTimeUs() - reader.getHeader().startUs) / 1e6;
+    const SensorData& d = sensor.getData();
+    printf("Traza: %lu muestras, %.1f s de audio (%s)\n", static_cast<unsigned long>(samples), audioSeconds,
+           (reader.getHeader().flags & TRACE_FLAG_FIXED_RATE) ? "tasa fija" : "tasa variable");
+    printf("Build: %s\n", NOISE_FIXED_POINT ? "punto fijo (readAdcRaw)" : "NoiseSensor (analogRead simulado)");
+    printf("Registros SensorData: %lu\n", records);
+    printf("Último: noise=%.1f avg=%.1f peak=%.1f min=%.1f legal=%.1f cycles=%lu\n", d.noise, d.noiseAvg,
+           d.noisePeak, d.noiseMin, d.noiseAvgLegal, static_cast<unsigned long>(d.cycles));
+    if (elapsed > 0) {
+        printf("Rendimiento: %.2f s de reloj, %.2f Mmuestras/s, %.2f horas de audio por segundo\n", elapsed,
+               samples / elapsed / 1e6, audioSeconds / elapsed / 3600.0);
+    }
+    return 0;
+}
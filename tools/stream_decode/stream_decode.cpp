@@ -0,0 +1,243 @@
+// Decodificador del transporte serie binario (NOISE_STREAM) y medidor de rendimiento.
+//
+// Compilar y ejecutar en el host (sin Arduino):
+//   g++ -std=c++11 -O2 -Ilib/NoiseSensorI2CSlave/src tools/stream_decode/stream_decode.cpp -o stream_decode
+//   stty -F /dev/ttyUSB0 2000000 raw -echo      # UART; con USB-CDC la velocidad no importa
+//   ./stream_decode -t 10 /dev/ttyUSB0
+//   ./stream_decode -r 01 -r 12 /dev/ttyACM0     # CMD_GET_DATA y CMD_GET_STATS
+//   ./stream_decode < captura.bin
+//
+// Escribe en stdout una línea por trama (registros empujados y respuestas) y, al terminar
+// (fin de la entrada, -t segundos o Ctrl+C), el resumen en stderr: bytes/s y tramas/s en la
+// línea, errores de COBS/CRC y huecos en la secuencia de registros (tramas descartadas por el
+// esclavo o perdidas por el host). Con -q solo se imprime el resumen, para medir el máximo
+// sostenido sin que el formateo limite la lectura.
+//
+// Cada -r HEX envía una petición (comando + argumentos en hexadecimal) al abrir el puerto.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <ctime>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "StreamFraming.h"
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSignal(int) {
+    stopRequested = 1;
+}
+
+static void usage() {
+    fprintf(stderr, "Uso: stream_decode [-q] [-t segundos] [-r HEX]... [puerto|captura.bin]\n");
+}
+
+static double nowSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static bool parseHex(const char* text, std::vector<uint8_t>& out) {
+    const size_t len = strlen(text);
+    if (len == 0 || len % 2 != 0 || len / 2 > STREAM_MAX_PAYLOAD) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i += 2) {
+        char pair[3] = {text[i], text[i + 1], 0};
+        char* end;
+        const unsigned long value = strtoul(pair, &end, 16);
+        if (*end != 0) {
+            return false;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+    return true;
+}
+
+static bool sendRequest(int fd, uint8_t sequence, const std::vector<uint8_t>& request) {
+    uint8_t wire[STREAM_MAX_WIRE];
+    wire[1] = STREAM_REQUEST;
+    wire[2] = sequence;
+    memcpy(wire + 1 + STREAM_HEADER_BYTES, request.data(), request.size());
+    const size_t len = streamEncodeFrame(wire, request.size());
+    return write(fd, wire, len) == static_cast<ssize_t>(len);
+}
+
+static void printRecord(uint8_t sequence, const uint8_t* payload, size_t len) {
+    SensorData data;
+    if (len != sizeof(data)) {
+        printf("RECORD %u tamaño inesperado (%zu bytes)\n", sequence, len);
+        return;
+    }
+    memcpy(&data, payload, sizeof(data));
+    printf("RECORD %u t=%llu noise=%.1f avg=%.1f peak=%.1f min=%.1f legal=%.1f cycles=%lu\n",
+           sequence, static_cast<unsigned long long>(data.timestamp), data.noise, data.noiseAvg,
+           data.noisePeak, data.noiseMin, data.noiseAvgLegal, static_cast<unsigned long>(data.cycles));
+}
+
+static void printRecordFixed(uint8_t sequence, const uint8_t* payload, size_t len) {
+    SensorDataFixed data;
+    if (len != sizeof(data)) {
+        printf("RECORD_FIXED %u tamaño inesperado (%zu bytes)\n", sequence, len);
+        return;
+    }
+    memcpy(&data, payload, sizeof(data));
+    printf("RECORD_FIXED %u t=%llu noise=%ld avg=%ld peak=%ld min=%ld leq=%.2f samples=%lu\n",
+           sequence, static_cast<unsigned long long>(data.timestamp), static_cast<long>(data.noiseMv),
+           static_cast<long>(data.noiseAvgMv), static_cast<long>(data.noisePeakMv),
+           static_cast<long>(data.noiseMinMv), data.leqCentiDb / 100.0, static_cast<unsigned long>(data.samples));
+}
+
+static void printResponse(uint8_t sequence, const uint8_t* payload, size_t len) {
+    if (len == 0) {
+        printf("RESPONSE %u vacía\n", sequence);
+        return;
+    }
+    printf("RESPONSE %u cmd=0x%02X", sequence, payload[0]);
+    if (len == 2 && payload[1] == 0x00) {
+        printf(" no listo\n");
+        return;
+    }
+    for (size_t i = 1; i < len; i++) {
+        printf(" %02X", payload[i]);
+    }
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    bool quiet = false;
+    double limitSeconds = 0;
+    std::vector<std::vector<uint8_t> > requests;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-q") == 0) {
+            quiet = true;
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            limitSeconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            std::vector<uint8_t> request;
+            if (!parseHex(argv[++i], request)) {
+                fprintf(stderr, "Petición inválida: %s\n", argv[i]);
+                return 1;
+            }
+            requests.push_back(request);
+        } else if (argv[i][0] != '-' && path == nullptr) {
+            path = argv[i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    int fd = STDIN_FILENO;
+    if (path != nullptr && (fd = open(path, requests.empty() ? O_RDONLY : O_RDWR)) < 0) {
+        fprintf(stderr, "No se puede abrir %s\n", path);
+        return 1;
+    }
+    if (!requests.empty() && path == nullptr) {
+        fprintf(stderr, "-r necesita un puerto\n");
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+
+    for (size_t i = 0; i < requests.size(); i++) {
+        if (!sendRequest(fd, static_cast<uint8_t>(i), requests[i])) {
+            fprintf(stderr, "Error al enviar la petición %zu\n", i);
+            return 1;
+        }
+    }
+
+    uint8_t frame[STREAM_MAX_WIRE];
+    size_t frameLen = 0;
+    bool overflow = false;
+    unsigned long long bytes = 0;
+    unsigned long frames = 0, records = 0, responses = 0, crcErrors = 0, overruns = 0, gaps = 0;
+    bool haveSequence = false;
+    uint8_t lastSequence = 0;
+    double start = 0;
+
+    uint8_t chunk[4096];
+    while (!stopRequested) {
+        const ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n <= 0) {
+            break;
+        }
+        const double now = nowSeconds();
+        if (bytes == 0) {
+            start = now;
+        }
+        bytes += static_cast<unsigned long long>(n);
+
+        for (ssize_t i = 0; i < n; i++) {
+            if (chunk[i] != 0) {
+                if (frameLen < sizeof(frame)) {
+                    frame[frameLen++] = chunk[i];
+                } else {
+                    overflow = true;
+                }
+                continue;
+            }
+            const size_t len = frameLen;
+            frameLen = 0;
+            if (overflow) {
+                overflow = false;
+                overruns++;
+                continue;
+            }
+            if (len == 0) {
+                continue;
+            }
+            const size_t decoded = streamDecodeFrame(frame, len);
+            if (decoded == 0) {
+                crcErrors++;
+                continue;
+            }
+            frames++;
+            const uint8_t type = frame[0];
+            const uint8_t sequence = frame[1];
+            const uint8_t* payload = frame + STREAM_HEADER_BYTES;
+            const size_t payloadLen = decoded - STREAM_HEADER_BYTES;
+            if (type == STREAM_RECORD) {
+                if (haveSequence) {
+                    gaps += static_cast<uint8_t>(sequence - lastSequence - 1);
+                }
+                haveSequence = true;
+                lastSequence = sequence;
+                records++;
+                if (!quiet) {
+                    printRecord(sequence, payload, payloadLen);
+                }
+            } else if (type == STREAM_RECORD_FIXED) {
+                if (!quiet) {
+                    printRecordFixed(sequence, payload, payloadLen);
+                }
+            } else if (type == STREAM_RESPONSE) {
+                responses++;
+                if (!quiet) {
+                    printResponse(sequence, payload, payloadLen);
+                }
+            }
+        }
+        if (limitSeconds > 0 && now - start >= limitSeconds) {
+            break;
+        }
+    }
+
+    const double elapsed = (bytes > 0) ? nowSeconds() - start : 0;
+    fprintf(stderr, "%llu bytes, %lu tramas (%lu registros, %lu respuestas) en %.2f s\n",
+            bytes, frames, records, responses, elapsed);
+    if (elapsed > 0) {
+        fprintf(stderr, "Rendimiento: %.0f bytes/s, %.1f tramas/s, %.1f registros/s\n",
+                bytes / elapsed, frames / elapsed, records / elapsed);
+    }
+    fprintf(stderr, "Errores COBS/CRC: %lu, tramas demasiado largas: %lu, registros perdidos: %lu\n",
+            crcErrors, overruns, gaps);
+    if (fd != STDIN_FILENO) {
+        close(fd);
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Conversor de trazas de la ruta caliente (NOISE_TRACE) a JSON de Chrome trace / Perfetto.
+//
+// Compilar y ejecutar en el host (sin Arduino):
+//   g++ -std=c++11 -O2 -Ilib/NoiseSensorI2CSlave/src tools/trace_export/trace_export.cpp -o trace_export
+//   ./trace_export captura_serie.txt > traza.json
+//
+// La entrada es el texto de traceDump() tal cual sale por el puerto serie (las líneas de log
+// intercaladas se ignoran). Un maestro que lea CMD_TRACE_READ puede escribir cada evento con
+// el mismo formato. El JSON se abre en chrome://tracing o en ui.perfetto.dev: un hilo por
+// núcleo, con los ámbitos anidados de update(), onReceive(), onRequest(), etc.
+//
+// El contador de ciclos es de 32 bits y se desborda (~27 s a 160 MHz): se reconstruye por
+// núcleo suponiendo que entre dos eventos consecutivos pasa menos de una vuelta. Entre
+// volcados separados más de una vuelta, la línea de tiempo se comprime.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "I2CProtocol.h"
+
+static const unsigned MAX_CORES = 8;
+
+struct CoreState {
+    bool started;
+    uint32_t lastCycles;
+    uint64_t cycles;            // Contador reconstruido a 64 bits
+    std::vector<uint8_t> open;  // Ámbitos abiertos (para descartar fines sin inicio)
+};
+
+static void usage() {
+    fprintf(stderr, "Uso: trace_export [captura.txt] > traza.json\n");
+}
+
+static void printName(FILE* out, unsigned id) {
+    if (id < TRACE_EVENT_COUNT) {
+        fprintf(out, "%s", TRACE_EVENT_NAMES[id]);
+    } else if (id >= TRACE_USER_FIRST) {
+        fprintf(out, "user%u", id - TRACE_USER_FIRST);
+    } else {
+        fprintf(out, "event%u", id);
+    }
+}
+
+int main(int argc, char** argv) {
+    FILE* in = stdin;
+    if (argc > 2 || (argc == 2 && argv[1][0] == '-')) {
+        usage();
+        return 1;
+    }
+    if (argc == 2 && !(in = fopen(argv[1], "r"))) {
+        fprintf(stderr, "No se puede abrir %s\n", argv[1]);
+        return 1;
+    }
+
+    CoreState cores[MAX_CORES];
+    for (unsigned c = 0; c < MAX_CORES; c++) {
+        cores[c].started = false;
+        cores[c].lastCycles = 0;
+        cores[c].cycles = 0;
+    }
+    unsigned mhz = 0;
+    unsigned long events = 0, dropped = 0, lost = 0, dumps = 0;
+    bool first = true;
+
+    printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    char line[256];
+    while (fgets(line, sizeof(line), in)) {
+        unsigned a, b;
+        unsigned long value;
+        char phase;
+        if (sscanf(line, "TRACE END %lu", &value) == 1) {
+            lost += value;
+            continue;
+        }
+        if (sscanf(line, "TRACE %u %u", &a, &b) == 2) {
+            mhz = a;
+            dumps++;
+            continue;
+        }
+        if (sscanf(line, "T %u %u %c %lx", &a, &b, &phase, &value) != 4 || mhz == 0 || a >= MAX_CORES ||
+            (phase != TRACE_PHASE_BEGIN && phase != TRACE_PHASE_END)) {
+            continue;
+        }
+
+        CoreState& core = cores[a];
+        const uint32_t raw = static_cast<uint32_t>(value);
+        core.cycles = core.started ? core.cycles + static_cast<uint32_t>(raw - core.lastCycles) : raw;
+        core.lastCycles = raw;
+        core.started = true;
+
+        if (phase == TRACE_PHASE_END) {
+            // Un fin cuyo inicio se perdió (anillo sobrescrito) desequilibraría la pila
+            if (core.open.empty() || core.open.back() != b) {
+                dropped++;
+                continue;
+            }
+            core.open.pop_back();
+        } else {
+            core.open.push_back(static_cast<uint8_t>(b));
+        }
+
+        printf("%s\n{\"name\":\"", first ? "" : ",");
+        printName(stdout, b);
+        printf("\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%u}",
+               phase, static_cast<double>(core.cycles) / mhz, a);
+        first = false;
+        events++;
+    }
+    // Nombres de los hilos (núcleos) para el visor
+    for (unsigned c = 0; c < MAX_CORES; c++) {
+        if (cores[c].started) {
+            printf("%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"core %u\"}}",
+                   first ? "" : ",", c, c);
+            first = false;
+        }
+    }
+    printf("\n]}\n");
+
+    if (in != stdin) {
+        fclose(in);
+    }
+    fprintf(stderr, "%lu eventos en %lu volcados, %lu fines sin inicio descartados, %lu perdidos en el esclavo\n",
+            events, dumps, dropped, lost);
+    return 0;
+}